@@ -0,0 +1,261 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* DiscoveryCache: remembers, across runs, the few fields of the
+ * GstDiscovererInfo-s GES makes use of so that sources do not have to be
+ * discovered each time a project is loaded.
+ *
+ * The cache is a key file stored in the user cache directory, or at the path
+ * given by the GES_DISCOVERY_CACHE environment variable, with one group per
+ * URI. An entry is only valid as long as the size and modification time of
+ * the file it describes did not change.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+#include <gst/pbutils/pbutils.h>
+
+#include "ges-internal.h"
+
+#define CACHE_VERSION 1
+#define CACHE_HEADER_GROUP "GESDiscoveryCache"
+
+static GMutex cache_lock;
+static GKeyFile *cache = NULL;
+static gchar *cache_location = NULL;
+static gboolean cache_dirty = FALSE;
+
+/* Must be called with the cache_lock taken */
+static void
+load_cache (void)
+{
+  GError *error = NULL;
+
+  if (cache)
+    return;
+
+  cache = g_key_file_new ();
+  cache_location = g_strdup (g_getenv ("GES_DISCOVERY_CACHE"));
+  if (cache_location == NULL)
+    cache_location = g_build_filename (g_get_user_cache_dir (),
+        "gstreamer-editing-services", "discovery.cache", NULL);
+
+  if (!g_key_file_load_from_file (cache, cache_location, G_KEY_FILE_NONE,
+          &error)) {
+    GST_DEBUG ("Could not load discovery cache %s: %s", cache_location,
+        error->message);
+    g_clear_error (&error);
+  } else if (g_key_file_get_integer (cache, CACHE_HEADER_GROUP, "version",
+          NULL) != CACHE_VERSION) {
+    GST_DEBUG ("Discarding discovery cache %s, version mismatch",
+        cache_location);
+    g_key_file_free (cache);
+    cache = g_key_file_new ();
+  }
+
+  g_key_file_set_integer (cache, CACHE_HEADER_GROUP, "version", CACHE_VERSION);
+}
+
+static gboolean
+get_file_stamp (const gchar * uri, guint64 * size, guint64 * mtime)
+{
+  GFileInfo *info;
+  GFile *file = g_file_new_for_uri (uri);
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+      G_FILE_ATTRIBUTE_TIME_MODIFIED, G_FILE_QUERY_INFO_NONE, NULL, NULL);
+  g_object_unref (file);
+
+  if (info == NULL)
+    return FALSE;
+
+  *size = g_file_info_get_attribute_uint64 (info,
+      G_FILE_ATTRIBUTE_STANDARD_SIZE);
+  *mtime = g_file_info_get_attribute_uint64 (info,
+      G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  g_object_unref (info);
+
+  return TRUE;
+}
+
+/* URIs are used as group names, which can not contain those characters */
+static inline gboolean
+uri_is_cacheable (const gchar * uri)
+{
+  return uri && *uri && !strpbrk (uri, "[]\n\r")
+      && g_strcmp0 (uri, CACHE_HEADER_GROUP);
+}
+
+DiscoveryCacheEntry *
+discovery_cache_entry_new_from_info (GstDiscovererInfo * info)
+{
+  GList *tmp, *stream_list;
+  GPtrArray *caps = g_ptr_array_new ();
+  DiscoveryCacheEntry *entry = g_slice_new0 (DiscoveryCacheEntry);
+
+  entry->duration = gst_discoverer_info_get_duration (info);
+
+  stream_list = gst_discoverer_info_get_stream_list (info);
+  for (tmp = stream_list; tmp; tmp = tmp->next) {
+    GstDiscovererStreamInfo *sinf = (GstDiscovererStreamInfo *) tmp->data;
+    GstCaps *scaps = gst_discoverer_stream_info_get_caps (sinf);
+
+    if (GST_IS_DISCOVERER_AUDIO_INFO (sinf)) {
+      entry->has_audio = TRUE;
+    } else if (GST_IS_DISCOVERER_VIDEO_INFO (sinf)) {
+      entry->has_video = TRUE;
+      if (gst_discoverer_video_info_is_image ((GstDiscovererVideoInfo *) sinf))
+        entry->is_image = TRUE;
+    }
+
+    if (scaps) {
+      g_ptr_array_add (caps, gst_caps_to_string (scaps));
+      gst_caps_unref (scaps);
+    }
+  }
+
+  if (stream_list)
+    gst_discoverer_stream_info_list_free (stream_list);
+
+  g_ptr_array_add (caps, NULL);
+  entry->caps = (gchar **) g_ptr_array_free (caps, FALSE);
+
+  return entry;
+}
+
+void
+discovery_cache_entry_free (DiscoveryCacheEntry * entry)
+{
+  g_strfreev (entry->caps);
+  g_slice_free (DiscoveryCacheEntry, entry);
+}
+
+/* Returns the caps of all the streams of @entry in a single #GstCaps */
+GstCaps *
+discovery_cache_entry_get_caps (DiscoveryCacheEntry * entry)
+{
+  guint i;
+  GstCaps *caps = gst_caps_new_empty ();
+
+  for (i = 0; entry->caps && entry->caps[i]; i++) {
+    GstCaps *scaps = gst_caps_from_string (entry->caps[i]);
+
+    if (scaps)
+      gst_caps_append (caps, scaps);
+  }
+
+  return caps;
+}
+
+/* Returns the cached information about @uri, or NULL if @uri is not
+ * in the cache or changed since it got cached */
+DiscoveryCacheEntry *
+discovery_cache_lookup (const gchar * uri)
+{
+  guint64 size, mtime;
+  DiscoveryCacheEntry *entry = NULL;
+
+  if (!uri_is_cacheable (uri) || !get_file_stamp (uri, &size, &mtime))
+    return NULL;
+
+  g_mutex_lock (&cache_lock);
+  load_cache ();
+
+  if (!g_key_file_has_group (cache, uri))
+    goto done;
+
+  if (g_key_file_get_uint64 (cache, uri, "size", NULL) != size ||
+      g_key_file_get_uint64 (cache, uri, "mtime", NULL) != mtime) {
+    GST_DEBUG ("%s changed since it was cached", uri);
+    g_key_file_remove_group (cache, uri, NULL);
+    cache_dirty = TRUE;
+
+    goto done;
+  }
+
+  entry = g_slice_new0 (DiscoveryCacheEntry);
+  entry->duration = g_key_file_get_uint64 (cache, uri, "duration", NULL);
+  entry->has_audio = g_key_file_get_boolean (cache, uri, "audio", NULL);
+  entry->has_video = g_key_file_get_boolean (cache, uri, "video", NULL);
+  entry->is_image = g_key_file_get_boolean (cache, uri, "image", NULL);
+  entry->caps = g_key_file_get_string_list (cache, uri, "caps", NULL, NULL);
+
+  GST_DEBUG ("Found %s in the discovery cache", uri);
+
+done:
+  g_mutex_unlock (&cache_lock);
+
+  return entry;
+}
+
+void
+discovery_cache_store (const gchar * uri, DiscoveryCacheEntry * entry)
+{
+  guint64 size, mtime;
+
+  if (!uri_is_cacheable (uri) || !get_file_stamp (uri, &size, &mtime))
+    return;
+
+  g_mutex_lock (&cache_lock);
+  load_cache ();
+
+  g_key_file_set_uint64 (cache, uri, "size", size);
+  g_key_file_set_uint64 (cache, uri, "mtime", mtime);
+  g_key_file_set_uint64 (cache, uri, "duration", entry->duration);
+  g_key_file_set_boolean (cache, uri, "audio", entry->has_audio);
+  g_key_file_set_boolean (cache, uri, "video", entry->has_video);
+  g_key_file_set_boolean (cache, uri, "image", entry->is_image);
+  if (entry->caps && entry->caps[0])
+    g_key_file_set_string_list (cache, uri, "caps",
+        (const gchar * const *) entry->caps, g_strv_length (entry->caps));
+  else
+    g_key_file_remove_key (cache, uri, "caps", NULL);
+
+  cache_dirty = TRUE;
+  g_mutex_unlock (&cache_lock);
+}
+
+/* Writes the cache to disk if it changed */
+void
+discovery_cache_save (void)
+{
+  gsize length;
+  gchar *data, *dirname;
+  GError *error = NULL;
+
+  g_mutex_lock (&cache_lock);
+  if (!cache_dirty)
+    goto done;
+
+  dirname = g_path_get_dirname (cache_location);
+  g_mkdir_with_parents (dirname, 0755);
+  g_free (dirname);
+
+  data = g_key_file_to_data (cache, &length, NULL);
+  if (!g_file_set_contents (cache_location, data, length, &error)) {
+    GST_WARNING ("Could not save discovery cache %s: %s", cache_location,
+        error->message);
+    g_error_free (error);
+  }
+  g_free (data);
+
+  cache_dirty = FALSE;
+
+done:
+  g_mutex_unlock (&cache_lock);
+}
@@ -0,0 +1,147 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* ElementPool: the gnlobjects that sources released, kept in the NULL state
+ * so that a later source of the same type reading the same uri with the same
+ * caps can take them over instead of building new ones.
+ *
+ * The pool is small and bounded, so the entries are kept in a queue, most
+ * recently released first, and looked up linearly. When the pool is full the
+ * oldest entry is dropped.
+ */
+
+#include "ges-internal.h"
+
+typedef struct
+{
+  GType type;
+  gchar *uri;
+  GstCaps *caps;
+
+  GstElement *gnlobject;
+  GstElement *element;
+} PoolEntry;
+
+struct _ElementPool
+{
+  guint max_size;
+  GQueue entries;               /* PoolEntry, most recent first */
+};
+
+static void
+pool_entry_free (PoolEntry * entry)
+{
+  g_free (entry->uri);
+  if (entry->caps)
+    gst_caps_unref (entry->caps);
+  gst_object_unref (entry->gnlobject);
+  g_slice_free (PoolEntry, entry);
+}
+
+ElementPool *
+element_pool_new (guint max_size)
+{
+  ElementPool *pool = g_slice_new0 (ElementPool);
+
+  pool->max_size = max_size;
+  g_queue_init (&pool->entries);
+
+  return pool;
+}
+
+void
+element_pool_clear (ElementPool * pool)
+{
+  PoolEntry *entry;
+
+  while ((entry = g_queue_pop_head (&pool->entries)))
+    pool_entry_free (entry);
+}
+
+void
+element_pool_free (ElementPool * pool)
+{
+  element_pool_clear (pool);
+  g_slice_free (ElementPool, pool);
+}
+
+/* Takes the reference on @gnlobject, which must be in the NULL state and
+ * have no parent. @element is the child the source created in it, if any */
+void
+element_pool_push (ElementPool * pool, GType type, const gchar * uri,
+    const GstCaps * caps, GstElement * gnlobject, GstElement * element)
+{
+  PoolEntry *entry;
+
+  if (pool->max_size == 0 || uri == NULL) {
+    gst_object_unref (gnlobject);
+    return;
+  }
+
+  entry = g_slice_new (PoolEntry);
+  entry->type = type;
+  entry->uri = g_strdup (uri);
+  entry->caps = caps ? gst_caps_ref ((GstCaps *) caps) : NULL;
+  entry->gnlobject = gnlobject;
+  entry->element = element;
+
+  g_queue_push_head (&pool->entries, entry);
+
+  if (g_queue_get_length (&pool->entries) > pool->max_size)
+    pool_entry_free (g_queue_pop_tail (&pool->entries));
+}
+
+/* Returns a gnlobject released for @uri and @caps by a source of @type, with
+ * a floating reference as if it had just been created, or %NULL */
+GstElement *
+element_pool_pop (ElementPool * pool, GType type, const gchar * uri,
+    const GstCaps * caps, GstElement ** element)
+{
+  GList *tmp;
+  PoolEntry *entry;
+  GstElement *gnlobject;
+
+  if (uri == NULL)
+    return NULL;
+
+  for (tmp = pool->entries.head; tmp; tmp = tmp->next) {
+    entry = tmp->data;
+
+    if (entry->type != type || g_strcmp0 (entry->uri, uri))
+      continue;
+
+    if (entry->caps != caps && (entry->caps == NULL || caps == NULL ||
+            !gst_caps_is_equal (entry->caps, caps)))
+      continue;
+
+    g_queue_delete_link (&pool->entries, tmp);
+
+    gnlobject = entry->gnlobject;
+    *element = entry->element;
+    g_object_force_floating (G_OBJECT (gnlobject));
+
+    g_free (entry->uri);
+    if (entry->caps)
+      gst_caps_unref (entry->caps);
+    g_slice_free (PoolEntry, entry);
+
+    return gnlobject;
+  }
+
+  return NULL;
+}
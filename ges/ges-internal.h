@@ -59,4 +59,219 @@ timeline_move_object           (GESTimeline *timeline, GESTrackObject * object,
 gboolean
 timeline_context_to_layer      (GESTimeline *timeline, gint offset);
 
+gboolean
+timeline_is_editing            (GESTimeline *timeline);
+
+GESTimeline *
+timeline_copy                  (GESTimeline *timeline);
+
+void
+timeline_layer_commit_edit     (GESTimelineLayer *layer);
+
+void
+simple_timeline_layer_commit_edit (GESSimpleTimelineLayer *layer);
+
+void
+timeline_object_update_layer_priority (GESTimelineObject *object);
+
+void
+timeline_filesource_set_stream_caps (GESTimelineFileSource *tfs,
+                                     GstCaps *caps);
+
+GstCaps *
+timeline_filesource_get_stream_caps (GESTimelineFileSource *tfs);
+
+gboolean
+track_wants_materialized       (GESTrack *track, GESTrackObject *object);
+
+gboolean
+track_object_materialize       (GESTrackObject *object);
+
+GstElement *
+track_object_release           (GESTrackObject *object, GstElement **element);
+
+GstElement *
+track_pop_pooled_gnl_object    (GESTrack *track, GESTrackObject *object,
+                                GstElement **element);
+
+/* ElementPool: released gnlobjects kept for reuse, keyed by uri and caps */
+typedef struct _ElementPool ElementPool;
+
+ElementPool *
+element_pool_new                   (guint max_size);
+
+void
+element_pool_free                  (ElementPool *pool);
+
+void
+element_pool_clear                 (ElementPool *pool);
+
+void
+element_pool_push                  (ElementPool *pool, GType type,
+                                    const gchar *uri, const GstCaps *caps,
+                                    GstElement *gnlobject, GstElement *element);
+
+GstElement *
+element_pool_pop                   (ElementPool *pool, GType type,
+                                    const gchar *uri, const GstCaps *caps,
+                                    GstElement **element);
+
+/* IntervalTree: balanced tree of intervals for range queries */
+typedef struct _IntervalTree IntervalTree;
+
+IntervalTree *
+interval_tree_new                  (GDestroyNotify destroy);
+
+void
+interval_tree_free                 (IntervalTree *tree);
+
+void
+interval_tree_insert               (IntervalTree *tree, gpointer data,
+                                    guint64 start, guint64 end, guint32 priority);
+
+gboolean
+interval_tree_remove               (IntervalTree *tree, gpointer data);
+
+void
+interval_tree_update               (IntervalTree *tree, gpointer data,
+                                    guint64 start, guint64 end, guint32 priority);
+
+gboolean
+interval_tree_contains             (IntervalTree *tree, gpointer data);
+
+GList *
+interval_tree_get_overlapping      (IntervalTree *tree, guint64 start, guint64 end);
+
+GList *
+interval_tree_get_ending_before    (IntervalTree *tree, guint64 position);
+
+GList *
+interval_tree_get_starting_after   (IntervalTree *tree, guint64 position);
+
+/* SnapIndex: sorted start and end edges of objects */
+typedef struct _SnapIndex SnapIndex;
+
+typedef enum
+{
+  SNAP_EDGE_START = 0,
+  SNAP_EDGE_END = 1
+} SnapEdgeKind;
+
+typedef gboolean (*SnapIndexFilter) (gpointer owner, gpointer user_data);
+
+SnapIndex *
+snap_index_new                     (void);
+
+void
+snap_index_free                    (SnapIndex *index);
+
+void
+snap_index_add                     (SnapIndex *index, gpointer owner,
+                                    guint64 start, guint64 end);
+
+void
+snap_index_remove                  (SnapIndex *index, gpointer owner);
+
+void
+snap_index_update                  (SnapIndex *index, gpointer owner,
+                                    guint64 start, guint64 end);
+
+guint64
+snap_index_get_last_position       (SnapIndex *index);
+
+gboolean
+snap_index_find_closest            (SnapIndex *index, guint64 position,
+                                    guint64 distance, SnapIndexFilter filter,
+                                    gpointer user_data, guint64 *snapped,
+                                    gpointer *owner);
+
+/* SequenceTree: objects laid out one after the other, indexed by position */
+typedef struct _SequenceTree SequenceTree;
+typedef struct _SequenceTreeNode SequenceTreeNode;
+
+SequenceTree *
+sequence_tree_new                  (void);
+
+void
+sequence_tree_free                 (SequenceTree *tree);
+
+guint
+sequence_tree_length               (SequenceTree *tree);
+
+void
+sequence_tree_insert               (SequenceTree *tree, guint position,
+                                    gpointer data, gboolean is_transition,
+                                    guint64 duration, guint height);
+
+gint
+sequence_tree_remove               (SequenceTree *tree, gpointer data);
+
+void
+sequence_tree_update               (SequenceTree *tree, gpointer data,
+                                    guint64 duration, guint height);
+
+gint
+sequence_tree_index                (SequenceTree *tree, gpointer data);
+
+gpointer
+sequence_tree_nth                  (SequenceTree *tree, guint position);
+
+SequenceTreeNode *
+sequence_tree_get_node_at          (SequenceTree *tree, guint position);
+
+SequenceTreeNode *
+sequence_tree_node_next            (SequenceTreeNode *node);
+
+SequenceTreeNode *
+sequence_tree_node_prev            (SequenceTreeNode *node);
+
+gpointer
+sequence_tree_node_get_data        (SequenceTreeNode *node);
+
+guint64
+sequence_tree_get_position         (SequenceTree *tree, guint position);
+
+guint
+sequence_tree_get_heights          (SequenceTree *tree, guint position,
+                                    guint *n_sources);
+
+gint
+sequence_tree_get_last_source      (SequenceTree *tree, guint position);
+
+gint
+sequence_tree_get_last_transition  (SequenceTree *tree, guint position);
+
+gint
+sequence_tree_get_next_transition  (SequenceTree *tree, guint position);
+
+/* DiscoveryCache: on-disk cache of discovery results */
+typedef struct _DiscoveryCacheEntry
+{
+  GstClockTime duration;
+  gboolean has_audio;
+  gboolean has_video;
+  gboolean is_image;
+
+  /* NULL terminated array of the serialized caps of the streams */
+  gchar **caps;
+} DiscoveryCacheEntry;
+
+DiscoveryCacheEntry *
+discovery_cache_entry_new_from_info (GstDiscovererInfo *info);
+
+void
+discovery_cache_entry_free         (DiscoveryCacheEntry *entry);
+
+GstCaps *
+discovery_cache_entry_get_caps     (DiscoveryCacheEntry *entry);
+
+DiscoveryCacheEntry *
+discovery_cache_lookup             (const gchar *uri);
+
+void
+discovery_cache_store              (const gchar *uri, DiscoveryCacheEntry *entry);
+
+void
+discovery_cache_save               (void);
+
 #endif /* __GES_INTERNAL_H__ */
@@ -0,0 +1,382 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* IntervalTree: a balanced (AVL) binary tree of [start, end) intervals
+ * sorted by start and priority, where each node knows the smallest and
+ * biggest end of its subtree. This lets us find the intervals overlapping a
+ * range, ending before or starting after a position in O(log n + k).
+ *
+ * The key of each node is copied in the node so the tree stays consistent
+ * when the values of the object change, until interval_tree_update() is
+ * called.
+ */
+
+#include "ges-internal.h"
+
+typedef struct _IntervalTreeNode IntervalTreeNode;
+
+struct _IntervalTreeNode
+{
+  gpointer data;
+
+  guint64 start;
+  guint64 end;
+  guint32 priority;
+
+  /* Smallest and biggest ends of the subtree */
+  guint64 min_end;
+  guint64 max_end;
+
+  gint height;
+  IntervalTreeNode *left;
+  IntervalTreeNode *right;
+};
+
+struct _IntervalTree
+{
+  IntervalTreeNode *root;
+
+  /* {data: IntervalTreeNode} */
+  GHashTable *nodes;
+  GDestroyNotify destroy;
+};
+
+static inline gint
+node_height (IntervalTreeNode * node)
+{
+  return node ? node->height : 0;
+}
+
+static inline void
+node_fixup (IntervalTreeNode * node)
+{
+  node->height = MAX (node_height (node->left), node_height (node->right)) + 1;
+
+  node->min_end = node->max_end = node->end;
+  if (node->left) {
+    node->min_end = MIN (node->min_end, node->left->min_end);
+    node->max_end = MAX (node->max_end, node->left->max_end);
+  }
+  if (node->right) {
+    node->min_end = MIN (node->min_end, node->right->min_end);
+    node->max_end = MAX (node->max_end, node->right->max_end);
+  }
+}
+
+static gint
+node_compare (IntervalTreeNode * a, IntervalTreeNode * b)
+{
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  if (a->priority != b->priority)
+    return a->priority < b->priority ? -1 : 1;
+  if (a->data != b->data)
+    return GPOINTER_TO_SIZE (a->data) < GPOINTER_TO_SIZE (b->data) ? -1 : 1;
+
+  return 0;
+}
+
+static IntervalTreeNode *
+rotate_right (IntervalTreeNode * node)
+{
+  IntervalTreeNode *left = node->left;
+
+  node->left = left->right;
+  left->right = node;
+  node_fixup (node);
+  node_fixup (left);
+
+  return left;
+}
+
+static IntervalTreeNode *
+rotate_left (IntervalTreeNode * node)
+{
+  IntervalTreeNode *right = node->right;
+
+  node->right = right->left;
+  right->left = node;
+  node_fixup (node);
+  node_fixup (right);
+
+  return right;
+}
+
+static IntervalTreeNode *
+node_balance (IntervalTreeNode * node)
+{
+  gint balance;
+
+  node_fixup (node);
+  balance = node_height (node->left) - node_height (node->right);
+
+  if (balance > 1) {
+    if (node_height (node->left->left) < node_height (node->left->right))
+      node->left = rotate_left (node->left);
+
+    return rotate_right (node);
+  } else if (balance < -1) {
+    if (node_height (node->right->right) < node_height (node->right->left))
+      node->right = rotate_right (node->right);
+
+    return rotate_left (node);
+  }
+
+  return node;
+}
+
+static IntervalTreeNode *
+node_insert (IntervalTreeNode * root, IntervalTreeNode * node)
+{
+  if (root == NULL) {
+    node->left = node->right = NULL;
+    node_fixup (node);
+
+    return node;
+  }
+
+  if (node_compare (node, root) < 0)
+    root->left = node_insert (root->left, node);
+  else
+    root->right = node_insert (root->right, node);
+
+  return node_balance (root);
+}
+
+/* Detaches the first node of the subtree in @min */
+static IntervalTreeNode *
+node_remove_min (IntervalTreeNode * root, IntervalTreeNode ** min)
+{
+  if (root->left == NULL) {
+    *min = root;
+
+    return root->right;
+  }
+
+  root->left = node_remove_min (root->left, min);
+
+  return node_balance (root);
+}
+
+static IntervalTreeNode *
+node_remove (IntervalTreeNode * root, IntervalTreeNode * node)
+{
+  gint cmp;
+  IntervalTreeNode *min;
+
+  if (root == NULL)
+    return NULL;
+
+  cmp = node_compare (node, root);
+  if (cmp < 0) {
+    root->left = node_remove (root->left, node);
+  } else if (cmp > 0) {
+    root->right = node_remove (root->right, node);
+  } else {
+    if (root->left == NULL || root->right == NULL)
+      return root->left ? root->left : root->right;
+
+    /* Replace the node by the first one of its right subtree */
+    min = NULL;
+    root->right = node_remove_min (root->right, &min);
+    min->left = root->left;
+    min->right = root->right;
+    root = min;
+  }
+
+  return node_balance (root);
+}
+
+static void
+node_free (IntervalTreeNode * node)
+{
+  g_slice_free (IntervalTreeNode, node);
+}
+
+/* The following functions walk the tree from the right to the left and
+ * prepend the results so that the lists end up sorted */
+static void
+node_get_overlapping (IntervalTreeNode * node, guint64 start, guint64 end,
+    GList ** list)
+{
+  if (node == NULL || node->max_end <= start)
+    return;
+
+  if (node->start < end) {
+    node_get_overlapping (node->right, start, end, list);
+
+    if (node->end > start)
+      *list = g_list_prepend (*list, node->data);
+  }
+
+  node_get_overlapping (node->left, start, end, list);
+}
+
+static void
+node_get_ending_before (IntervalTreeNode * node, guint64 position,
+    GList ** list)
+{
+  if (node == NULL || node->min_end > position)
+    return;
+
+  node_get_ending_before (node->right, position, list);
+
+  if (node->end <= position)
+    *list = g_list_prepend (*list, node->data);
+
+  node_get_ending_before (node->left, position, list);
+}
+
+static void
+node_get_starting_after (IntervalTreeNode * node, guint64 position,
+    GList ** list)
+{
+  if (node == NULL)
+    return;
+
+  node_get_starting_after (node->right, position, list);
+
+  if (node->start >= position) {
+    *list = g_list_prepend (*list, node->data);
+    node_get_starting_after (node->left, position, list);
+  }
+}
+
+IntervalTree *
+interval_tree_new (GDestroyNotify destroy)
+{
+  IntervalTree *tree = g_slice_new0 (IntervalTree);
+
+  tree->nodes = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) node_free);
+  tree->destroy = destroy;
+
+  return tree;
+}
+
+static void
+destroy_data_foreach (gpointer data, IntervalTreeNode * node,
+    IntervalTree * tree)
+{
+  tree->destroy (data);
+}
+
+void
+interval_tree_free (IntervalTree * tree)
+{
+  if (tree->destroy)
+    g_hash_table_foreach (tree->nodes, (GHFunc) destroy_data_foreach, tree);
+
+  g_hash_table_unref (tree->nodes);
+  g_slice_free (IntervalTree, tree);
+}
+
+void
+interval_tree_insert (IntervalTree * tree, gpointer data, guint64 start,
+    guint64 end, guint32 priority)
+{
+  IntervalTreeNode *node;
+
+  g_return_if_fail (g_hash_table_lookup (tree->nodes, data) == NULL);
+
+  node = g_slice_new0 (IntervalTreeNode);
+  node->data = data;
+  node->start = start;
+  node->end = MAX (start, end);
+  node->priority = priority;
+
+  g_hash_table_insert (tree->nodes, data, node);
+  tree->root = node_insert (tree->root, node);
+}
+
+gboolean
+interval_tree_remove (IntervalTree * tree, gpointer data)
+{
+  IntervalTreeNode *node = g_hash_table_lookup (tree->nodes, data);
+
+  if (node == NULL)
+    return FALSE;
+
+  tree->root = node_remove (tree->root, node);
+  g_hash_table_remove (tree->nodes, data);
+
+  if (tree->destroy)
+    tree->destroy (data);
+
+  return TRUE;
+}
+
+void
+interval_tree_update (IntervalTree * tree, gpointer data, guint64 start,
+    guint64 end, guint32 priority)
+{
+  IntervalTreeNode *node = g_hash_table_lookup (tree->nodes, data);
+
+  if (node == NULL)
+    return;
+
+  end = MAX (start, end);
+  if (node->start == start && node->end == end && node->priority == priority)
+    return;
+
+  tree->root = node_remove (tree->root, node);
+
+  node->start = start;
+  node->end = end;
+  node->priority = priority;
+  tree->root = node_insert (tree->root, node);
+}
+
+gboolean
+interval_tree_contains (IntervalTree * tree, gpointer data)
+{
+  return g_hash_table_lookup (tree->nodes, data) != NULL;
+}
+
+/* Returns the intervals for which start < @end and end > @start */
+GList *
+interval_tree_get_overlapping (IntervalTree * tree, guint64 start, guint64 end)
+{
+  GList *ret = NULL;
+
+  node_get_overlapping (tree->root, start, end, &ret);
+
+  return ret;
+}
+
+/* Returns the intervals for which end <= @position */
+GList *
+interval_tree_get_ending_before (IntervalTree * tree, guint64 position)
+{
+  GList *ret = NULL;
+
+  node_get_ending_before (tree->root, position, &ret);
+
+  return ret;
+}
+
+/* Returns the intervals for which start >= @position */
+GList *
+interval_tree_get_starting_after (IntervalTree * tree, guint64 position)
+{
+  GList *ret = NULL;
+
+  node_get_starting_after (tree->root, position, &ret);
+
+  return ret;
+}
@@ -0,0 +1,419 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * SECTION:ges-parallel-renderer
+ * @short_description: Renders a #GESTimeline in several pipelines at once
+ *
+ * #GESParallelRenderer splits a #GESTimeline into ranges with
+ * ges_timeline_get_render_cut_points() and renders each of them in its own
+ * #GESTimelinePipeline, all the pipelines running at the same time. Each
+ * pipeline works on a copy of the timeline made with the
+ * #GESKeyfileFormatter, so only the objects it can save are rendered.
+ *
+ * The renderer only produces the chunks: range number i is written to
+ * @output_uri with "-i" inserted before its extension, for example
+ * "file:///tmp/out-0.ogg" and "file:///tmp/out-1.ogg" for
+ * "file:///tmp/out.ogg", and ges_parallel_renderer_get_chunk_uris() lists
+ * them in order. The chunks are NOT joined into one file, the application
+ * has to concatenate them itself once #GESParallelRenderer::done was
+ * emitted.
+ *
+ * The pipelines post their messages on the default #GMainContext, which has
+ * to be running for the signals to be emitted.
+ */
+
+#include <string.h>
+
+#include "ges-internal.h"
+#include "ges-parallel-renderer.h"
+
+G_DEFINE_TYPE (GESParallelRenderer, ges_parallel_renderer, G_TYPE_OBJECT);
+
+struct _GESParallelRendererPrivate
+{
+  GESTimeline *timeline;
+  guint n_pipelines;
+
+  gchar *output_uri;
+  GstEncodingProfile *profile;
+
+  /* One pipeline and bus watch per chunk, set while rendering */
+  guint n_chunks;
+  GESTimelinePipeline **pipelines;
+  guint *watch_ids;
+  guint n_done;
+
+  gchar **chunk_uris;
+};
+
+enum
+{
+  DONE,
+  ERROR,
+  LAST_SIGNAL
+};
+
+static guint ges_parallel_renderer_signals[LAST_SIGNAL] = { 0 };
+
+static void
+ges_parallel_renderer_dispose (GObject * object)
+{
+  GESParallelRenderer *self = GES_PARALLEL_RENDERER (object);
+
+  ges_parallel_renderer_stop (self);
+
+  if (self->priv->timeline) {
+    gst_object_unref (self->priv->timeline);
+    self->priv->timeline = NULL;
+  }
+
+  if (self->priv->profile) {
+    gst_encoding_profile_unref (self->priv->profile);
+    self->priv->profile = NULL;
+  }
+
+  G_OBJECT_CLASS (ges_parallel_renderer_parent_class)->dispose (object);
+}
+
+static void
+ges_parallel_renderer_finalize (GObject * object)
+{
+  GESParallelRenderer *self = GES_PARALLEL_RENDERER (object);
+
+  g_free (self->priv->output_uri);
+  g_strfreev (self->priv->chunk_uris);
+
+  G_OBJECT_CLASS (ges_parallel_renderer_parent_class)->finalize (object);
+}
+
+static void
+ges_parallel_renderer_class_init (GESParallelRendererClass * klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (GESParallelRendererPrivate));
+
+  object_class->dispose = ges_parallel_renderer_dispose;
+  object_class->finalize = ges_parallel_renderer_finalize;
+
+  /**
+   * GESParallelRenderer::done
+   * @renderer: the #GESParallelRenderer
+   *
+   * Will be emitted once every chunk was rendered, after the pipelines were
+   * stopped. The chunks still have to be joined by the application.
+   */
+  ges_parallel_renderer_signals[DONE] =
+      g_signal_new ("done", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_FIRST, 0,
+      NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 0);
+
+  /**
+   * GESParallelRenderer::error
+   * @renderer: the #GESParallelRenderer
+   * @error: the #GError posted by the failing pipeline
+   *
+   * Will be emitted when one of the pipelines fails, after all of them were
+   * stopped. The chunks already written are left as they are.
+   */
+  ges_parallel_renderer_signals[ERROR] =
+      g_signal_new ("error", G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_FIRST, 0,
+      NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 1, G_TYPE_ERROR);
+}
+
+static void
+ges_parallel_renderer_init (GESParallelRenderer * self)
+{
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GES_TYPE_PARALLEL_RENDERER, GESParallelRendererPrivate);
+}
+
+/* Inserts "-@index" before the extension of the last component of @uri */
+static gchar *
+make_chunk_uri (const gchar * uri, guint index)
+{
+  const gchar *slash, *dot;
+
+  slash = strrchr (uri, '/');
+  dot = strrchr (uri, '.');
+
+  if (dot != NULL && (slash == NULL || dot > slash + 1))
+    return g_strdup_printf ("%.*s-%u%s", (gint) (dot - uri), uri, index, dot);
+
+  return g_strdup_printf ("%s-%u", uri, index);
+}
+
+static gboolean
+bus_message_cb (GstBus * bus, GstMessage * message,
+    GESParallelRenderer * self)
+{
+  GError *error = NULL;
+
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_EOS:
+      self->priv->n_done++;
+      GST_DEBUG_OBJECT (self, "Rendered %u of %u chunks", self->priv->n_done,
+          self->priv->n_chunks);
+
+      if (self->priv->n_done == self->priv->n_chunks) {
+        /* Handlers may drop the last reference */
+        g_object_ref (self);
+        ges_parallel_renderer_stop (self);
+        g_signal_emit (self, ges_parallel_renderer_signals[DONE], 0);
+        g_object_unref (self);
+      }
+      break;
+    case GST_MESSAGE_ERROR:
+      gst_message_parse_error (message, &error, NULL);
+      GST_WARNING_OBJECT (self, "Error from %s: %s",
+          GST_OBJECT_NAME (GST_MESSAGE_SRC (message)), error->message);
+
+      g_object_ref (self);
+      ges_parallel_renderer_stop (self);
+      g_signal_emit (self, ges_parallel_renderer_signals[ERROR], 0, error);
+      g_object_unref (self);
+
+      g_error_free (error);
+      break;
+    default:
+      break;
+  }
+
+  return TRUE;
+}
+
+/**
+ * ges_parallel_renderer_new:
+ * @timeline: the #GESTimeline to render
+ * @n_pipelines: the maximum number of pipelines to render @timeline with
+ *
+ * Creates a new #GESParallelRenderer for @timeline. @timeline itself is not
+ * modified, nor added to any pipeline, so it can keep being used while it is
+ * rendered.
+ *
+ * Returns: a new #GESParallelRenderer
+ */
+GESParallelRenderer *
+ges_parallel_renderer_new (GESTimeline * timeline, guint n_pipelines)
+{
+  GESParallelRenderer *renderer;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (n_pipelines > 0, NULL);
+
+  renderer = g_object_new (GES_TYPE_PARALLEL_RENDERER, NULL);
+  renderer->priv->timeline = gst_object_ref (timeline);
+  renderer->priv->n_pipelines = n_pipelines;
+
+  return renderer;
+}
+
+/**
+ * ges_parallel_renderer_set_render_settings:
+ * @renderer: a #GESParallelRenderer
+ * @output_uri: the URI the names of the chunks are made from
+ * @profile: the #GstEncodingProfile to render every chunk with
+ *
+ * Specifies where and how the chunks will be rendered. Can not be called
+ * while rendering.
+ *
+ * Returns: %TRUE if the settings were set, else %FALSE.
+ */
+gboolean
+ges_parallel_renderer_set_render_settings (GESParallelRenderer * renderer,
+    const gchar * output_uri, GstEncodingProfile * profile)
+{
+  g_return_val_if_fail (GES_IS_PARALLEL_RENDERER (renderer), FALSE);
+  g_return_val_if_fail (output_uri != NULL, FALSE);
+  g_return_val_if_fail (profile != NULL, FALSE);
+
+  if (renderer->priv->pipelines != NULL) {
+    GST_WARNING_OBJECT (renderer, "Can not change the settings while "
+        "rendering");
+    return FALSE;
+  }
+
+  g_free (renderer->priv->output_uri);
+  renderer->priv->output_uri = g_strdup (output_uri);
+
+  if (renderer->priv->profile)
+    gst_encoding_profile_unref (renderer->priv->profile);
+  renderer->priv->profile =
+      (GstEncodingProfile *) gst_encoding_profile_ref (profile);
+
+  return TRUE;
+}
+
+/**
+ * ges_parallel_renderer_start:
+ * @renderer: a #GESParallelRenderer
+ *
+ * Splits the timeline into at most as many ranges as pipelines were asked
+ * for, and starts rendering all of them. #GESParallelRenderer::done or
+ * #GESParallelRenderer::error will be emitted once the render is over.
+ *
+ * Returns: %TRUE if all the pipelines were started, else %FALSE, in which
+ * case none is left running.
+ */
+gboolean
+ges_parallel_renderer_start (GESParallelRenderer * renderer)
+{
+  GESParallelRendererPrivate *priv;
+  guint i, n_points;
+  guint64 *points;
+
+  g_return_val_if_fail (GES_IS_PARALLEL_RENDERER (renderer), FALSE);
+
+  priv = renderer->priv;
+
+  if (priv->pipelines != NULL) {
+    GST_WARNING_OBJECT (renderer, "Already rendering");
+    return FALSE;
+  }
+
+  if (priv->output_uri == NULL || priv->profile == NULL) {
+    GST_WARNING_OBJECT (renderer, "No render settings were set");
+    return FALSE;
+  }
+
+  points = ges_timeline_get_render_cut_points (priv->timeline,
+      priv->n_pipelines, &n_points);
+  if (n_points < 2) {
+    GST_WARNING_OBJECT (renderer, "Nothing to render in an empty timeline");
+    g_free (points);
+    return FALSE;
+  }
+
+  priv->n_chunks = n_points - 1;
+  priv->n_done = 0;
+  priv->pipelines = g_new0 (GESTimelinePipeline *, priv->n_chunks);
+  priv->watch_ids = g_new0 (guint, priv->n_chunks);
+
+  g_strfreev (priv->chunk_uris);
+  priv->chunk_uris = g_new0 (gchar *, priv->n_chunks + 1);
+
+  /* A timeline can only be in one pipeline */
+  for (i = 0; i < priv->n_chunks; i++) {
+    GESTimeline *copy;
+    GESTimelinePipeline *pipeline;
+    GstBus *bus;
+
+    priv->chunk_uris[i] = make_chunk_uri (priv->output_uri, i);
+
+    copy = timeline_copy (priv->timeline);
+    if (copy == NULL) {
+      GST_WARNING_OBJECT (renderer, "Could not copy the timeline");
+      goto fail;
+    }
+
+    pipeline = ges_timeline_pipeline_new ();
+    priv->pipelines[i] = pipeline;
+
+    if (!ges_timeline_pipeline_add_timeline (pipeline, copy)) {
+      gst_object_unref (gst_object_ref_sink (copy));
+      goto fail;
+    }
+
+    if (!ges_timeline_pipeline_set_render_settings (pipeline,
+            priv->chunk_uris[i], priv->profile) ||
+        !ges_timeline_pipeline_set_mode (pipeline, TIMELINE_MODE_RENDER) ||
+        !ges_timeline_pipeline_set_render_range (pipeline, points[i],
+            points[i + 1]))
+      goto fail;
+
+    bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+    priv->watch_ids[i] = gst_bus_add_watch (bus, (GstBusFunc) bus_message_cb,
+        renderer);
+    gst_object_unref (bus);
+  }
+
+  /* Each pipeline seeks to its range once prerolled */
+  for (i = 0; i < priv->n_chunks; i++) {
+    if (gst_element_set_state (GST_ELEMENT (priv->pipelines[i]),
+            GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+      GST_WARNING_OBJECT (renderer, "Could not start pipeline %u", i);
+      goto fail;
+    }
+  }
+
+  g_free (points);
+
+  return TRUE;
+
+fail:
+  g_free (points);
+  ges_parallel_renderer_stop (renderer);
+
+  return FALSE;
+}
+
+/**
+ * ges_parallel_renderer_stop:
+ * @renderer: a #GESParallelRenderer
+ *
+ * Stops and releases all the pipelines. The chunks rendered so far are left
+ * as they are. Does nothing when not rendering.
+ */
+void
+ges_parallel_renderer_stop (GESParallelRenderer * renderer)
+{
+  GESParallelRendererPrivate *priv;
+  guint i;
+
+  g_return_if_fail (GES_IS_PARALLEL_RENDERER (renderer));
+
+  priv = renderer->priv;
+
+  if (priv->pipelines == NULL)
+    return;
+
+  for (i = 0; i < priv->n_chunks; i++) {
+    if (priv->watch_ids[i])
+      g_source_remove (priv->watch_ids[i]);
+
+    if (priv->pipelines[i]) {
+      gst_element_set_state (GST_ELEMENT (priv->pipelines[i]),
+          GST_STATE_NULL);
+      gst_object_unref (priv->pipelines[i]);
+    }
+  }
+
+  g_free (priv->pipelines);
+  priv->pipelines = NULL;
+  g_free (priv->watch_ids);
+  priv->watch_ids = NULL;
+  priv->n_chunks = 0;
+}
+
+/**
+ * ges_parallel_renderer_get_chunk_uris:
+ * @renderer: a #GESParallelRenderer
+ *
+ * Gets the URIs of the chunks of the last render, in the order in which
+ * they have to be joined.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): the URIs of the
+ * chunks, or %NULL if no render was started. Free with g_strfreev().
+ */
+gchar **
+ges_parallel_renderer_get_chunk_uris (GESParallelRenderer * renderer)
+{
+  g_return_val_if_fail (GES_IS_PARALLEL_RENDERER (renderer), NULL);
+
+  return g_strdupv (renderer->priv->chunk_uris);
+}
@@ -0,0 +1,93 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _GES_PARALLEL_RENDERER
+#define _GES_PARALLEL_RENDERER
+
+#include <glib-object.h>
+#include <ges/ges.h>
+#include <gst/pbutils/encoding-profile.h>
+
+G_BEGIN_DECLS
+
+#define GES_TYPE_PARALLEL_RENDERER ges_parallel_renderer_get_type()
+
+#define GES_PARALLEL_RENDERER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST ((obj), GES_TYPE_PARALLEL_RENDERER, GESParallelRenderer))
+
+#define GES_PARALLEL_RENDERER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST ((klass), GES_TYPE_PARALLEL_RENDERER, GESParallelRendererClass))
+
+#define GES_IS_PARALLEL_RENDERER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GES_TYPE_PARALLEL_RENDERER))
+
+#define GES_IS_PARALLEL_RENDERER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE ((klass), GES_TYPE_PARALLEL_RENDERER))
+
+#define GES_PARALLEL_RENDERER_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj), GES_TYPE_PARALLEL_RENDERER, GESParallelRendererClass))
+
+typedef struct _GESParallelRendererPrivate GESParallelRendererPrivate;
+
+/**
+ * GESParallelRenderer:
+ *
+ */
+
+struct _GESParallelRenderer {
+  /*< private >*/
+  GObject parent;
+
+  GESParallelRendererPrivate *priv;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+/**
+ * GESParallelRendererClass:
+ * @parent_class: parent class
+ *
+ */
+
+struct _GESParallelRendererClass {
+  /*< private >*/
+  GObjectClass parent_class;
+
+  /* Padding for API extension */
+  gpointer _ges_reserved[GES_PADDING];
+};
+
+GType ges_parallel_renderer_get_type (void);
+
+GESParallelRenderer *ges_parallel_renderer_new (GESTimeline * timeline,
+						 guint n_pipelines);
+
+gboolean ges_parallel_renderer_set_render_settings (GESParallelRenderer * renderer,
+						     const gchar * output_uri,
+						     GstEncodingProfile * profile);
+
+gboolean ges_parallel_renderer_start (GESParallelRenderer * renderer);
+
+void ges_parallel_renderer_stop (GESParallelRenderer * renderer);
+
+gchar **ges_parallel_renderer_get_chunk_uris (GESParallelRenderer * renderer);
+
+G_END_DECLS
+
+#endif /* _GES_PARALLEL_RENDERER */
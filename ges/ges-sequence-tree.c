@@ -0,0 +1,579 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* SequenceTree: a balanced (AVL) binary tree of objects laid out one after
+ * the other, keyed by their position in the sequence, as in a
+ * GESSimpleTimelineLayer.
+ *
+ * Sources advance the timeline position by their duration, and transitions
+ * move it back by theirs (without going under 0). Each node knows the
+ * effect of its whole subtree on the timeline position, as a function
+ * x -> MAX (floor, x + shift), along with its size, its number of sources
+ * and the sum of their heights. This lets us get the nth object, the
+ * position of an object, and where it starts in the timeline in O(log n).
+ */
+
+#include "ges-internal.h"
+
+/* The floor of a function which is never clamped */
+#define NO_FLOOR G_MININT64
+
+struct _SequenceTreeNode
+{
+  gpointer data;
+
+  gboolean is_transition;
+  guint64 duration;
+  guint height;
+
+  /* Aggregated values of the subtree */
+  guint size;
+  guint n_sources;
+  guint heights;                /* Sum of the heights of the sources */
+  gint64 floor;                 /* The subtree moves position x to */
+  gint64 shift;                 /* MAX (floor, x + shift) */
+
+  gint level;
+  SequenceTreeNode *left;
+  SequenceTreeNode *right;
+  SequenceTreeNode *parent;
+};
+
+struct _SequenceTree
+{
+  SequenceTreeNode *root;
+
+  /* {data: SequenceTreeNode} */
+  GHashTable *nodes;
+};
+
+/* A function of the timeline position, MAX (floor, x + shift) */
+typedef struct
+{
+  gint64 floor;
+  gint64 shift;
+} PositionFunc;
+
+static const PositionFunc identity_func = { NO_FLOOR, 0 };
+
+/* Returns the function applying @first then @second */
+static inline PositionFunc
+position_func_compose (PositionFunc first, PositionFunc second)
+{
+  PositionFunc ret;
+
+  ret.floor = first.floor == NO_FLOOR ? second.floor :
+      MAX (second.floor, first.floor + second.shift);
+  ret.shift = first.shift + second.shift;
+
+  return ret;
+}
+
+static inline guint64
+position_func_apply (PositionFunc func, gint64 position)
+{
+  return MAX (func.floor, position + func.shift);
+}
+
+static inline PositionFunc
+node_own_func (SequenceTreeNode * node)
+{
+  PositionFunc ret;
+
+  if (node->is_transition) {
+    ret.floor = 0;
+    ret.shift = -(gint64) node->duration;
+  } else {
+    ret.floor = NO_FLOOR;
+    ret.shift = node->duration;
+  }
+
+  return ret;
+}
+
+static inline PositionFunc
+node_func (SequenceTreeNode * node)
+{
+  PositionFunc ret;
+
+  if (node == NULL)
+    return identity_func;
+
+  ret.floor = node->floor;
+  ret.shift = node->shift;
+
+  return ret;
+}
+
+static inline guint
+node_size (SequenceTreeNode * node)
+{
+  return node ? node->size : 0;
+}
+
+static inline guint
+node_n_sources (SequenceTreeNode * node)
+{
+  return node ? node->n_sources : 0;
+}
+
+static inline guint
+node_heights (SequenceTreeNode * node)
+{
+  return node ? node->heights : 0;
+}
+
+static inline gint
+node_level (SequenceTreeNode * node)
+{
+  return node ? node->level : 0;
+}
+
+static void
+node_fixup (SequenceTreeNode * node)
+{
+  PositionFunc func;
+
+  node->level = MAX (node_level (node->left), node_level (node->right)) + 1;
+  node->size = node_size (node->left) + node_size (node->right) + 1;
+  node->n_sources = node_n_sources (node->left) +
+      node_n_sources (node->right) + (node->is_transition ? 0 : 1);
+  node->heights = node_heights (node->left) + node_heights (node->right) +
+      (node->is_transition ? 0 : node->height);
+
+  func = position_func_compose (node_func (node->left), node_own_func (node));
+  func = position_func_compose (func, node_func (node->right));
+  node->floor = func.floor;
+  node->shift = func.shift;
+
+  if (node->left)
+    node->left->parent = node;
+  if (node->right)
+    node->right->parent = node;
+}
+
+static SequenceTreeNode *
+rotate_right (SequenceTreeNode * node)
+{
+  SequenceTreeNode *left = node->left;
+
+  node->left = left->right;
+  left->right = node;
+  node_fixup (node);
+  node_fixup (left);
+
+  return left;
+}
+
+static SequenceTreeNode *
+rotate_left (SequenceTreeNode * node)
+{
+  SequenceTreeNode *right = node->right;
+
+  node->right = right->left;
+  right->left = node;
+  node_fixup (node);
+  node_fixup (right);
+
+  return right;
+}
+
+static SequenceTreeNode *
+node_balance (SequenceTreeNode * node)
+{
+  gint balance;
+
+  node_fixup (node);
+  balance = node_level (node->left) - node_level (node->right);
+
+  if (balance > 1) {
+    if (node_level (node->left->left) < node_level (node->left->right))
+      node->left = rotate_left (node->left);
+
+    return rotate_right (node);
+  } else if (balance < -1) {
+    if (node_level (node->right->right) < node_level (node->right->left))
+      node->right = rotate_right (node->right);
+
+    return rotate_left (node);
+  }
+
+  return node;
+}
+
+static SequenceTreeNode *
+node_insert (SequenceTreeNode * root, guint position, SequenceTreeNode * node)
+{
+  if (root == NULL) {
+    node->left = node->right = NULL;
+    node_fixup (node);
+
+    return node;
+  }
+
+  if (position <= node_size (root->left))
+    root->left = node_insert (root->left, position, node);
+  else
+    root->right = node_insert (root->right,
+        position - node_size (root->left) - 1, node);
+
+  return node_balance (root);
+}
+
+/* Detaches the first node of the subtree in @min */
+static SequenceTreeNode *
+node_remove_min (SequenceTreeNode * root, SequenceTreeNode ** min)
+{
+  if (root->left == NULL) {
+    *min = root;
+
+    return root->right;
+  }
+
+  root->left = node_remove_min (root->left, min);
+
+  return node_balance (root);
+}
+
+static SequenceTreeNode *
+node_remove (SequenceTreeNode * root, guint position)
+{
+  guint left_size = node_size (root->left);
+  SequenceTreeNode *min;
+
+  if (position < left_size) {
+    root->left = node_remove (root->left, position);
+  } else if (position > left_size) {
+    root->right = node_remove (root->right, position - left_size - 1);
+  } else {
+    if (root->left == NULL || root->right == NULL)
+      return root->left ? root->left : root->right;
+
+    /* Replace the node by the first one of its right subtree */
+    min = NULL;
+    root->right = node_remove_min (root->right, &min);
+    min->left = root->left;
+    min->right = root->right;
+    root = min;
+  }
+
+  return node_balance (root);
+}
+
+static void
+node_free (SequenceTreeNode * node)
+{
+  g_slice_free (SequenceTreeNode, node);
+}
+
+static void
+set_root (SequenceTree * tree, SequenceTreeNode * root)
+{
+  tree->root = root;
+  if (root)
+    root->parent = NULL;
+}
+
+/* Gets the aggregated values of the @position first objects */
+static void
+get_prefix (SequenceTree * tree, guint position, PositionFunc * func,
+    guint * n_sources, guint * heights)
+{
+  SequenceTreeNode *node = tree->root;
+
+  *func = identity_func;
+  *n_sources = 0;
+  *heights = 0;
+
+  while (node) {
+    guint left_size = node_size (node->left);
+
+    if (position <= left_size) {
+      node = node->left;
+      continue;
+    }
+
+    *func = position_func_compose (*func, node_func (node->left));
+    *func = position_func_compose (*func, node_own_func (node));
+    *n_sources += node_n_sources (node->left);
+    *heights += node_heights (node->left);
+    if (!node->is_transition) {
+      *n_sources += 1;
+      *heights += node->height;
+    }
+
+    position -= left_size + 1;
+    node = node->right;
+  }
+}
+
+/* Returns the position of the @nth source, or of the @nth transition if
+ * @transition is %TRUE */
+static gint
+get_nth_of_kind (SequenceTree * tree, guint nth, gboolean transition)
+{
+  SequenceTreeNode *node = tree->root;
+  guint base = 0;
+
+  while (node) {
+    guint left_count = transition ?
+        node_size (node->left) - node_n_sources (node->left) :
+        node_n_sources (node->left);
+
+    if (nth < left_count) {
+      node = node->left;
+      continue;
+    }
+
+    if (nth == left_count && node->is_transition == transition)
+      return base + node_size (node->left);
+
+    nth -= left_count + (node->is_transition == transition ? 1 : 0);
+    base += node_size (node->left) + 1;
+    node = node->right;
+  }
+
+  return -1;
+}
+
+SequenceTree *
+sequence_tree_new (void)
+{
+  SequenceTree *tree = g_slice_new0 (SequenceTree);
+
+  tree->nodes = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+      (GDestroyNotify) node_free);
+
+  return tree;
+}
+
+void
+sequence_tree_free (SequenceTree * tree)
+{
+  g_hash_table_unref (tree->nodes);
+  g_slice_free (SequenceTree, tree);
+}
+
+guint
+sequence_tree_length (SequenceTree * tree)
+{
+  return node_size (tree->root);
+}
+
+/* Inserts @data at @position, or at the end if @position is out of range */
+void
+sequence_tree_insert (SequenceTree * tree, guint position, gpointer data,
+    gboolean is_transition, guint64 duration, guint height)
+{
+  SequenceTreeNode *node;
+
+  g_return_if_fail (g_hash_table_lookup (tree->nodes, data) == NULL);
+
+  node = g_slice_new0 (SequenceTreeNode);
+  node->data = data;
+  node->is_transition = is_transition;
+  node->duration = duration;
+  node->height = height;
+
+  g_hash_table_insert (tree->nodes, data, node);
+  set_root (tree, node_insert (tree->root,
+          MIN (position, sequence_tree_length (tree)), node));
+}
+
+/* Returns the position @data was at, or -1 if it was not in @tree */
+gint
+sequence_tree_remove (SequenceTree * tree, gpointer data)
+{
+  gint position = sequence_tree_index (tree, data);
+
+  if (position == -1)
+    return -1;
+
+  set_root (tree, node_remove (tree->root, position));
+  g_hash_table_remove (tree->nodes, data);
+
+  return position;
+}
+
+void
+sequence_tree_update (SequenceTree * tree, gpointer data, guint64 duration,
+    guint height)
+{
+  SequenceTreeNode *node = g_hash_table_lookup (tree->nodes, data);
+
+  if (node == NULL)
+    return;
+
+  node->duration = duration;
+  node->height = height;
+
+  /* The shape of the tree does not change */
+  for (; node; node = node->parent)
+    node_fixup (node);
+}
+
+gint
+sequence_tree_index (SequenceTree * tree, gpointer data)
+{
+  SequenceTreeNode *node = g_hash_table_lookup (tree->nodes, data);
+  guint position;
+
+  if (node == NULL)
+    return -1;
+
+  position = node_size (node->left);
+  for (; node->parent; node = node->parent) {
+    if (node == node->parent->right)
+      position += node_size (node->parent->left) + 1;
+  }
+
+  return position;
+}
+
+SequenceTreeNode *
+sequence_tree_get_node_at (SequenceTree * tree, guint position)
+{
+  SequenceTreeNode *node = tree->root;
+
+  while (node) {
+    guint left_size = node_size (node->left);
+
+    if (position == left_size)
+      return node;
+
+    if (position < left_size) {
+      node = node->left;
+    } else {
+      position -= left_size + 1;
+      node = node->right;
+    }
+  }
+
+  return NULL;
+}
+
+gpointer
+sequence_tree_nth (SequenceTree * tree, guint position)
+{
+  SequenceTreeNode *node = sequence_tree_get_node_at (tree, position);
+
+  return node ? node->data : NULL;
+}
+
+SequenceTreeNode *
+sequence_tree_node_next (SequenceTreeNode * node)
+{
+  if (node->right) {
+    for (node = node->right; node->left; node = node->left);
+
+    return node;
+  }
+
+  while (node->parent && node == node->parent->right)
+    node = node->parent;
+
+  return node->parent;
+}
+
+SequenceTreeNode *
+sequence_tree_node_prev (SequenceTreeNode * node)
+{
+  if (node->left) {
+    for (node = node->left; node->right; node = node->right);
+
+    return node;
+  }
+
+  while (node->parent && node == node->parent->left)
+    node = node->parent;
+
+  return node->parent;
+}
+
+gpointer
+sequence_tree_node_get_data (SequenceTreeNode * node)
+{
+  return node->data;
+}
+
+/* Returns the timeline position after the @position first objects */
+guint64
+sequence_tree_get_position (SequenceTree * tree, guint position)
+{
+  PositionFunc func;
+  guint n_sources, heights;
+
+  get_prefix (tree, position, &func, &n_sources, &heights);
+
+  return position_func_apply (func, 0);
+}
+
+/* Returns the sum of the heights of the sources among the @position first
+ * objects, and sets @n_sources to their number */
+guint
+sequence_tree_get_heights (SequenceTree * tree, guint position,
+    guint * n_sources)
+{
+  PositionFunc func;
+  guint count, heights;
+
+  get_prefix (tree, position, &func, &count, &heights);
+  if (n_sources)
+    *n_sources = count;
+
+  return heights;
+}
+
+/* Returns the position of the last source before @position, or -1 */
+gint
+sequence_tree_get_last_source (SequenceTree * tree, guint position)
+{
+  guint n_sources;
+
+  sequence_tree_get_heights (tree, position, &n_sources);
+
+  return n_sources ? get_nth_of_kind (tree, n_sources - 1, FALSE) : -1;
+}
+
+/* Returns the position of the last transition before @position, or -1 */
+gint
+sequence_tree_get_last_transition (SequenceTree * tree, guint position)
+{
+  guint n_sources, n_transitions;
+
+  position = MIN (position, sequence_tree_length (tree));
+  sequence_tree_get_heights (tree, position, &n_sources);
+  n_transitions = position - n_sources;
+
+  return n_transitions ? get_nth_of_kind (tree, n_transitions - 1, TRUE) : -1;
+}
+
+/* Returns the position of the first transition at or after @position, or
+ * -1 */
+gint
+sequence_tree_get_next_transition (SequenceTree * tree, guint position)
+{
+  guint n_sources;
+
+  if (position >= sequence_tree_length (tree))
+    return -1;
+
+  sequence_tree_get_heights (tree, position, &n_sources);
+
+  return get_nth_of_kind (tree, position - n_sources, TRUE);
+}
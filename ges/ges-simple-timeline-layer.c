@@ -45,8 +45,8 @@ ges_simple_timeline_layer_object_added (GESTimelineLayer * layer,
     GESTimelineObject * object);
 
 static void
-timeline_object_height_changed_cb (GESTimelineObject * object G_GNUC_UNUSED,
-    GParamSpec * arg G_GNUC_UNUSED, GESSimpleTimelineLayer * layer);
+timeline_object_changed_cb (GESTimelineObject * object, GParamSpec * arg,
+    GESSimpleTimelineLayer * layer);
 
 static GList *get_objects (GESTimelineLayer * layer);
 
@@ -55,8 +55,15 @@ G_DEFINE_TYPE (GESSimpleTimelineLayer, ges_simple_timeline_layer,
 
 struct _GESSimpleTimelineLayerPrivate
 {
-  /* Sorted list of objects */
-  GList *objects;
+  /* Objects, in order */
+  SequenceTree *objects;
+
+  /* Transitions which do not fit between their neighbours */
+  GHashTable *invalid_transitions;
+
+  /* First position to retime once the current edit is commited, G_MAXUINT
+   * if there is none */
+  guint retime_from;
 
   gboolean adding_object;
   gboolean valid;
@@ -103,6 +110,18 @@ ges_simple_timeline_layer_set_property (GObject * object, guint property_id,
   }
 }
 
+static void
+ges_simple_timeline_layer_finalize (GObject * object)
+{
+  GESSimpleTimelineLayerPrivate *priv =
+      GES_SIMPLE_TIMELINE_LAYER (object)->priv;
+
+  sequence_tree_free (priv->objects);
+  g_hash_table_unref (priv->invalid_transitions);
+
+  G_OBJECT_CLASS (ges_simple_timeline_layer_parent_class)->finalize (object);
+}
+
 static void
 ges_simple_timeline_layer_class_init (GESSimpleTimelineLayerClass * klass)
 {
@@ -113,6 +132,7 @@ ges_simple_timeline_layer_class_init (GESSimpleTimelineLayerClass * klass)
 
   object_class->get_property = ges_simple_timeline_layer_get_property;
   object_class->set_property = ges_simple_timeline_layer_set_property;
+  object_class->finalize = ges_simple_timeline_layer_finalize;
 
   /* Be informed when objects are being added/removed from elsewhere */
   layer_class->object_removed = ges_simple_timeline_layer_object_removed;
@@ -154,42 +174,98 @@ ges_simple_timeline_layer_init (GESSimpleTimelineLayer * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_SIMPLE_TIMELINE_LAYER, GESSimpleTimelineLayerPrivate);
 
-  self->priv->objects = NULL;
+  self->priv->objects = sequence_tree_new ();
+  self->priv->invalid_transitions = g_hash_table_new (g_direct_hash,
+      g_direct_equal);
+  self->priv->retime_from = G_MAXUINT;
+}
+
+/* Other kinds of objects are not laid out */
+static inline guint64
+object_duration (GESTimelineObject * object)
+{
+  if (GES_IS_TIMELINE_SOURCE (object) || GES_IS_TIMELINE_TRANSITION (object))
+    return GES_TIMELINE_OBJECT_DURATION (object);
+
+  return 0;
 }
 
+static inline guint
+object_height (GESTimelineObject * object)
+{
+  return GES_IS_TIMELINE_SOURCE (object) ?
+      GES_TIMELINE_OBJECT_HEIGHT (object) : 0;
+}
+
+/* Updates the start and priority of the objects from @from on. Past @to the
+ * objects did not change, so once a source is found in place, so are all the
+ * following objects. */
 static void
-gstl_recalculate (GESSimpleTimelineLayer * self)
+gstl_retime (GESSimpleTimelineLayer * self, guint from, guint to)
 {
-  GList *tmp;
-  gint64 pos = 0;
-  gint priority = 0;
+  SequenceTreeNode *node;
+  GESTimelineObject *obj;
+  guint i;
+  gint last_source;
+  guint64 pos;
+  gint base, priority;
   gint transition_priority = 0;
-  gint height;
-  GESTimelineObject *prev_object = NULL;
-  GESTimelineObject *prev_transition = NULL;
-  gboolean valid = TRUE;
+  GESTimelineLayer *layer = GES_TIMELINE_LAYER (self);
   GESSimpleTimelineLayerPrivate *priv = self->priv;
 
-  priority = GES_TIMELINE_LAYER (self)->min_gnl_priority + 2;
+  base = layer->min_gnl_priority + 2;
+  layer->max_gnl_priority = base + sequence_tree_get_heights (priv->objects,
+      sequence_tree_length (priv->objects), NULL);
+
+  if (layer->timeline && timeline_is_editing (layer->timeline)) {
+    GST_DEBUG ("Deferring retiming from %u to the end of the edit", from);
+    priv->retime_from = MIN (priv->retime_from, from);
+
+    return;
+  }
+
+  /* The layer might have left the timeline before the end of an edit */
+  if (priv->retime_from != G_MAXUINT) {
+    from = MIN (from, priv->retime_from);
+    to = G_MAXUINT;
+    priv->retime_from = G_MAXUINT;
+  }
 
-  GST_DEBUG ("recalculating values");
+  GST_DEBUG ("retiming from %u", from);
 
-  if (priv->objects && GES_IS_TIMELINE_TRANSITION (priv->objects->data)) {
-    valid = FALSE;
+  pos = sequence_tree_get_position (priv->objects, from);
+  priority = base + sequence_tree_get_heights (priv->objects, from, NULL);
+
+  /* Transitions go right above the last source before them */
+  for (last_source = sequence_tree_get_last_source (priv->objects, from);
+      last_source >= 0; last_source--) {
+    obj = sequence_tree_nth (priv->objects, last_source);
+
+    if (GES_IS_TIMELINE_SOURCE (obj)) {
+      transition_priority = MAX (0, base +
+          (gint) sequence_tree_get_heights (priv->objects, last_source,
+              NULL) - 1);
+      break;
+    }
   }
 
-  for (tmp = priv->objects; tmp; tmp = tmp->next) {
-    GESTimelineObject *obj;
+  for (i = from, node = sequence_tree_get_node_at (priv->objects, from); node;
+      i++, node = sequence_tree_node_next (node)) {
     guint64 dur;
-    GList *l_next;
 
-    obj = (GESTimelineObject *) tmp->data;
+    obj = sequence_tree_node_get_data (node);
     dur = GES_TIMELINE_OBJECT_DURATION (obj);
-    height = GES_TIMELINE_OBJECT_HEIGHT (obj);
 
     if (GES_IS_TIMELINE_SOURCE (obj)) {
 
-      GST_LOG ("%p obj: height: %d: priority %d", obj, height, priority);
+      if (i > to && GES_TIMELINE_OBJECT_START (obj) == pos &&
+          GES_TIMELINE_OBJECT_PRIORITY (obj) == priority) {
+        GST_DEBUG ("%p is already in place, stopping at %u", obj, i);
+        break;
+      }
+
+      GST_LOG ("%p obj: height: %d: priority %d", obj,
+          GES_TIMELINE_OBJECT_HEIGHT (obj), priority);
 
       if (G_UNLIKELY (GES_TIMELINE_OBJECT_START (obj) != pos)) {
         ges_timeline_object_set_start (obj, pos);
@@ -200,22 +276,15 @@ gstl_recalculate (GESSimpleTimelineLayer * self)
       }
 
       transition_priority = MAX (0, priority - 1);
-      priority += height;
+      priority += GES_TIMELINE_OBJECT_HEIGHT (obj);
       pos += dur;
 
-      g_assert (priority != -1);
-
     } else if (GES_IS_TIMELINE_TRANSITION (obj)) {
 
-      pos -= dur;
-      if (pos < 0)
-        pos = 0;
-
-      GST_LOG ("%p obj: height: %d: trans_priority %d Position: %" G_GINT64_FORMAT
-          ", duration %" G_GINT64_FORMAT, obj, height, transition_priority, pos,
-          dur);
+      pos = pos > dur ? pos - dur : 0;
 
-      g_assert (transition_priority != -1);
+      GST_LOG ("%p obj: trans_priority %d Position: %" G_GUINT64_FORMAT
+          ", duration %" G_GUINT64_FORMAT, obj, transition_priority, pos, dur);
 
       if (G_UNLIKELY (GES_TIMELINE_OBJECT_START (obj) != pos))
         ges_timeline_object_set_start (obj, pos);
@@ -224,60 +293,145 @@ gstl_recalculate (GESSimpleTimelineLayer * self)
               transition_priority)) {
         ges_timeline_object_set_priority (obj, transition_priority);
       }
+    }
+  }
+}
 
-      /* sanity checks */
-      l_next = g_list_next (tmp);
+/* Returns whether the transition at @position fits between its neighbours
+ * and does not overlap the previous transition */
+static gboolean
+transition_is_valid (GESSimpleTimelineLayer * self, SequenceTreeNode * node,
+    guint position)
+{
+  SequenceTreeNode *tmp;
+  GESTimelineObject *prev = NULL, *next = NULL;
+  gint prev_transition;
+  guint64 dur, start, end;
+  SequenceTree *objects = self->priv->objects;
 
-      if (GES_IS_TIMELINE_TRANSITION (prev_object)) {
-        GST_ERROR ("two transitions in sequence!");
-        valid = FALSE;
-      }
+  dur = GES_TIMELINE_OBJECT_DURATION (sequence_tree_node_get_data (node));
 
-      if (prev_object && (GES_TIMELINE_OBJECT_DURATION (prev_object) < dur)) {
-        GST_ERROR ("transition duration exceeds that of previous neighbor!");
-        valid = FALSE;
-      }
+  if ((tmp = sequence_tree_node_prev (node)))
+    prev = sequence_tree_node_get_data (tmp);
+  if ((tmp = sequence_tree_node_next (node)))
+    next = sequence_tree_node_get_data (tmp);
 
-      if (l_next && (GES_TIMELINE_OBJECT_DURATION (l_next->data) < dur)) {
-        GST_ERROR ("transition duration exceeds that of next neighbor!");
-        valid = FALSE;
-      }
+  if (GES_IS_TIMELINE_TRANSITION (prev)) {
+    GST_ERROR ("two transitions in sequence!");
+    return FALSE;
+  }
+
+  if (prev && (GES_TIMELINE_OBJECT_DURATION (prev) < dur)) {
+    GST_ERROR ("transition duration exceeds that of previous neighbor!");
+    return FALSE;
+  }
 
-      if (prev_transition) {
-        guint64 start, end;
-        end = (GES_TIMELINE_OBJECT_DURATION (prev_transition) +
-            GES_TIMELINE_OBJECT_START (prev_transition));
+  if (next && (GES_TIMELINE_OBJECT_DURATION (next) < dur)) {
+    GST_ERROR ("transition duration exceeds that of next neighbor!");
+    return FALSE;
+  }
 
-        start = pos;
+  prev_transition = sequence_tree_get_last_transition (objects, position);
+  if (prev_transition != -1) {
+    end = sequence_tree_get_position (objects, prev_transition + 1) +
+        GES_TIMELINE_OBJECT_DURATION (sequence_tree_nth (objects,
+            prev_transition));
+    start = sequence_tree_get_position (objects, position + 1);
 
-        if (end > start) {
-          GST_ERROR ("%" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ": "
-              "overlapping transitions!", start, end);
-          valid = FALSE;
-        }
-      }
-      prev_transition = obj;
+    if (end > start) {
+      GST_ERROR ("%" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT ": "
+          "overlapping transitions!", start, end);
+      return FALSE;
     }
+  }
+
+  return TRUE;
+}
 
-    prev_object = obj;
+static void
+check_transition (GESSimpleTimelineLayer * self, SequenceTreeNode * node,
+    guint position)
+{
+  gpointer obj = sequence_tree_node_get_data (node);
 
-  }
+  if (!GES_IS_TIMELINE_TRANSITION (obj))
+    return;
 
-  if (prev_object && GES_IS_TIMELINE_TRANSITION (prev_object)) {
-    valid = FALSE;
-  }
+  if (transition_is_valid (self, node, position))
+    g_hash_table_remove (self->priv->invalid_transitions, obj);
+  else
+    g_hash_table_insert (self->priv->invalid_transitions, obj, obj);
+}
+
+/* Checks again the transitions a change of the objects from @from to @to
+ * might have affected: the ones around them, and the first one after them,
+ * which might now overlap the previous one */
+static void
+gstl_check_transitions (GESSimpleTimelineLayer * self, guint from, guint to)
+{
+  SequenceTreeNode *node;
+  guint i, lo, hi, len;
+  gint next_transition;
+  gboolean valid = TRUE;
+  GESSimpleTimelineLayerPrivate *priv = self->priv;
 
-  GST_DEBUG ("Finished recalculating: final start pos is: %" GST_TIME_FORMAT,
-      GST_TIME_ARGS (pos));
+  len = sequence_tree_length (priv->objects);
 
-  GES_TIMELINE_LAYER (self)->max_gnl_priority = priority;
+  if (len) {
+    lo = from ? from - 1 : 0;
+    hi = MIN (to + 1, len - 1);
 
-  if (valid != self->priv->valid) {
-    self->priv->valid = valid;
+    for (i = lo, node = sequence_tree_get_node_at (priv->objects, lo);
+        node && i <= hi; i++, node = sequence_tree_node_next (node))
+      check_transition (self, node, i);
+
+    next_transition = sequence_tree_get_next_transition (priv->objects, hi + 1);
+    if (next_transition != -1)
+      check_transition (self, sequence_tree_get_node_at (priv->objects,
+              next_transition), next_transition);
+
+    valid = g_hash_table_size (priv->invalid_transitions) == 0 &&
+        !GES_IS_TIMELINE_TRANSITION (sequence_tree_nth (priv->objects, 0)) &&
+        !GES_IS_TIMELINE_TRANSITION (sequence_tree_nth (priv->objects,
+            len - 1));
+  }
+
+  if (valid != priv->valid) {
+    priv->valid = valid;
     g_object_notify (G_OBJECT (self), "valid");
   }
 }
 
+/* To be called once the objects from @from to @to changed */
+static inline void
+gstl_update (GESSimpleTimelineLayer * self, guint from, guint to)
+{
+  gstl_check_transitions (self, from, to);
+  gstl_retime (self, from, to);
+}
+
+static void
+gstl_insert (GESSimpleTimelineLayer * self, GESTimelineObject * object,
+    guint position)
+{
+  sequence_tree_insert (self->priv->objects, position, object,
+      GES_IS_TIMELINE_TRANSITION (object), object_duration (object),
+      object_height (object));
+}
+
+/* Retimes the objects left behind during the edit which just ended */
+void
+simple_timeline_layer_commit_edit (GESSimpleTimelineLayer * layer)
+{
+  guint from = layer->priv->retime_from;
+
+  if (from == G_MAXUINT)
+    return;
+
+  layer->priv->retime_from = G_MAXUINT;
+  gstl_retime (layer, from, G_MAXUINT);
+}
+
 /**
  * ges_simple_timeline_layer_add_object:
  * @layer: a #GESSimpleTimelineLayer
@@ -302,18 +456,18 @@ ges_simple_timeline_layer_add_object (GESSimpleTimelineLayer * layer,
     GESTimelineObject * object, gint position)
 {
   gboolean res;
-  GList *nth;
+  gint idx, len;
   GESSimpleTimelineLayerPrivate *priv = layer->priv;
 
   GST_DEBUG ("layer:%p, object:%p, position:%d", layer, object, position);
 
-  nth = g_list_nth (priv->objects, position);
-
-  if (GES_IS_TIMELINE_TRANSITION (object)) {
-    GList *lprev = g_list_previous (nth);
+  len = sequence_tree_length (priv->objects);
 
-    GESTimelineObject *prev = GES_TIMELINE_OBJECT (lprev ? lprev->data : NULL);
-    GESTimelineObject *next = GES_TIMELINE_OBJECT (nth ? nth->data : NULL);
+  /* Objects added at the end are not checked against their neighbours */
+  if (GES_IS_TIMELINE_TRANSITION (object) && position >= 0 && position < len) {
+    GESTimelineObject *prev = position ?
+        sequence_tree_nth (priv->objects, position - 1) : NULL;
+    GESTimelineObject *next = sequence_tree_nth (priv->objects, position);
 
     if ((prev && GES_IS_TIMELINE_TRANSITION (prev)) ||
         (next && GES_IS_TIMELINE_TRANSITION (next))) {
@@ -327,7 +481,7 @@ ges_simple_timeline_layer_add_object (GESSimpleTimelineLayer * layer,
   priv->adding_object = TRUE;
 
   /* provisionally insert the object */
-  priv->objects = g_list_insert (priv->objects, object, position);
+  gstl_insert (layer, object, position < 0 ? len : position);
 
   res = ges_timeline_layer_add_object ((GESTimelineLayer *) layer, object);
 
@@ -335,7 +489,7 @@ ges_simple_timeline_layer_add_object (GESSimpleTimelineLayer * layer,
   if (G_UNLIKELY (!res)) {
     priv->adding_object = FALSE;
     /* we failed to add the object, so remove it from our list */
-    priv->objects = g_list_remove (priv->objects, object);
+    sequence_tree_remove (priv->objects, object);
     return FALSE;
   }
 
@@ -343,12 +497,9 @@ ges_simple_timeline_layer_add_object (GESSimpleTimelineLayer * layer,
 
   GST_DEBUG ("Adding object %p to the list", object);
 
-
-  g_signal_connect (G_OBJECT (object), "notify::height", G_CALLBACK
-      (timeline_object_height_changed_cb), layer);
-
   /* recalculate positions */
-  gstl_recalculate (layer);
+  idx = sequence_tree_index (priv->objects, object);
+  gstl_update (layer, idx, idx);
 
   return TRUE;
 }
@@ -367,15 +518,10 @@ ges_simple_timeline_layer_add_object (GESSimpleTimelineLayer * layer,
 GESTimelineObject *
 ges_simple_timeline_layer_nth (GESSimpleTimelineLayer * layer, gint position)
 {
-  GList *list;
-  GESSimpleTimelineLayerPrivate *priv = layer->priv;
-
-  list = g_list_nth (priv->objects, position);
+  if (position < 0)
+    return NULL;
 
-  if (list)
-    return GES_TIMELINE_OBJECT (list->data);
-
-  return NULL;
+  return sequence_tree_nth (layer->priv->objects, position);
 }
 
 /**
@@ -393,8 +539,7 @@ gint
 ges_simple_timeline_layer_index (GESSimpleTimelineLayer * layer,
     GESTimelineObject * object)
 {
-  GESSimpleTimelineLayerPrivate *priv = layer->priv;
-  return g_list_index (priv->objects, object);
+  return sequence_tree_index (layer->priv->objects, object);
 }
 
 /**
@@ -414,7 +559,8 @@ gboolean
 ges_simple_timeline_layer_move_object (GESSimpleTimelineLayer * layer,
     GESTimelineObject * object, gint newposition)
 {
-  gint idx;
+  gint idx, newidx, gap, len;
+  GESTimelineObject *next;
   GESSimpleTimelineLayerPrivate *priv = layer->priv;
   GESTimelineLayer *tl_obj_layer;
 
@@ -431,7 +577,7 @@ ges_simple_timeline_layer_move_object (GESSimpleTimelineLayer * layer,
     g_object_unref (tl_obj_layer);
 
   /* Find it's current position */
-  idx = g_list_index (priv->objects, object);
+  idx = sequence_tree_index (priv->objects, object);
   if (G_UNLIKELY (idx == -1)) {
     GST_WARNING ("TimelineObject not controlled by this layer");
     return FALSE;
@@ -443,14 +589,23 @@ ges_simple_timeline_layer_move_object (GESSimpleTimelineLayer * layer,
   if (idx == newposition)
     return TRUE;
 
+  /* The objects around it end up next to each other */
+  next = sequence_tree_nth (priv->objects, idx + 1);
+
   /* pop it off the list */
-  priv->objects = g_list_remove (priv->objects, object);
+  sequence_tree_remove (priv->objects, object);
 
   /* re-add it at the proper position */
-  priv->objects = g_list_insert (priv->objects, object, newposition);
+  len = sequence_tree_length (priv->objects);
+  gstl_insert (layer, object, newposition < 0 ? len : newposition);
+
+  newidx = sequence_tree_index (priv->objects, object);
+  gap = next ? sequence_tree_index (priv->objects, next) : len + 1;
 
   /* recalculate positions */
-  gstl_recalculate (layer);
+  gstl_check_transitions (layer, gap, gap);
+  gstl_check_transitions (layer, newidx, newidx);
+  gstl_retime (layer, MIN (idx, newidx), MAX (idx, newidx));
 
   g_signal_emit (layer, gstl_signals[OBJECT_MOVED], 0, object, idx,
       newposition);
@@ -492,48 +647,69 @@ static void
 ges_simple_timeline_layer_object_removed (GESTimelineLayer * layer,
     GESTimelineObject * object)
 {
+  gint idx;
   GESSimpleTimelineLayer *sl = (GESSimpleTimelineLayer *) layer;
 
+  g_signal_handlers_disconnect_by_func (object, timeline_object_changed_cb,
+      sl);
+
   /* remove object from our list */
-  sl->priv->objects = g_list_remove (sl->priv->objects, object);
-  gstl_recalculate (sl);
+  idx = sequence_tree_remove (sl->priv->objects, object);
+  if (idx == -1)
+    return;
+
+  g_hash_table_remove (sl->priv->invalid_transitions, object);
+  gstl_update (sl, idx, idx);
 }
 
 static void
 ges_simple_timeline_layer_object_added (GESTimelineLayer * layer,
     GESTimelineObject * object)
 {
+  guint len;
   GESSimpleTimelineLayer *sl = (GESSimpleTimelineLayer *) layer;
 
   if (sl->priv->adding_object == FALSE) {
-    /* remove object from our list */
-    sl->priv->objects = g_list_append (sl->priv->objects, object);
-    gstl_recalculate (sl);
+    /* add object at the end of our list */
+    len = sequence_tree_length (sl->priv->objects);
+    gstl_insert (sl, object, len);
+    gstl_update (sl, len, len);
   }
-  g_signal_connect_swapped (object, "notify::duration",
-      G_CALLBACK (gstl_recalculate), layer);
+
+  g_signal_connect (object, "notify::duration",
+      G_CALLBACK (timeline_object_changed_cb), layer);
+  g_signal_connect (object, "notify::height",
+      G_CALLBACK (timeline_object_changed_cb), layer);
 }
 
 static void
-timeline_object_height_changed_cb (GESTimelineObject * object,
-    GParamSpec * arg G_GNUC_UNUSED, GESSimpleTimelineLayer * layer)
+timeline_object_changed_cb (GESTimelineObject * object, GParamSpec * arg,
+    GESSimpleTimelineLayer * layer)
 {
-  GST_LOG ("layer %p: notify height changed %p", layer, object);
-  gstl_recalculate (layer);
+  gint idx;
+
+  GST_LOG ("layer %p: notify %s changed %p", layer, arg->name, object);
+
+  idx = sequence_tree_index (layer->priv->objects, object);
+  if (idx == -1)
+    return;
+
+  sequence_tree_update (layer->priv->objects, object,
+      object_duration (object), object_height (object));
+  gstl_update (layer, idx, idx);
 }
 
 static GList *
 get_objects (GESTimelineLayer * l)
 {
-  GList *ret;
-  GList *tmp;
+  GList *ret = NULL;
+  SequenceTreeNode *node;
   GESSimpleTimelineLayer *layer = (GESSimpleTimelineLayer *) l;
 
-  ret = g_list_copy (layer->priv->objects);
-
-  for (tmp = ret; tmp; tmp = tmp->next) {
-    g_object_ref (tmp->data);
-  }
+  for (node = sequence_tree_get_node_at (layer->priv->objects, 0); node;
+      node = sequence_tree_node_next (node))
+    ret = g_list_prepend (ret,
+        g_object_ref (sequence_tree_node_get_data (node)));
 
-  return ret;
+  return g_list_reverse (ret);
 }
@@ -0,0 +1,302 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* SnapIndex: the start and end edges of a set of owners, kept sorted by
+ * position in flat arrays so that the edges close to a position can be found
+ * with a binary search, and the last edge is at the tail of the arrays.
+ *
+ * Each owner gets an integer id, its start edge has the handle id * 2 and its
+ * end edge id * 2 + 1. For each handle we remember the index of the edge in
+ * the sorted arrays, which lets us move an edge by only shifting the edges
+ * it passes over.
+ *
+ * Removed edges are left in place as tombstones, so that removing is O(1),
+ * and the arrays are compacted once tombstones make half of them.
+ */
+
+#include "ges-internal.h"
+
+#define TOMBSTONE G_MAXUINT
+#define EDGE_HANDLE(id, kind) ((id) * 2 + (kind))
+#define EDGE_OWNER_ID(handle) ((handle) / 2)
+
+struct _SnapIndex
+{
+  /* The sorted edges */
+  guint64 *positions;
+  guint *handles;               /* TOMBSTONE for removed edges */
+  guint len;
+  guint allocated;
+  guint n_tombstones;
+
+  /* Indexed by edge handle, index of the edge in the sorted arrays */
+  GArray *edge_index;
+
+  /* Indexed by owner id, NULL for unused ids */
+  GPtrArray *owners;
+  GArray *free_ids;
+
+  /* {owner: id + 1} */
+  GHashTable *ids;
+};
+
+static inline void
+set_edge (SnapIndex * index, guint i, guint64 position, guint handle)
+{
+  index->positions[i] = position;
+  index->handles[i] = handle;
+
+  if (handle != TOMBSTONE)
+    g_array_index (index->edge_index, guint, handle) = i;
+}
+
+/* Moves the edge at @i to @position, shifting the edges in between */
+static void
+move_edge (SnapIndex * index, guint i, guint64 position)
+{
+  guint handle = index->handles[i];
+
+  while (i + 1 < index->len && index->positions[i + 1] < position) {
+    set_edge (index, i, index->positions[i + 1], index->handles[i + 1]);
+    i++;
+  }
+
+  while (i > 0 && index->positions[i - 1] > position) {
+    set_edge (index, i, index->positions[i - 1], index->handles[i - 1]);
+    i--;
+  }
+
+  set_edge (index, i, position, handle);
+}
+
+static void
+append_edge (SnapIndex * index, guint64 position, guint handle)
+{
+  if (index->len == index->allocated) {
+    index->allocated = MAX (64, index->allocated * 2);
+    index->positions = g_renew (guint64, index->positions, index->allocated);
+    index->handles = g_renew (guint, index->handles, index->allocated);
+  }
+
+  /* Add it at the end and let it sink to its place */
+  index->len++;
+  set_edge (index, index->len - 1, G_MAXUINT64, handle);
+  move_edge (index, index->len - 1, position);
+}
+
+static void
+compact (SnapIndex * index)
+{
+  guint i, j;
+
+  for (i = 0, j = 0; i < index->len; i++) {
+    if (index->handles[i] != TOMBSTONE)
+      set_edge (index, j++, index->positions[i], index->handles[i]);
+  }
+
+  index->len = j;
+  index->n_tombstones = 0;
+}
+
+/* Drops the tombstones at the tail of the arrays */
+static inline void
+trim_tail (SnapIndex * index)
+{
+  while (index->len && index->handles[index->len - 1] == TOMBSTONE) {
+    index->len--;
+    index->n_tombstones--;
+  }
+}
+
+static inline gboolean
+lookup_id (SnapIndex * index, gpointer owner, guint * id)
+{
+  guint tmp = GPOINTER_TO_UINT (g_hash_table_lookup (index->ids, owner));
+
+  if (tmp == 0)
+    return FALSE;
+
+  *id = tmp - 1;
+
+  return TRUE;
+}
+
+SnapIndex *
+snap_index_new (void)
+{
+  SnapIndex *index = g_slice_new0 (SnapIndex);
+
+  index->edge_index = g_array_new (FALSE, TRUE, sizeof (guint));
+  index->owners = g_ptr_array_new ();
+  index->free_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  index->ids = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  return index;
+}
+
+void
+snap_index_free (SnapIndex * index)
+{
+  g_free (index->positions);
+  g_free (index->handles);
+  g_array_free (index->edge_index, TRUE);
+  g_ptr_array_free (index->owners, TRUE);
+  g_array_free (index->free_ids, TRUE);
+  g_hash_table_unref (index->ids);
+
+  g_slice_free (SnapIndex, index);
+}
+
+void
+snap_index_add (SnapIndex * index, gpointer owner, guint64 start, guint64 end)
+{
+  guint id;
+
+  g_return_if_fail (g_hash_table_lookup (index->ids, owner) == NULL);
+
+  if (index->free_ids->len) {
+    id = g_array_index (index->free_ids, guint, index->free_ids->len - 1);
+    g_array_set_size (index->free_ids, index->free_ids->len - 1);
+    g_ptr_array_index (index->owners, id) = owner;
+  } else {
+    id = index->owners->len;
+    g_ptr_array_add (index->owners, owner);
+    g_array_set_size (index->edge_index, EDGE_HANDLE (id + 1, 0));
+  }
+
+  g_hash_table_insert (index->ids, owner, GUINT_TO_POINTER (id + 1));
+
+  append_edge (index, start, EDGE_HANDLE (id, SNAP_EDGE_START));
+  append_edge (index, MAX (start, end), EDGE_HANDLE (id, SNAP_EDGE_END));
+}
+
+void
+snap_index_remove (SnapIndex * index, gpointer owner)
+{
+  guint id, kind;
+
+  if (!lookup_id (index, owner, &id))
+    return;
+
+  for (kind = SNAP_EDGE_START; kind <= SNAP_EDGE_END; kind++) {
+    guint i = g_array_index (index->edge_index, guint, EDGE_HANDLE (id, kind));
+
+    index->handles[i] = TOMBSTONE;
+    index->n_tombstones++;
+  }
+
+  g_hash_table_remove (index->ids, owner);
+  g_ptr_array_index (index->owners, id) = NULL;
+  g_array_append_val (index->free_ids, id);
+
+  trim_tail (index);
+
+  if (index->n_tombstones > index->len / 2)
+    compact (index);
+}
+
+void
+snap_index_update (SnapIndex * index, gpointer owner, guint64 start,
+    guint64 end)
+{
+  guint id;
+
+  if (!lookup_id (index, owner, &id))
+    return;
+
+  move_edge (index, g_array_index (index->edge_index, guint,
+          EDGE_HANDLE (id, SNAP_EDGE_START)), start);
+  move_edge (index, g_array_index (index->edge_index, guint,
+          EDGE_HANDLE (id, SNAP_EDGE_END)), MAX (start, end));
+}
+
+/* Returns the position of the last edge, or 0 if there are none */
+guint64
+snap_index_get_last_position (SnapIndex * index)
+{
+  /* Moving edges can leave tombstones at the tail */
+  trim_tail (index);
+
+  return index->len ? index->positions[index->len - 1] : 0;
+}
+
+/* Looks for the edge the closest to @position, no further than @distance,
+ * for which @filter returns %TRUE. The edges are visited by increasing
+ * distance so only the edges within @distance are considered.
+ *
+ * Returns: %TRUE if an edge was found, in which case @snapped and @owner are
+ * set to its position and owner */
+gboolean
+snap_index_find_closest (SnapIndex * index, guint64 position,
+    guint64 distance, SnapIndexFilter filter, gpointer user_data,
+    guint64 * snapped, gpointer * owner)
+{
+  guint lo = 0, hi = index->len, after;
+  gint before;
+
+  /* Find the first edge at or after @position */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (index->positions[mid] < position)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  after = lo;
+  before = (gint) lo - 1;
+
+  while (after < index->len || before >= 0) {
+    guint i, handle;
+    guint64 off_after = G_MAXUINT64, off_before = G_MAXUINT64;
+    gpointer tmp_owner;
+
+    if (after < index->len)
+      off_after = index->positions[after] - position;
+    if (before >= 0)
+      off_before = position - index->positions[before];
+
+    /* On equal distances, prefer the later edge */
+    if (after < index->len && off_after <= off_before) {
+      if (off_after > distance)
+        return FALSE;
+      i = after++;
+    } else {
+      if (off_before > distance)
+        return FALSE;
+      i = before--;
+    }
+
+    handle = index->handles[i];
+    if (handle == TOMBSTONE)
+      continue;
+
+    tmp_owner = g_ptr_array_index (index->owners, EDGE_OWNER_ID (handle));
+    if (filter && !filter (tmp_owner, user_data))
+      continue;
+
+    *snapped = index->positions[i];
+    if (owner)
+      *owner = tmp_owner;
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
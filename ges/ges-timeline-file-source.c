@@ -42,6 +42,10 @@ struct _GESTimelineFileSourcePrivate
 
   gboolean mute;
   gboolean is_image;
+
+  /* The caps of the discovered streams of the file, empty if it could not
+   * be discovered */
+  GstCaps *stream_caps;
 };
 
 enum
@@ -111,6 +115,8 @@ ges_timeline_filesource_finalize (GObject * object)
 
   if (priv->uri)
     g_free (priv->uri);
+  if (priv->stream_caps)
+    gst_caps_unref (priv->stream_caps);
   G_OBJECT_CLASS (ges_timeline_filesource_parent_class)->finalize (object);
 }
 
@@ -268,6 +274,24 @@ ges_timeline_filesource_set_is_image (GESTimelineFileSource * self,
   self->priv->is_image = is_image;
 }
 
+/* Called once the file of @tfs was discovered, with empty @caps if it could
+ * not be */
+void
+timeline_filesource_set_stream_caps (GESTimelineFileSource * tfs,
+    GstCaps * caps)
+{
+  gst_caps_replace (&tfs->priv->stream_caps, caps);
+}
+
+/* Returns a new reference to the caps of the streams of the file of @tfs,
+ * or NULL if it was not discovered */
+GstCaps *
+timeline_filesource_get_stream_caps (GESTimelineFileSource * tfs)
+{
+  return tfs->priv->stream_caps ? gst_caps_ref (tfs->priv->stream_caps) :
+      NULL;
+}
+
 /**
  * ges_timeline_filesource_is_muted:
  * @self: the #GESTimelineFileSource 
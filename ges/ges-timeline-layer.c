@@ -39,18 +39,39 @@
 static void
 timeline_object_height_changed_cb (GESTimelineObject * obj,
     GESTrackEffect * tr_eff, GESTimelineObject * second_obj);
+static void
+track_object_changed_cb (GESTrackObject * track_object,
+    GParamSpec * arg G_GNUC_UNUSED);
+static void
+track_object_duration_cb (GESTrackObject * track_object,
+    GParamSpec * arg G_GNUC_UNUSED);
 
 G_DEFINE_TYPE (GESTimelineLayer, ges_timeline_layer, G_TYPE_INITIALLY_UNOWNED);
 
 struct _GESTimelineLayerPrivate
 {
   /*< private > */
-  GList *objects_start;         /* The TimelineObjects sorted by start and
+  GSequence *objects_start;     /* The TimelineObjects sorted by start and
                                  * priority */
+  GHashTable *objects_iters;    /* {TimelineObject: GSequenceIter} */
+
+  /* The TrackObjects of our TimelineObjects in each track sorted by start
+   * and priority, while auto-transition is active */
+  GHashTable *tracks_objects;   /* {Track: GSequence} */
+  GHashTable *track_objects_iters;      /* {TrackObject: GSequenceIter} */
 
   guint32 priority;             /* The priority of the layer within the
                                  * containing timeline */
+
+  /* The min_gnl_priority the children of our objects are placed with. When
+   * the layer moves, they are only placed again once the timeline edit is
+   * commited */
+  guint32 placed_min_gnl_priority;
   gboolean auto_transition;
+
+  /* TrackSource-s for which transitions have to be recalculated once the
+   * timeline edit is commited */
+  GHashTable *pending_transitions;
 };
 
 enum
@@ -116,13 +137,31 @@ ges_timeline_layer_dispose (GObject * object)
 
   GST_DEBUG ("Disposing layer");
 
-  while (priv->objects_start)
-    ges_timeline_layer_remove_object (layer,
-        (GESTimelineObject *) priv->objects_start->data);
+  while (!ges_timeline_layer_is_empty (layer))
+    ges_timeline_layer_remove_object (layer, (GESTimelineObject *)
+        g_sequence_get (g_sequence_get_begin_iter (priv->objects_start)));
+
+  if (priv->pending_transitions) {
+    g_hash_table_unref (priv->pending_transitions);
+    priv->pending_transitions = NULL;
+  }
 
   G_OBJECT_CLASS (ges_timeline_layer_parent_class)->dispose (object);
 }
 
+static void
+ges_timeline_layer_finalize (GObject * object)
+{
+  GESTimelineLayerPrivate *priv = GES_TIMELINE_LAYER (object)->priv;
+
+  g_sequence_free (priv->objects_start);
+  g_hash_table_unref (priv->objects_iters);
+  g_hash_table_unref (priv->tracks_objects);
+  g_hash_table_unref (priv->track_objects_iters);
+
+  G_OBJECT_CLASS (ges_timeline_layer_parent_class)->finalize (object);
+}
+
 static void
 ges_timeline_layer_class_init (GESTimelineLayerClass * klass)
 {
@@ -133,6 +172,7 @@ ges_timeline_layer_class_init (GESTimelineLayerClass * klass)
   object_class->get_property = ges_timeline_layer_get_property;
   object_class->set_property = ges_timeline_layer_set_property;
   object_class->dispose = ges_timeline_layer_dispose;
+  object_class->finalize = ges_timeline_layer_finalize;
 
   /**
    * GESTimelineLayer:priority
@@ -189,14 +229,24 @@ ges_timeline_layer_init (GESTimelineLayer * self)
       GES_TYPE_TIMELINE_LAYER, GESTimelineLayerPrivate);
 
   self->priv->priority = 0;
+  self->priv->placed_min_gnl_priority = 0;
   self->priv->auto_transition = FALSE;
+  self->priv->pending_transitions = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, g_object_unref, NULL);
+  self->priv->objects_start = g_sequence_new (NULL);
+  self->priv->objects_iters = g_hash_table_new (g_direct_hash, g_direct_equal);
+  self->priv->tracks_objects = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) g_sequence_free);
+  self->priv->track_objects_iters = g_hash_table_new (g_direct_hash,
+      g_direct_equal);
   self->min_gnl_priority = 0;
   self->max_gnl_priority = LAYER_HEIGHT;
 }
 
 /* Private methods and utils */
 static gint
-objects_start_compare (GESTimelineObject * a, GESTimelineObject * b)
+objects_start_compare (GESTimelineObject * a, GESTimelineObject * b,
+    gpointer user_data)
 {
   if (a->start == b->start) {
     if (a->priority < b->priority)
@@ -212,43 +262,187 @@ objects_start_compare (GESTimelineObject * a, GESTimelineObject * b)
   return 0;
 }
 
-static GList *
-track_get_by_layer (GESTimelineLayer * layer, GESTrack * track)
+static gint
+track_objects_start_compare (GESTrackObject * a, GESTrackObject * b,
+    gpointer user_data)
 {
-  GESTrackObject *tckobj;
-  guint32 layer_prio = layer->priv->priority;
+  if (a->start == b->start) {
+    if (a->priority < b->priority)
+      return -1;
+    if (a->priority > b->priority)
+      return 1;
+    return 0;
+  }
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+  return 0;
+}
 
-  GList *tck_objects_list = NULL, *tmp = NULL, *return_list = NULL;
+/* Index of the TrackObject-s of the layer in each track, only maintained
+ * while auto-transition is active */
+static void
+track_object_position_changed_cb (GESTrackObject * track_object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimelineLayer * layer)
+{
+  GSequenceIter *iter = g_hash_table_lookup (layer->priv->track_objects_iters,
+      track_object);
 
-  tck_objects_list = ges_track_get_objects (track);
-  for (tmp = tck_objects_list; tmp; tmp = tmp->next) {
-    tckobj = GES_TRACK_OBJECT (tmp->data);
+  if (iter)
+    g_sequence_sort_changed (iter,
+        (GCompareDataFunc) track_objects_start_compare, NULL);
+}
 
-    if (tckobj->priority / LAYER_HEIGHT == layer_prio) {
-      /*  We steal the reference from tck_objects_list */
-      return_list = g_list_append (return_list, tmp->data);
-    } else
-      g_object_unref (tmp->data);
+static void
+track_index_add (GESTimelineLayer * layer, GESTrackObject * track_object)
+{
+  GSequence *track_objects;
+  GSequenceIter *iter;
+  GESTrack *track = ges_track_object_get_track (track_object);
+  GESTimelineLayerPrivate *priv = layer->priv;
+
+  if (track == NULL ||
+      g_hash_table_lookup (priv->track_objects_iters, track_object))
+    return;
+
+  track_objects = g_hash_table_lookup (priv->tracks_objects, track);
+  if (track_objects == NULL) {
+    track_objects = g_sequence_new (NULL);
+    g_hash_table_insert (priv->tracks_objects, track, track_objects);
   }
 
-  return return_list;
+  iter = g_sequence_insert_sorted (track_objects, track_object,
+      (GCompareDataFunc) track_objects_start_compare, NULL);
+  g_hash_table_insert (priv->track_objects_iters, track_object, iter);
+
+  /* Connected first so that the index is sorted when the transitions are
+   * calculated */
+  g_signal_connect (track_object, "notify::start",
+      G_CALLBACK (track_object_position_changed_cb), layer);
+  g_signal_connect (track_object, "notify::priority",
+      G_CALLBACK (track_object_position_changed_cb), layer);
+
+  if (GES_IS_TRACK_SOURCE (track_object)) {
+    g_signal_connect (track_object, "notify::start",
+        G_CALLBACK (track_object_changed_cb), NULL);
+    g_signal_connect (track_object, "notify::duration",
+        G_CALLBACK (track_object_duration_cb), NULL);
+  }
+}
+
+static void
+track_index_remove (GESTimelineLayer * layer, GESTrackObject * track_object)
+{
+  GSequenceIter *iter = g_hash_table_lookup (layer->priv->track_objects_iters,
+      track_object);
+
+  if (iter == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_position_changed_cb, layer);
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_changed_cb, NULL);
+  g_signal_handlers_disconnect_by_func (track_object,
+      track_object_duration_cb, NULL);
+
+  g_sequence_remove (iter);
+  g_hash_table_remove (layer->priv->track_objects_iters, track_object);
+}
+
+static void
+track_index_add_object (GESTimelineLayer * layer, GESTimelineObject * object)
+{
+  GList *tmp, *track_objects = ges_timeline_object_get_track_objects (object);
+
+  for (tmp = track_objects; tmp; tmp = tmp->next)
+    track_index_add (layer, tmp->data);
+
+  g_list_free_full (track_objects, g_object_unref);
+}
+
+static void
+track_index_remove_object (GESTimelineLayer * layer,
+    GESTimelineObject * object)
+{
+  GList *tmp, *track_objects = ges_timeline_object_get_track_objects (object);
+
+  for (tmp = track_objects; tmp; tmp = tmp->next)
+    track_index_remove (layer, tmp->data);
+
+  g_list_free_full (track_objects, g_object_unref);
+}
+
+static void
+track_index_remove_track (GESTimelineLayer * layer, GESTrack * track)
+{
+  GSequenceIter *iter;
+  GSequence *track_objects = g_hash_table_lookup (layer->priv->tracks_objects,
+      track);
+
+  if (track_objects == NULL)
+    return;
+
+  while (!g_sequence_iter_is_end ((iter =
+              g_sequence_get_begin_iter (track_objects))))
+    track_index_remove (layer, g_sequence_get (iter));
+
+  g_hash_table_remove (layer->priv->tracks_objects, track);
+}
+
+static void
+track_index_clear (GESTimelineLayer * layer)
+{
+  GList *tmp, *tracks = g_hash_table_get_keys (layer->priv->tracks_objects);
+
+  for (tmp = tracks; tmp; tmp = tmp->next)
+    track_index_remove_track (layer, tmp->data);
+
+  g_list_free (tracks);
+}
+
+static inline GSequenceIter *
+track_index_lookup (GESTimelineLayer * layer, GESTrackObject * track_object)
+{
+  return g_hash_table_lookup (layer->priv->track_objects_iters, track_object);
+}
+
+static inline GESTrackObject *
+iter_prev_object (GSequenceIter * iter)
+{
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
+
+  return g_sequence_get (g_sequence_iter_prev (iter));
+}
+
+static inline GESTrackObject *
+iter_next_object (GSequenceIter * iter)
+{
+  iter = g_sequence_iter_next (iter);
+
+  return g_sequence_iter_is_end (iter) ? NULL : g_sequence_get (iter);
 }
 
 /* Compare:
- * @compared: The #GList of #GESTrackObjects that we compare with @track_object
+ * @compared: The position in the layer track index of the #GESTrackObjects
+ * that we compare with @track_object
  * @track_object: The #GESTrackObject that serves as a reference
  * @ahead: %TRUE if we are comparing frontward %FALSE if we are comparing
  * backward*/
 static void
-compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
+compare (GSequenceIter * compared, GESTrackObject * track_object,
+    gboolean ahead)
 {
-  GList *tmp;
+  GSequenceIter *tmp;
   gint64 start, duration, compared_start, compared_duration, end, compared_end,
       tr_start, tr_duration;
   GESTimelineStandardTransition *trans = NULL;
   GESTrack *track;
   GESTimelineLayer *layer;
   GESTimelineObject *object, *compared_object, *first_object, *second_object;
+  GESTrackObject *compared_tckobj, *neighbour;
   gint priority;
 
   g_return_if_fail (compared);
@@ -264,38 +458,41 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     return;
   }
 
-  compared_object = ges_track_object_get_timeline_object (compared->data);
+  compared_tckobj = g_sequence_get (compared);
+  compared_object = ges_track_object_get_timeline_object (compared_tckobj);
   layer = ges_timeline_object_get_layer (object);
 
   start = ges_track_object_get_start (track_object);
   duration = ges_track_object_get_duration (track_object);
-  compared_start = ges_track_object_get_start (compared->data);
-  compared_duration = ges_track_object_get_duration (compared->data);
+  compared_start = ges_track_object_get_start (compared_tckobj);
+  compared_duration = ges_track_object_get_duration (compared_tckobj);
   end = start + duration;
   compared_end = compared_start + compared_duration;
 
   if (ahead) {
     /* Make sure we remove the last transition we created it is not needed
      * FIXME make it a smarter way */
-    if (compared->prev && GES_IS_TRACK_TRANSITION (compared->prev->data)) {
+    neighbour = iter_prev_object (compared);
+    if (neighbour && GES_IS_TRACK_TRANSITION (neighbour)) {
       trans = GES_TIMELINE_STANDARD_TRANSITION
-          (ges_track_object_get_timeline_object (compared->prev->data));
-      g_object_get (compared->prev->data, "start", &tr_start, "duration",
-          &tr_duration, NULL);
+          (ges_track_object_get_timeline_object (neighbour));
+      tr_start = ges_track_object_get_start (neighbour);
+      tr_duration = ges_track_object_get_duration (neighbour);
       if (tr_start >= compared_start && tr_start + tr_duration <= compared_end)
         ges_timeline_layer_remove_object (layer, GES_TIMELINE_OBJECT (trans));
       trans = NULL;
     }
 
-    for (tmp = compared->next; tmp; tmp = tmp->next) {
+    for (tmp = g_sequence_iter_next (compared); !g_sequence_iter_is_end (tmp);
+        tmp = g_sequence_iter_next (tmp)) {
       /* If we have a transitionmnmnm we recaluculuculate its values */
-      if (GES_IS_TRACK_TRANSITION (tmp->data)) {
-        g_object_get (tmp->data, "start", &tr_start, "duration", &tr_duration,
-            NULL);
+      if (GES_IS_TRACK_TRANSITION (g_sequence_get (tmp))) {
+        tr_start = ges_track_object_get_start (g_sequence_get (tmp));
+        tr_duration = ges_track_object_get_duration (g_sequence_get (tmp));
 
         if (tr_start + tr_duration == compared_start + compared_duration) {
           GESTimelineObject *tlobj;
-          tlobj = ges_track_object_get_timeline_object (tmp->data);
+          tlobj = ges_track_object_get_timeline_object (g_sequence_get (tmp));
 
           trans = GES_TIMELINE_STANDARD_TRANSITION (tlobj);
           break;
@@ -326,26 +523,27 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     }
 
   } else {
-    if (compared->next && GES_IS_TRACK_TRANSITION (compared->next->data)) {
+    neighbour = iter_next_object (compared);
+    if (neighbour && GES_IS_TRACK_TRANSITION (neighbour)) {
       trans = GES_TIMELINE_STANDARD_TRANSITION
-          (ges_track_object_get_timeline_object (compared->next->data));
-      g_object_get (compared->prev->data, "start", &tr_start, "duration",
-          &tr_duration, NULL);
+          (ges_track_object_get_timeline_object (neighbour));
+      tr_start = ges_track_object_get_start (neighbour);
+      tr_duration = ges_track_object_get_duration (neighbour);
       if (tr_start >= compared_start && tr_start + tr_duration <= compared_end)
         ges_timeline_layer_remove_object (layer, GES_TIMELINE_OBJECT (trans));
       trans = NULL;
     }
-    for (tmp = compared->prev; tmp; tmp = tmp->prev) {
-      if GES_IS_TRACK_TRANSITION
-        (tmp->data) {
-        g_object_get (tmp->data, "start", &tr_start, "duration", &tr_duration,
-            NULL);
+    for (tmp = compared; !g_sequence_iter_is_begin (tmp);) {
+      tmp = g_sequence_iter_prev (tmp);
+
+      if (GES_IS_TRACK_TRANSITION (g_sequence_get (tmp))) {
+        tr_start = ges_track_object_get_start (g_sequence_get (tmp));
         if (tr_start == compared_start) {
           trans = GES_TIMELINE_STANDARD_TRANSITION
-              (ges_track_object_get_timeline_object (tmp->data));
+              (ges_track_object_get_timeline_object (g_sequence_get (tmp)));
           break;
         }
-        }
+      }
     }
 
     if (start + duration <= compared_start) {
@@ -383,10 +581,10 @@ compare (GList * compared, GESTrackObject * track_object, gboolean ahead)
     ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (trans));
 
     if (ahead) {
-      first_object = ges_track_object_get_timeline_object (compared->data);
+      first_object = compared_object;
       second_object = object;
     } else {
-      second_object = ges_track_object_get_timeline_object (compared->data);
+      second_object = compared_object;
       first_object = object;
     }
 
@@ -409,23 +607,15 @@ clean:
 }
 
 static void
-calculate_next_transition_with_list (GESTrackObject * track_object,
-    GList * tckobjs_in_layer, GESTimelineLayer * layer)
+calculate_next_transition_with_iter (GESTrackObject * track_object,
+    GSequenceIter * compared)
 {
-  GList *compared;
-
-  if (!(compared = g_list_find (tckobjs_in_layer, track_object)))
-    return;
-
-  if (compared == NULL)
-    /* This is the last TrackObject of the Track */
-    return;
-
   do {
-    compared = compared->next;
-    if (compared == NULL)
+    compared = g_sequence_iter_next (compared);
+    if (g_sequence_iter_is_end (compared))
+      /* This is the last TrackObject of the Track */
       return;
-  } while (!GES_IS_TRACK_SOURCE (compared->data));
+  } while (!GES_IS_TRACK_SOURCE (g_sequence_get (compared)));
 
   compare (compared, track_object, FALSE);
 }
@@ -435,22 +625,16 @@ static void
 calculate_next_transition (GESTrackObject * track_object,
     GESTimelineLayer * layer)
 {
-  GESTrack *track;
-  GList *tckobjs_in_layer;
-
-  if ((track = ges_track_object_get_track (track_object))) {
-    tckobjs_in_layer = track_get_by_layer (layer, track);
-    calculate_next_transition_with_list (track_object, tckobjs_in_layer, layer);
+  GSequenceIter *iter;
 
-    g_list_foreach (tckobjs_in_layer, (GFunc) g_object_unref, NULL);
-    g_list_free (tckobjs_in_layer);
-  }
+  if ((iter = track_index_lookup (layer, track_object)))
+    calculate_next_transition_with_iter (track_object, iter);
 }
 
 static void
 calculate_transitions (GESTrackObject * track_object)
 {
-  GList *tckobjs_in_layer, *compared;
+  GSequenceIter *iter, *compared;
   GESTimelineLayer *layer;
   GESTimelineObject *tlobj;
 
@@ -460,97 +644,191 @@ calculate_transitions (GESTrackObject * track_object)
     return;
 
   tlobj = ges_track_object_get_timeline_object (track_object);
-  layer = ges_timeline_object_get_layer (tlobj);
-  tckobjs_in_layer = track_get_by_layer (layer, track);
-  if (!(compared = g_list_find (tckobjs_in_layer, track_object)))
+  if ((layer = ges_timeline_object_get_layer (tlobj)) == NULL)
     return;
-  do {
-    compared = compared->prev;
 
-    if (compared == NULL) {
+  if (!(iter = track_index_lookup (layer, track_object)))
+    goto done;
+
+  compared = iter;
+  do {
+    if (g_sequence_iter_is_begin (compared)) {
       /* Nothing before, let's check after */
-      calculate_next_transition_with_list (track_object, tckobjs_in_layer,
-          layer);
+      calculate_next_transition_with_iter (track_object, iter);
       goto done;
-
     }
-  } while (!GES_IS_TRACK_SOURCE (compared->data));
+
+    compared = g_sequence_iter_prev (compared);
+  } while (!GES_IS_TRACK_SOURCE (g_sequence_get (compared)));
 
   compare (compared, track_object, TRUE);
 
-  calculate_next_transition_with_list (track_object, tckobjs_in_layer, layer);
+  calculate_next_transition_with_iter (track_object, iter);
 
 done:
-  g_list_foreach (tckobjs_in_layer, (GFunc) g_object_unref, NULL);
-  g_list_free (tckobjs_in_layer);
+  g_object_unref (layer);
 }
 
-
-static void
-look_for_transition (GESTrackObject * track_object, GESTimelineLayer * layer)
+/* Returns the transitions between the sources around @track_object in the
+ * layer track index */
+static GList *
+get_surrounding_transitions (GESTimelineLayer * layer,
+    GESTrackObject * track_object)
 {
-  GESTrack *track;
-  GList *track_objects, *tmp, *cur;
+  GSequenceIter *cur, *tmp;
+  GESTrackObject *tckobj;
+  GList *transitions = NULL;
 
-  track = ges_track_object_get_track (track_object);
-  track_objects = ges_track_get_objects (track);
+  if (!(cur = track_index_lookup (layer, track_object)))
+    return NULL;
 
-  cur = g_list_find (track_objects, track_object);
+  for (tmp = g_sequence_iter_next (cur); !g_sequence_iter_is_end (tmp);
+      tmp = g_sequence_iter_next (tmp)) {
+    tckobj = g_sequence_get (tmp);
 
-  for (tmp = cur->next; tmp; tmp = tmp->next) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
+    if (GES_IS_TRACK_SOURCE (tckobj))
       break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      ges_timeline_layer_remove_object (layer,
-          ges_track_object_get_timeline_object (tmp->data));
-    }
+    if (GES_IS_TRACK_AUDIO_TRANSITION (tckobj)
+        || GES_IS_TRACK_VIDEO_TRANSITION (tckobj))
+      transitions = g_list_prepend (transitions,
+          g_object_ref (ges_track_object_get_timeline_object (tckobj)));
   }
 
-  for (tmp = cur->prev; tmp; tmp = tmp->prev) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
+  for (tmp = cur; !g_sequence_iter_is_begin (tmp);) {
+    tmp = g_sequence_iter_prev (tmp);
+    tckobj = g_sequence_get (tmp);
+
+    if (GES_IS_TRACK_SOURCE (tckobj))
       break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      ges_timeline_layer_remove_object (layer,
-          ges_track_object_get_timeline_object (tmp->data));
-    }
+    if (GES_IS_TRACK_AUDIO_TRANSITION (tckobj)
+        || GES_IS_TRACK_VIDEO_TRANSITION (tckobj))
+      transitions = g_list_prepend (transitions,
+          g_object_ref (ges_track_object_get_timeline_object (tckobj)));
   }
-  g_list_foreach (track_objects, (GFunc) g_object_unref, NULL);
-  g_list_free (track_objects);
+
+  return transitions;
 }
 
-/**
- * ges_timeline_layer_resync_priorities:
- * @layer: a #GESTimelineLayer
- *
- * Resyncs the priorities of the objects controlled by @layer.
- * This method
- */
+/* Removing a transition can remove the ones next to it, so we make sure they
+ * still are in @layer */
+static void
+remove_transitions (GESTimelineLayer * layer, GList * transitions)
+{
+  GList *tmp;
+  GESTimelineLayer *tlobj_layer;
+
+  for (tmp = transitions; tmp; tmp = tmp->next) {
+    tlobj_layer = ges_timeline_object_get_layer (tmp->data);
+
+    if (tlobj_layer == layer)
+      ges_timeline_layer_remove_object (layer, tmp->data);
+    if (tlobj_layer)
+      g_object_unref (tlobj_layer);
+  }
+
+  g_list_free_full (transitions, g_object_unref);
+}
+
+static void
+look_for_transition (GESTrackObject * track_object, GESTimelineLayer * layer)
+{
+  remove_transitions (layer, get_surrounding_transitions (layer,
+          track_object));
+}
+
+/* Returns %TRUE if the transitions around @track_object will be calculated
+ * when the current timeline edit is commited */
 static gboolean
+defer_transitions (GESTrackObject * track_object)
+{
+  GESTimelineLayer *layer;
+  GESTimelineObject *tlobj;
+  gboolean deferred = FALSE;
+
+  tlobj = ges_track_object_get_timeline_object (track_object);
+  if (tlobj == NULL || (layer = ges_timeline_object_get_layer (tlobj)) == NULL)
+    return FALSE;
+
+  if (layer->timeline && timeline_is_editing (layer->timeline)) {
+    /* The new reference is dropped if the object is already there */
+    g_hash_table_insert (layer->priv->pending_transitions,
+        g_object_ref (track_object), track_object);
+    deferred = TRUE;
+  }
+
+  g_object_unref (layer);
+
+  return deferred;
+}
+
+/* Places the children of the objects controlled by @layer again, if the
+ * layer moved since they were placed. Their priority within the layer does
+ * not change, so the objects are not notified. */
+static void
 ges_timeline_layer_resync_priorities (GESTimelineLayer * layer)
 {
-  GList *tmp;
-  GESTimelineObject *obj;
+  GSequenceIter *iter;
+
+  if (layer->priv->placed_min_gnl_priority == layer->min_gnl_priority)
+    return;
 
   GST_DEBUG ("Resync priorities of %p", layer);
 
-  /* TODO : Inhibit composition updates while doing this.
-   * Ideally we want to do it from an even higher level, but here will
-   * do in the meantime. */
+  layer->priv->placed_min_gnl_priority = layer->min_gnl_priority;
+
+  for (iter = g_sequence_get_begin_iter (layer->priv->objects_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    timeline_object_update_layer_priority (g_sequence_get (iter));
+}
+
+void
+timeline_layer_commit_edit (GESTimelineLayer * layer)
+{
+  GList *tmp, *track_objects;
+  GESTimelineObject *tlobj;
+  GESTimelineLayer *tlobj_layer;
+
+  /* Objects need to be in place before we look at their transitions */
+  ges_timeline_layer_resync_priorities (layer);
+  if (GES_IS_SIMPLE_TIMELINE_LAYER (layer))
+    simple_timeline_layer_commit_edit ((GESSimpleTimelineLayer *) layer);
+
+  track_objects = g_hash_table_get_keys (layer->priv->pending_transitions);
+  g_list_foreach (track_objects, (GFunc) g_object_ref, NULL);
+  g_hash_table_remove_all (layer->priv->pending_transitions);
+
+  for (tmp = track_objects; tmp; tmp = tmp->next) {
+    tlobj = ges_track_object_get_timeline_object (tmp->data);
+
+    /* The object might have been removed in the meantime */
+    if (tlobj == NULL || ges_track_object_get_track (tmp->data) == NULL)
+      continue;
 
-  for (tmp = layer->priv->objects_start; tmp; tmp = tmp->next) {
-    obj = GES_TIMELINE_OBJECT (tmp->data);
-    ges_timeline_object_set_priority (obj, GES_TIMELINE_OBJECT_PRIORITY (obj));
+    tlobj_layer = ges_timeline_object_get_layer (tlobj);
+    if (tlobj_layer == NULL)
+      continue;
+
+    calculate_transitions (tmp->data);
+    g_object_unref (tlobj_layer);
   }
 
-  return TRUE;
+  g_list_free_full (track_objects, g_object_unref);
 }
 
 /* Callbacks */
 
+static void
+timeline_object_position_changed_cb (GESTimelineObject * object,
+    GParamSpec * arg G_GNUC_UNUSED, GESTimelineLayer * layer)
+{
+  GSequenceIter *iter = g_hash_table_lookup (layer->priv->objects_iters,
+      object);
+
+  if (iter)
+    g_sequence_sort_changed (iter,
+        (GCompareDataFunc) objects_start_compare, NULL);
+}
+
 static void
 track_object_duration_cb (GESTrackObject * track_object,
     GParamSpec * arg G_GNUC_UNUSED)
@@ -558,65 +836,44 @@ track_object_duration_cb (GESTrackObject * track_object,
   GESTimelineLayer *layer;
   GESTimelineObject *tlobj;
 
+  if (defer_transitions (track_object))
+    return;
+
   tlobj = ges_track_object_get_timeline_object (track_object);
-  layer = ges_timeline_object_get_layer (tlobj);
+  if ((layer = ges_timeline_object_get_layer (tlobj)) == NULL)
+    return;
+
   if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
     calculate_next_transition (track_object, layer);
+
+  g_object_unref (layer);
 }
 
 static void
-track_object_removed_cb (GESTrack * track, GESTrackObject * track_object)
+track_object_removed_cb (GESTrack * track, GESTrackObject * track_object,
+    GESTimelineLayer * layer)
 {
-  GList *track_objects, *tmp, *cur;
-  GESTimelineLayer *layer;
+  GList *transitions;
 
-  track_objects = ges_track_get_objects (track);
-  cur = g_list_find (track_objects, track_object);
-  for (tmp = cur->next; tmp; tmp = tmp->next) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
-      break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      layer =
-          ges_timeline_object_get_layer (ges_track_object_get_timeline_object
-          (tmp->data));
-      if (ges_timeline_layer_get_auto_transition (layer)) {
-        ges_track_enable_update (track, FALSE);
-        ges_timeline_layer_remove_object (layer,
-            ges_track_object_get_timeline_object (tmp->data));
-        ges_track_enable_update (track, TRUE);
-      }
-      g_object_unref (layer);
-    }
-  }
+  if (track_index_lookup (layer, track_object) == NULL)
+    return;
 
-  for (tmp = cur->prev; tmp; tmp = tmp->prev) {
-    if (GES_IS_TRACK_SOURCE (tmp->data)) {
-      break;
-    }
-    if (GES_IS_TRACK_AUDIO_TRANSITION (tmp->data)
-        || GES_IS_TRACK_VIDEO_TRANSITION (tmp->data)) {
-      layer =
-          ges_timeline_object_get_layer (ges_track_object_get_timeline_object
-          (tmp->data));
-      if (ges_timeline_layer_get_auto_transition (layer)) {
-        ges_track_enable_update (track, FALSE);
-        ges_timeline_layer_remove_object (layer,
-            ges_track_object_get_timeline_object (tmp->data));
-        ges_track_enable_update (track, TRUE);
-      }
-      g_object_unref (layer);
-    }
+  transitions = get_surrounding_transitions (layer, track_object);
+  track_index_remove (layer, track_object);
+
+  if (transitions) {
+    ges_track_enable_update (track, FALSE);
+    remove_transitions (layer, transitions);
+    ges_track_enable_update (track, TRUE);
   }
-  g_object_unref (track_object);
 }
 
 static void
 track_object_changed_cb (GESTrackObject * track_object,
     GParamSpec * arg G_GNUC_UNUSED)
 {
-  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)))
+  if (G_LIKELY (GES_IS_TRACK_SOURCE (track_object)) &&
+      !defer_transitions (track_object))
     calculate_transitions (track_object);
 }
 
@@ -624,32 +881,54 @@ static void
 track_object_added_cb (GESTrack * track, GESTrackObject * track_object,
     GESTimelineLayer * layer)
 {
-  if (GES_IS_TRACK_SOURCE (track_object)) {
-    g_signal_connect (G_OBJECT (track_object), "notify::start",
-        G_CALLBACK (track_object_changed_cb), NULL);
-    g_signal_connect (G_OBJECT (track_object), "notify::duration",
-        G_CALLBACK (track_object_duration_cb), NULL);
+  GESTimelineObject *tlobj;
+  GESTimelineLayer *tlobj_layer;
+
+  /* Only look at the objects of this layer */
+  tlobj = ges_track_object_get_timeline_object (track_object);
+  if (tlobj == NULL || (tlobj_layer = ges_timeline_object_get_layer (tlobj))
+      == NULL)
+    return;
+
+  g_object_unref (tlobj_layer);
+  if (tlobj_layer != layer)
+    return;
+
+  track_index_add (layer, track_object);
+
+  if (GES_IS_TRACK_SOURCE (track_object) && !defer_transitions (track_object))
     calculate_transitions (track_object);
-  }
+}
 
+static void
+connect_track (GESTimelineLayer * layer, GESTrack * track)
+{
+  g_signal_connect (track, "track-object-added",
+      G_CALLBACK (track_object_added_cb), layer);
+  g_signal_connect (track, "track-object-removed",
+      G_CALLBACK (track_object_removed_cb), layer);
 }
 
 static void
-track_removed_cb (GESTrack * track, GESTrackObject * track_object,
-    GESTimelineLayer * layer)
+disconnect_track (GESTimelineLayer * layer, GESTrack * track)
 {
   g_signal_handlers_disconnect_by_func (track, track_object_added_cb, layer);
-  g_signal_handlers_disconnect_by_func (track, track_object_removed_cb, NULL);
+  g_signal_handlers_disconnect_by_func (track, track_object_removed_cb, layer);
+  track_index_remove_track (layer, track);
 }
 
 static void
-track_added_cb (GESTrack * track, GESTrackObject * track_object,
+track_removed_cb (GESTimeline * timeline, GESTrack * track,
     GESTimelineLayer * layer)
 {
-  g_signal_connect (track, "track-object-removed",
-      (GCallback) track_object_removed_cb, NULL);
-  g_signal_connect (track, "track-object-added",
-      (GCallback) track_object_added_cb, NULL);
+  disconnect_track (layer, track);
+}
+
+static void
+track_added_cb (GESTimeline * timeline, GESTrack * track,
+    GESTimelineLayer * layer)
+{
+  connect_track (layer, track);
 }
 
 static void
@@ -664,6 +943,7 @@ timeline_object_height_changed_cb (GESTimelineObject * obj,
 static void
 start_calculating_transitions (GESTimelineLayer * layer)
 {
+  GSequenceIter *iter;
   GList *tmp, *tracks = ges_timeline_get_tracks (layer->timeline);
 
   g_signal_connect (layer->timeline, "track-added", G_CALLBACK (track_added_cb),
@@ -671,18 +951,109 @@ start_calculating_transitions (GESTimelineLayer * layer)
   g_signal_connect (layer->timeline, "track-removed",
       G_CALLBACK (track_removed_cb), layer);
 
-  for (tmp = tracks; tmp; tmp = tmp->next) {
-    g_signal_connect (G_OBJECT (tmp->data), "track-object-added",
-        G_CALLBACK (track_object_added_cb), layer);
-    g_signal_connect (G_OBJECT (tmp->data), "track-object-removed",
-        G_CALLBACK (track_object_removed_cb), NULL);
-  }
+  for (tmp = tracks; tmp; tmp = tmp->next)
+    connect_track (layer, tmp->data);
 
   g_list_free_full (tracks, g_object_unref);
 
+  /* Index the TrackObject-s already there */
+  for (iter = g_sequence_get_begin_iter (layer->priv->objects_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    track_index_add_object (layer, g_sequence_get (iter));
+
   /* FIXME calculate all the transitions at that time */
 }
 
+static void
+stop_calculating_transitions (GESTimelineLayer * layer)
+{
+  GList *tmp, *tracks = ges_timeline_get_tracks (layer->timeline);
+
+  g_signal_handlers_disconnect_by_func (layer->timeline, track_added_cb,
+      layer);
+  g_signal_handlers_disconnect_by_func (layer->timeline, track_removed_cb,
+      layer);
+
+  for (tmp = tracks; tmp; tmp = tmp->next)
+    disconnect_track (layer, tmp->data);
+
+  g_list_free_full (tracks, g_object_unref);
+
+  track_index_clear (layer);
+}
+
+static gint
+ptr_start_compare (GESTimelineObject ** a, GESTimelineObject ** b,
+    gpointer user_data)
+{
+  return objects_start_compare (*a, *b, user_data);
+}
+
+/* Adds @object to @layer without emitting 'object-added' */
+static gboolean
+add_object_internal (GESTimelineLayer * layer, GESTimelineObject * object)
+{
+  GESTimelineLayer *tl_obj_layer;
+  GSequenceIter *iter, *end;
+  guint32 maxprio, minprio, prio;
+  GESTimelineLayerPrivate *priv = layer->priv;
+
+  tl_obj_layer = ges_timeline_object_get_layer (object);
+
+  if (G_UNLIKELY (tl_obj_layer)) {
+    GST_WARNING ("TimelineObject %p already belongs to another layer", object);
+    g_object_unref (tl_obj_layer);
+    return FALSE;
+  }
+
+  g_object_ref_sink (object);
+
+  /* Take a reference to the object and store it stored by start/priority,
+   * objects are often added in order so check the end first */
+  end = g_sequence_get_end_iter (priv->objects_start);
+  if (g_sequence_iter_is_begin (end) ||
+      objects_start_compare (g_sequence_get (g_sequence_iter_prev (end)),
+          object, NULL) <= 0)
+    iter = g_sequence_append (priv->objects_start, object);
+  else
+    iter = g_sequence_insert_sorted (priv->objects_start, object,
+        (GCompareDataFunc) objects_start_compare, NULL);
+  g_hash_table_insert (priv->objects_iters, object, iter);
+
+  g_signal_connect (object, "notify::start",
+      G_CALLBACK (timeline_object_position_changed_cb), layer);
+  g_signal_connect (object, "notify::priority",
+      G_CALLBACK (timeline_object_position_changed_cb), layer);
+
+  /* Inform the object it's now in this layer */
+  ges_timeline_object_set_layer (object, layer);
+
+  /* It might already have TrackObjects, if moved from another layer */
+  if (priv->auto_transition && layer->timeline)
+    track_index_add_object (layer, object);
+
+  GST_DEBUG ("current object priority : %d, layer min/max : %d/%d",
+      GES_TIMELINE_OBJECT_PRIORITY (object),
+      layer->min_gnl_priority, layer->max_gnl_priority);
+
+  /* Set the priority. */
+  maxprio = layer->max_gnl_priority;
+  minprio = layer->min_gnl_priority;
+  prio = GES_TIMELINE_OBJECT_PRIORITY (object);
+  if (minprio + prio > (maxprio)) {
+    GST_WARNING ("%p is out of the layer %p space, setting its priority to "
+        "setting its priority %d to failthe maximum priority of the layer %d",
+        object, layer, prio, maxprio - minprio);
+    ges_timeline_object_set_priority (object, LAYER_HEIGHT - 1);
+  } else {
+    /* If the object has an acceptable priority, we just let it with its
+     * current priority, the other objects of the layer are not affected */
+    ges_timeline_object_set_priority (object, prio);
+  }
+
+  return TRUE;
+}
+
 /* Public methods */
 /**
  * ges_timeline_layer_remove_object:
@@ -736,10 +1107,13 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
 
   /* inform the object it's no longer in a layer */
   ges_timeline_object_set_layer (object, NULL);
+  track_index_remove_object (layer, object);
 
   /* Remove it from our list of controlled objects */
-  layer->priv->objects_start =
-      g_list_remove (layer->priv->objects_start, object);
+  g_signal_handlers_disconnect_by_func (object,
+      timeline_object_position_changed_cb, layer);
+  g_sequence_remove (g_hash_table_lookup (layer->priv->objects_iters, object));
+  g_hash_table_remove (layer->priv->objects_iters, object);
 
   /* Remove our reference to the object */
   g_object_unref (object);
@@ -754,6 +1128,9 @@ ges_timeline_layer_remove_object (GESTimelineLayer * layer,
  *
  * Sets the layer to the given @priority. See the documentation of the
  * priority property for more information.
+ *
+ * If the timeline of @layer is being edited, its objects are only moved
+ * once the edit is commited, see ges_timeline_begin_edit().
  */
 void
 ges_timeline_layer_set_priority (GESTimelineLayer * layer, guint priority)
@@ -767,7 +1144,13 @@ ges_timeline_layer_set_priority (GESTimelineLayer * layer, guint priority)
     layer->min_gnl_priority = (priority * LAYER_HEIGHT);
     layer->max_gnl_priority = ((priority + 1) * LAYER_HEIGHT) - 1;
 
-    ges_timeline_layer_resync_priorities (layer);
+    /* Layers are often reordered together, the objects are placed once the
+     * edit is commited, with the composition updates held back meanwhile */
+    if (layer->timeline) {
+      ges_timeline_begin_edit (layer->timeline);
+      ges_timeline_commit_edit (layer->timeline);
+    } else
+      ges_timeline_layer_resync_priorities (layer);
   }
 }
 
@@ -803,8 +1186,15 @@ ges_timeline_layer_set_auto_transition (GESTimelineLayer * layer,
 
   g_return_if_fail (GES_IS_TIMELINE_LAYER (layer));
 
-  if (auto_transition && layer->timeline)
-    start_calculating_transitions (layer);
+  if (auto_transition == layer->priv->auto_transition)
+    return;
+
+  if (layer->timeline) {
+    if (auto_transition)
+      start_calculating_transitions (layer);
+    else
+      stop_calculating_transitions (layer);
+  }
 
   layer->priv->auto_transition = auto_transition;
 }
@@ -840,7 +1230,7 @@ GList *
 ges_timeline_layer_get_objects (GESTimelineLayer * layer)
 {
   GList *ret = NULL;
-  GList *tmp;
+  GSequenceIter *iter;
   GESTimelineLayerClass *klass;
 
   g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), NULL);
@@ -851,10 +1241,9 @@ ges_timeline_layer_get_objects (GESTimelineLayer * layer)
     return klass->get_objects (layer);
   }
 
-  for (tmp = layer->priv->objects_start; tmp; tmp = tmp->next) {
-    ret = g_list_prepend (ret, tmp->data);
-    g_object_ref (tmp->data);
-  }
+  for (iter = g_sequence_get_begin_iter (layer->priv->objects_start);
+      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter))
+    ret = g_list_prepend (ret, g_object_ref (g_sequence_get (iter)));
 
   ret = g_list_reverse (ret);
   return ret;
@@ -875,7 +1264,8 @@ ges_timeline_layer_is_empty (GESTimelineLayer * layer)
 {
   g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
 
-  return (layer->priv->objects_start == NULL);
+  return g_sequence_iter_is_end (g_sequence_get_begin_iter (layer->
+          priv->objects_start));
 }
 
 /**
@@ -900,52 +1290,76 @@ gboolean
 ges_timeline_layer_add_object (GESTimelineLayer * layer,
     GESTimelineObject * object)
 {
-  GESTimelineLayer *tl_obj_layer;
-  guint32 maxprio, minprio, prio;
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
+  g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), FALSE);
 
   GST_DEBUG ("layer:%p, object:%p", layer, object);
 
-  tl_obj_layer = ges_timeline_object_get_layer (object);
-
-  if (G_UNLIKELY (tl_obj_layer)) {
-    GST_WARNING ("TimelineObject %p already belongs to another layer", object);
-    g_object_unref (tl_obj_layer);
+  if (!add_object_internal (layer, object))
     return FALSE;
-  }
 
-  g_object_ref_sink (object);
+  /* emit 'object-added' */
+  g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0, object);
 
-  /* Take a reference to the object and store it stored by start/priority */
-  layer->priv->objects_start =
-      g_list_insert_sorted (layer->priv->objects_start, object,
-      (GCompareFunc) objects_start_compare);
+  return TRUE;
+}
 
-  /* Inform the object it's now in this layer */
-  ges_timeline_object_set_layer (object, layer);
+/**
+ * ges_timeline_layer_add_objects:
+ * @layer: a #GESTimelineLayer
+ * @objects: (array length=n_objects) (transfer full): the #GESTimelineObject-s
+ * to add.
+ * @n_objects: the number of objects in @objects
+ *
+ * Adds all the given objects to the layer at once. This behaves like calling
+ * ges_timeline_layer_add_object() on each of them but is much faster when
+ * adding a lot of objects, the #GESTimelineLayer::object-added signals are
+ * emitted once all the objects have been added, sorted by start.
+ *
+ * Objects that already belong to a layer are not added.
+ *
+ * Returns: TRUE if all the objects were properly added to the layer, or FALSE
+ * if the @layer refused to add some of them.
+ */
+gboolean
+ges_timeline_layer_add_objects (GESTimelineLayer * layer,
+    GESTimelineObject ** objects, guint n_objects)
+{
+  guint i;
+  GPtrArray *added;
+  gboolean ret = TRUE;
 
-  GST_DEBUG ("current object priority : %d, layer min/max : %d/%d",
-      GES_TIMELINE_OBJECT_PRIORITY (object),
-      layer->min_gnl_priority, layer->max_gnl_priority);
+  g_return_val_if_fail (GES_IS_TIMELINE_LAYER (layer), FALSE);
+  g_return_val_if_fail (objects != NULL || n_objects == 0, FALSE);
 
-  /* Set the priority. */
-  maxprio = layer->max_gnl_priority;
-  minprio = layer->min_gnl_priority;
-  prio = GES_TIMELINE_OBJECT_PRIORITY (object);
-  if (minprio + prio > (maxprio)) {
-    GST_WARNING ("%p is out of the layer %p space, setting its priority to "
-        "setting its priority %d to failthe maximum priority of the layer %d",
-        object, layer, prio, maxprio - minprio);
-    ges_timeline_object_set_priority (object, LAYER_HEIGHT - 1);
-  }
-  /* If the object has an acceptable priority, we just let it with its current
-   * priority */
+  GST_DEBUG ("layer:%p, adding %u objects", layer, n_objects);
 
-  ges_timeline_layer_resync_priorities (layer);
+  /* Sort them once so that inserting them in order is cheap */
+  added = g_ptr_array_sized_new (n_objects);
+  for (i = 0; i < n_objects; i++)
+    g_ptr_array_add (added, objects[i]);
+  g_ptr_array_sort_with_data (added, (GCompareDataFunc) ptr_start_compare,
+      NULL);
+
+  for (i = 0; i < added->len;) {
+    GESTimelineObject *object = g_ptr_array_index (added, i);
+
+    if (!GES_IS_TIMELINE_OBJECT (object) ||
+        !add_object_internal (layer, object)) {
+      g_ptr_array_remove_index (added, i);
+      ret = FALSE;
+    } else
+      i++;
+  }
 
   /* emit 'object-added' */
-  g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0, object);
+  for (i = 0; i < added->len; i++)
+    g_signal_emit (layer, ges_timeline_layer_signals[OBJECT_ADDED], 0,
+        g_ptr_array_index (added, i));
 
-  return TRUE;
+  g_ptr_array_free (added, TRUE);
+
+  return ret;
 }
 
 /**
@@ -984,13 +1398,12 @@ ges_timeline_layer_set_timeline (GESTimelineLayer * layer,
 {
   GST_DEBUG ("layer:%p, timeline:%p", layer, timeline);
 
+  /* In case it moved during an edit of the previous timeline */
+  ges_timeline_layer_resync_priorities (layer);
+
   if (layer->priv->auto_transition == TRUE) {
-    if (layer->timeline != NULL) {
-      g_signal_handlers_disconnect_by_func (layer->timeline, track_added_cb,
-          layer);
-      g_signal_handlers_disconnect_by_func (layer->timeline, track_removed_cb,
-          layer);
-    }
+    if (layer->timeline != NULL)
+      stop_calculating_transitions (layer);
 
     layer->timeline = timeline;
     if (timeline != NULL)
@@ -102,6 +102,9 @@ ges_timeline_layer_get_timeline           (GESTimelineLayer * layer);
 gboolean ges_timeline_layer_add_object    (GESTimelineLayer * layer,
 
 					   GESTimelineObject * object);
+gboolean ges_timeline_layer_add_objects   (GESTimelineLayer * layer,
+					   GESTimelineObject ** objects,
+					   guint n_objects);
 gboolean ges_timeline_layer_remove_object (GESTimelineLayer * layer,
 					   GESTimelineObject * object);
 
@@ -102,6 +102,15 @@ typedef struct
   /* track mapping ?? */
 } ObjectMapping;
 
+/* The ObjectMapping of a TrackObject is attached to it with this quark */
+static GQuark object_mapping_quark;
+
+static inline ObjectMapping *
+find_object_mapping (GESTimelineObject * object, GESTrackObject * child)
+{
+  return g_object_get_qdata (G_OBJECT (child), object_mapping_quark);
+}
+
 enum
 {
   EFFECT_ADDED,
@@ -131,8 +140,6 @@ struct _GESTimelineObjectPrivate
 
   guint64 maxduration;
 
-  GList *mappings;
-
   guint nb_effects;
 
   GESTrackObject *initiated_move;
@@ -234,6 +241,8 @@ ges_timeline_object_class_init (GESTimelineObjectClass * klass)
 
   g_type_class_add_private (klass, sizeof (GESTimelineObjectPrivate));
 
+  object_mapping_quark = g_quark_from_static_string ("ges-object-mapping");
+
   object_class->get_property = ges_timeline_object_get_property;
   object_class->set_property = ges_timeline_object_set_property;
   klass->create_track_objects = ges_timeline_object_create_track_objects_func;
@@ -509,6 +518,25 @@ ges_timeline_object_create_track_objects_func (GESTimelineObject * object,
   return ges_track_add_object (track, result);
 }
 
+/* Listen to all property changes of @trobj */
+static void
+connect_track_object (GESTimelineObject * object, GESTrackObject * trobj,
+    ObjectMapping * mapping)
+{
+  mapping->start_notifyid =
+      g_signal_connect (G_OBJECT (trobj), "notify::start",
+      G_CALLBACK (track_object_start_changed_cb), object);
+  mapping->duration_notifyid =
+      g_signal_connect (G_OBJECT (trobj), "notify::duration",
+      G_CALLBACK (track_object_duration_changed_cb), object);
+  mapping->inpoint_notifyid =
+      g_signal_connect (G_OBJECT (trobj), "notify::in-point",
+      G_CALLBACK (track_object_inpoint_changed_cb), object);
+  mapping->priority_notifyid =
+      g_signal_connect (G_OBJECT (trobj), "notify::priority",
+      G_CALLBACK (track_object_priority_changed_cb), object);
+}
+
 /**
  * ges_timeline_object_add_track_object:
  * @object: a #GESTimelineObject
@@ -548,7 +576,7 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
 
   mapping = g_slice_new0 (ObjectMapping);
   mapping->object = trobj;
-  priv->mappings = g_list_append (priv->mappings, mapping);
+  g_object_set_qdata (G_OBJECT (trobj), object_mapping_quark, mapping);
 
   GST_DEBUG ("Adding TrackObject to the list of controlled track objects");
   /* We steal the initial reference */
@@ -568,16 +596,18 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
     GST_DEBUG
         ("Moving non on top effect under other TrackObject-s, nb effects %i",
         priv->nb_effects);
+    /* We update the offsets ourself, which also makes sure not to move
+     * the entire #TimelineObject */
+    priv->ignore_notifies = TRUE;
     for (tmp = g_list_nth (priv->trackobjects, priv->nb_effects); tmp;
         tmp = tmp->next) {
       GESTrackObject *tmpo = GES_TRACK_OBJECT (tmp->data);
 
-      /* We make sure not to move the entire #TimelineObject */
-      ges_track_object_set_locked (tmpo, FALSE);
+      find_object_mapping (object, tmpo)->priority_offset++;
       ges_track_object_set_priority (tmpo,
           ges_track_object_get_priority (tmpo) + 1);
-      ges_track_object_set_locked (tmpo, TRUE);
     }
+    priv->ignore_notifies = FALSE;
 
     priv->nb_effects++;
   }
@@ -599,19 +629,7 @@ ges_timeline_object_add_track_object (GESTimelineObject * object, GESTrackObject
         G_OBJECT_CLASS_NAME (klass));
   }
 
-  /* Listen to all property changes */
-  mapping->start_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::start",
-      G_CALLBACK (track_object_start_changed_cb), object);
-  mapping->duration_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::duration",
-      G_CALLBACK (track_object_duration_changed_cb), object);
-  mapping->inpoint_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::in-point",
-      G_CALLBACK (track_object_inpoint_changed_cb), object);
-  mapping->priority_notifyid =
-      g_signal_connect (G_OBJECT (trobj), "notify::priority",
-      G_CALLBACK (track_object_priority_changed_cb), object);
+  connect_track_object (object, trobj, mapping);
 
   get_layer_priorities (priv->layer, &min_prio, &max_prio);
   ges_track_object_set_priority (trobj, min_prio + object->priority
@@ -643,8 +661,7 @@ gboolean
 ges_timeline_object_release_track_object (GESTimelineObject * object,
     GESTrackObject * trackobject)
 {
-  GList *tmp;
-  ObjectMapping *mapping = NULL;
+  ObjectMapping *mapping;
   GESTimelineObjectClass *klass;
 
   g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), FALSE);
@@ -658,13 +675,8 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
     return FALSE;
   }
 
-  for (tmp = object->priv->mappings; tmp; tmp = tmp->next) {
-    mapping = (ObjectMapping *) tmp->data;
-    if (mapping->object == trackobject)
-      break;
-  }
-
-  if (tmp && mapping) {
+  mapping = find_object_mapping (object, trackobject);
+  if (mapping) {
 
     /* Disconnect all notify listeners */
     g_signal_handler_disconnect (trackobject, mapping->start_notifyid);
@@ -672,9 +684,8 @@ ges_timeline_object_release_track_object (GESTimelineObject * object,
     g_signal_handler_disconnect (trackobject, mapping->inpoint_notifyid);
     g_signal_handler_disconnect (trackobject, mapping->priority_notifyid);
 
+    g_object_set_qdata (G_OBJECT (trackobject), object_mapping_quark, NULL);
     g_slice_free (ObjectMapping, mapping);
-
-    object->priv->mappings = g_list_delete_link (object->priv->mappings, tmp);
   }
 
   object->priv->trackobjects =
@@ -749,20 +760,6 @@ ges_timeline_object_fill_track_object_func (GESTimelineObject * object,
   return FALSE;
 }
 
-static ObjectMapping *
-find_object_mapping (GESTimelineObject * object, GESTrackObject * child)
-{
-  GList *tmp;
-
-  for (tmp = object->priv->mappings; tmp; tmp = tmp->next) {
-    ObjectMapping *map = (ObjectMapping *) tmp->data;
-    if (map->object == child)
-      return map;
-  }
-
-  return NULL;
-}
-
 static gboolean
 ges_timeline_object_set_start_internal (GESTimelineObject * object,
     guint64 start)
@@ -943,6 +940,7 @@ ges_timeline_object_set_priority_internal (GESTimelineObject * object,
   ObjectMapping *map;
   GESTimelineObjectPrivate *priv;
   guint32 layer_min_gnl_prio, layer_max_gnl_prio;
+  gboolean offsets_changed = FALSE;
 
   g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), FALSE);
 
@@ -976,11 +974,14 @@ ges_timeline_object_set_priority_internal (GESTimelineObject * object,
     } else {
       /* ... or update the offset */
       map->priority_offset = tr->priority - layer_min_gnl_prio + priority;
+      offsets_changed = TRUE;
     }
   }
 
-  priv->trackobjects = g_list_sort_with_data (priv->trackobjects,
-      (GCompareDataFunc) sort_track_effects, object);
+  /* The order only changes with the offsets */
+  if (offsets_changed)
+    priv->trackobjects = g_list_sort_with_data (priv->trackobjects,
+        (GCompareDataFunc) sort_track_effects, object);
   priv->ignore_notifies = FALSE;
 
   object->priority = priority;
@@ -1074,6 +1075,14 @@ ges_timeline_object_move_to_layer (GESTimelineObject * object, GESTimelineLayer
   return ret;
 }
 
+/* Places the children of @object again after its layer moved, its priority
+ * within the layer stays the same */
+void
+timeline_object_update_layer_priority (GESTimelineObject * object)
+{
+  ges_timeline_object_set_priority_internal (object, object->priority);
+}
+
 /**
  * ges_timeline_object_set_priority:
  * @object: a #GESTimelineObject
@@ -1330,6 +1339,155 @@ ges_timeline_object_set_top_effect_priority (GESTimelineObject * object,
   return TRUE;
 }
 
+/**
+ * ges_timeline_object_set_effect_stack:
+ * @object: a #GESTimelineObject
+ * @effects: (element-type GESTrackEffect): The #GESTrackEffect-s to apply on
+ * @object, from the top one to the bottom one
+ *
+ * Sets all the top effects of @object at once.
+ *
+ * The effects of @effects already controlled by @object are only moved to
+ * their new position. The other ones are added to @object, and then have to
+ * be added to a #GESTrack as with ges_timeline_object_add_track_object().
+ * The top effects of @object which are not in @effects are removed from
+ * their track and released.
+ *
+ * The priorities of the #GESTrackObject-s of @object are only updated once,
+ * which makes this a lot faster than adding and moving effects one by one.
+ *
+ * Returns: %TRUE if the effects could be set, %FALSE otherwise.
+ */
+gboolean
+ges_timeline_object_set_effect_stack (GESTimelineObject * object,
+    GList * effects)
+{
+  GList *tmp, *removed = NULL, *added = NULL, *others = NULL;
+  GHashTable *stack;
+  guint i, nb_effects, old_nb_effects;
+  guint32 min_prio, max_prio;
+  GESTimelineObjectPrivate *priv;
+  GESTimelineObjectClass *klass;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), FALSE);
+
+  priv = object->priv;
+  klass = GES_TIMELINE_OBJECT_GET_CLASS (object);
+
+  /* Check the whole stack before touching anything */
+  stack = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (tmp = effects; tmp; tmp = tmp->next) {
+    GESTimelineObject *parent;
+
+    if (!GES_IS_TRACK_EFFECT (tmp->data) ||
+        g_hash_table_lookup (stack, tmp->data)) {
+      GST_WARNING_OBJECT (object, "Invalid effect stack");
+      g_hash_table_unref (stack);
+      return FALSE;
+    }
+
+    parent = ges_track_object_get_timeline_object (tmp->data);
+    if (parent != NULL && parent != object) {
+      GST_WARNING_OBJECT (object, "%p is controlled by another object",
+          tmp->data);
+      g_hash_table_unref (stack);
+      return FALSE;
+    }
+
+    g_hash_table_insert (stack, tmp->data, tmp->data);
+  }
+
+  /* Release the effects which are not part of the stack anymore */
+  for (tmp = priv->trackobjects, i = 0; i < priv->nb_effects;
+      tmp = tmp->next, i++) {
+    if (!g_hash_table_lookup (stack, tmp->data))
+      removed = g_list_prepend (removed, g_object_ref (tmp->data));
+  }
+  g_hash_table_unref (stack);
+
+  old_nb_effects = priv->nb_effects;
+  for (tmp = removed; tmp; tmp = tmp->next) {
+    GESTrackObject *effect = GES_TRACK_OBJECT (tmp->data);
+    GESTrack *track = ges_track_object_get_track (effect);
+
+    if (track)
+      ges_track_remove_object (track, effect);
+    ges_timeline_object_release_track_object (object, effect);
+  }
+  g_list_free_full (removed, g_object_unref);
+
+  /* Take the new effects under our control */
+  for (tmp = effects; tmp; tmp = tmp->next) {
+    GESTrackObject *effect = GES_TRACK_OBJECT (tmp->data);
+    ObjectMapping *mapping;
+
+    if (ges_track_object_get_timeline_object (effect) == object)
+      continue;
+
+    ges_track_object_set_timeline_object (effect, object);
+    g_object_ref (effect);
+
+    mapping = g_slice_new0 (ObjectMapping);
+    mapping->object = effect;
+    g_object_set_qdata (G_OBJECT (effect), object_mapping_quark, mapping);
+
+    added = g_list_prepend (added, effect);
+  }
+  added = g_list_reverse (added);
+
+  /* The other children keep their order, under the effects */
+  for (tmp = g_list_nth (priv->trackobjects, priv->nb_effects); tmp;
+      tmp = tmp->next)
+    others = g_list_prepend (others, tmp->data);
+  g_list_free (priv->trackobjects);
+  priv->trackobjects = g_list_concat (g_list_copy (effects),
+      g_list_reverse (others));
+
+  nb_effects = g_list_length (effects);
+  priv->nb_effects = nb_effects;
+
+  /* Set all the priorities in one pass */
+  get_layer_priorities (priv->layer, &min_prio, &max_prio);
+  priv->ignore_notifies = TRUE;
+  for (tmp = priv->trackobjects, i = 0; tmp; tmp = tmp->next, i++) {
+    GESTrackObject *child = GES_TRACK_OBJECT (tmp->data);
+    ObjectMapping *map = find_object_mapping (object, child);
+
+    if (i < nb_effects)
+      map->priority_offset = i;
+    else
+      map->priority_offset += (gint32) nb_effects - (gint32) old_nb_effects;
+
+    ges_track_object_set_priority (child,
+        MIN (min_prio + object->priority + map->priority_offset, max_prio));
+  }
+
+  for (tmp = added; tmp; tmp = tmp->next) {
+    GESTrackObject *effect = GES_TRACK_OBJECT (tmp->data);
+
+    ges_track_object_set_start (effect, object->start);
+    ges_track_object_set_duration (effect, object->duration);
+    ges_track_object_set_inpoint (effect, object->inpoint);
+    ges_track_object_set_max_duration (effect, priv->maxduration);
+
+    if (klass->track_object_added)
+      klass->track_object_added (object, effect);
+
+    connect_track_object (object, effect, find_object_mapping (object,
+            effect));
+  }
+  priv->ignore_notifies = FALSE;
+
+  update_height (object);
+
+  for (tmp = added; tmp; tmp = tmp->next)
+    g_signal_emit (object, ges_timeline_object_signals[EFFECT_ADDED], 0,
+        GES_TRACK_EFFECT (tmp->data));
+  g_list_free (added);
+
+  return TRUE;
+}
+
 /**
  * ges_timeline_object_edit:
  * @object: the #GESTimelineObject to edit
@@ -1511,6 +1669,177 @@ ges_timeline_object_split (GESTimelineObject * object, guint64 position)
   return new_object;
 }
 
+static gint
+position_compare (gconstpointer a, gconstpointer b)
+{
+  guint64 pa = *(const guint64 *) a, pb = *(const guint64 *) b;
+
+  return pa < pb ? -1 : (pa > pb ? 1 : 0);
+}
+
+/* Splits @tckobj at the @n_positions sorted @positions, the piece starting
+ * at positions[i] going to new_objects[i] */
+static void
+split_track_object (GESTrackObject * tckobj, const guint64 * positions,
+    guint n_positions, GESTimelineObject ** new_objects)
+{
+  guint i;
+  gboolean locked;
+  GESTrack *track;
+  GESTrackObject *new_tckobj;
+  GstClockTime start, end, inpoint, pos, next;
+
+  start = ges_track_object_get_start (tckobj);
+  end = start + ges_track_object_get_duration (tckobj);
+  inpoint = ges_track_object_get_inpoint (tckobj);
+  track = ges_track_object_get_track (tckobj);
+
+  /* Unlock TrackObject-s as we do not want the container to move
+   * syncronously */
+  locked = ges_track_object_is_locked (tckobj);
+  ges_track_object_set_locked (tckobj, FALSE);
+
+  for (i = 0; i < n_positions; i++) {
+    pos = positions[i];
+    if (pos <= start || pos >= end)
+      continue;
+
+    /* The piece ends at the next position within @tckobj */
+    next = i + 1 < n_positions && positions[i + 1] < end ?
+        positions[i + 1] : end;
+
+    new_tckobj = ges_track_object_copy (tckobj, TRUE);
+    if (new_tckobj == NULL) {
+      GST_WARNING_OBJECT (tckobj, "Could not create a copy");
+      continue;
+    }
+
+    ges_timeline_object_add_track_object (new_objects[i], new_tckobj);
+    if (track)
+      ges_track_add_object (track, new_tckobj);
+
+    ges_track_object_set_locked (new_tckobj, FALSE);
+    ges_track_object_set_start (new_tckobj, pos);
+    ges_track_object_set_inpoint (new_tckobj, inpoint + pos - start);
+    ges_track_object_set_duration (new_tckobj, next - pos);
+    ges_track_object_set_locked (new_tckobj, locked);
+  }
+
+  /* Set 'old' track object duration */
+  for (i = 0; i < n_positions; i++) {
+    if (positions[i] > start && positions[i] < end) {
+      ges_track_object_set_duration (tckobj, positions[i] - start);
+      break;
+    }
+  }
+
+  ges_track_object_set_locked (tckobj, locked);
+}
+
+/**
+ * ges_timeline_object_split_many:
+ * @object: the #GESTimelineObject to split
+ * @positions: (array length=n_positions): the positions at which to split
+ * @object
+ * @n_positions: the number of positions in @positions
+ *
+ * Splits @object at all the given @positions at once. This gives the same
+ * result as calling ges_timeline_object_split() for each of them, but the
+ * new objects are added to the layer of @object in one batch and the tracks
+ * are only updated once, which makes it much faster for lots of positions.
+ *
+ * @positions do not need to be sorted, the ones outside of @object or
+ * repeated are ignored. @object is shortened to end at the first position.
+ *
+ * Returns: (transfer container) (element-type GESTimelineObject): The newly
+ * created #GESTimelineObject-s sorted by start, which belong to the layer of
+ * @object if any, or %NULL if no position was within @object.
+ */
+GList *
+ges_timeline_object_split_many (GESTimelineObject * object,
+    const guint64 * positions, guint n_positions)
+{
+  guint i, n, n_sorted;
+  guint64 *sorted;
+  GList *tmp, *ret = NULL;
+  GESTimeline *timeline = NULL;
+  GESTimelineObject **new_objects;
+  GESTimelineObjectPrivate *priv;
+  GstClockTime start, end, next;
+
+  g_return_val_if_fail (GES_IS_TIMELINE_OBJECT (object), NULL);
+  g_return_val_if_fail (positions != NULL || n_positions == 0, NULL);
+
+  priv = object->priv;
+  start = GES_TIMELINE_OBJECT_START (object);
+  end = start + GES_TIMELINE_OBJECT_DURATION (object);
+
+  /* Keep the positions within @object, sorted and unique */
+  sorted = g_new (guint64, MAX (n_positions, 1));
+  for (i = 0, n_sorted = 0; i < n_positions; i++) {
+    if (positions[i] > start && positions[i] < end)
+      sorted[n_sorted++] = positions[i];
+    else
+      GST_WARNING_OBJECT (object, "Can not split %" GST_TIME_FORMAT
+          " out of boundaries", GST_TIME_ARGS (positions[i]));
+  }
+  g_qsort_with_data (sorted, n_sorted, sizeof (guint64),
+      (GCompareDataFunc) position_compare, NULL);
+  for (i = 0, n = 0; i < n_sorted; i++) {
+    if (n == 0 || sorted[i] != sorted[n - 1])
+      sorted[n++] = sorted[i];
+  }
+
+  if (n == 0) {
+    g_free (sorted);
+    return NULL;
+  }
+
+  GST_DEBUG_OBJECT (object, "Spliting at %u positions", n);
+
+  if (priv->layer)
+    timeline = ges_timeline_layer_get_timeline (priv->layer);
+  if (timeline)
+    ges_timeline_begin_edit (timeline);
+
+  /* Create the new TimelineObject-s */
+  new_objects = g_new (GESTimelineObject *, n);
+  for (i = 0; i < n; i++) {
+    next = i + 1 < n ? sorted[i + 1] : end;
+
+    new_objects[i] = ges_timeline_object_copy (object, FALSE);
+    ges_timeline_object_set_start (new_objects[i], sorted[i]);
+    ges_timeline_object_set_inpoint (new_objects[i], object->inpoint +
+        sorted[i] - start);
+    ges_timeline_object_set_duration (new_objects[i], next - sorted[i]);
+
+    /* We do not want the timeline to create again TrackObject-s */
+    ges_timeline_object_set_moving_from_layer (new_objects[i], TRUE);
+    ret = g_list_prepend (ret, new_objects[i]);
+  }
+  ret = g_list_reverse (ret);
+
+  if (priv->layer)
+    ges_timeline_layer_add_objects (priv->layer, new_objects, n);
+
+  for (i = 0; i < n; i++)
+    ges_timeline_object_set_moving_from_layer (new_objects[i], FALSE);
+
+  /* We first set the new duration and the child mapping will be updated
+   * properly when the children are shortened */
+  object->duration = sorted[0] - object->start;
+  for (tmp = priv->trackobjects; tmp; tmp = tmp->next)
+    split_track_object (GES_TRACK_OBJECT (tmp->data), sorted, n, new_objects);
+
+  if (timeline)
+    ges_timeline_commit_edit (timeline);
+
+  g_free (new_objects);
+  g_free (sorted);
+
+  return ret;
+}
+
 /* TODO implement the deep parameter, and make it public */
 static GESTimelineObject *
 ges_timeline_object_copy (GESTimelineObject * object, gboolean * deep)
@@ -1601,9 +1930,8 @@ ges_timeline_object_objects_set_locked (GESTimelineObject * object,
 
   g_return_if_fail (GES_IS_TIMELINE_OBJECT (object));
 
-  for (tmp = object->priv->mappings; tmp; tmp = g_list_next (tmp)) {
-    ges_track_object_set_locked (((ObjectMapping *) tmp->data)->object, locked);
-  }
+  for (tmp = object->priv->trackobjects; tmp; tmp = g_list_next (tmp))
+    ges_track_object_set_locked (GES_TRACK_OBJECT (tmp->data), locked);
 }
 
 /**
@@ -294,6 +294,10 @@ ges_timeline_object_set_top_effect_priority (GESTimelineObject *object,
 					     GESTrackEffect *effect,
 					     guint newpriority);
 
+gboolean
+ges_timeline_object_set_effect_stack        (GESTimelineObject *object,
+					     GList *effects);
+
 GESTrackType
 ges_timeline_object_get_supported_formats   (GESTimelineObject * object);
 
@@ -304,6 +308,11 @@ ges_timeline_object_set_supported_formats   (GESTimelineObject * object,
 GESTimelineObject *
 ges_timeline_object_split                   (GESTimelineObject * object, guint64 position);
 
+GList *
+ges_timeline_object_split_many              (GESTimelineObject * object,
+                                             const guint64 * positions,
+                                             guint n_positions);
+
 gboolean
 ges_timeline_object_edit                    (GESTimelineObject * object,
                                              GList *layers, gint new_layer_priority,
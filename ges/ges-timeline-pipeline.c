@@ -44,8 +44,10 @@ typedef struct
   GstPad *srcpad;               /* Timeline source pad */
   GstPad *playsinkpad;
   GstPad *encodebinpad;
-  GstPad *blocked_pad;
+  GstPad *encodebinteepad;      /* Tee pad linked to encodebin */
+  GstPad *blocked_pad;          /* Tee pad linked to playsink */
   gulong probe_id;
+  gulong tee_probe_id;          /* Blocks the tee while outputs change */
 } OutputChain;
 
 G_DEFINE_TYPE (GESTimelinePipeline, ges_timeline_pipeline, GST_TYPE_PIPELINE);
@@ -63,6 +65,13 @@ struct _GESTimelinePipelinePrivate
   GList *chains;
 
   GstEncodingProfile *profile;
+
+  /* Range to render, GST_CLOCK_TIME_NONE as @render_stop meaning until the
+   * end of the timeline */
+  GstClockTime render_start;
+  GstClockTime render_stop;
+  /* TRUE if the range has to be seeked to before going to PLAYING */
+  gboolean render_range_pending;
 };
 
 static GstStateChangeReturn ges_timeline_pipeline_change_state (GstElement *
@@ -130,6 +139,9 @@ ges_timeline_pipeline_init (GESTimelinePipeline * self)
   self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
       GES_TYPE_TIMELINE_PIPELINE, GESTimelinePipelinePrivate);
 
+  self->priv->render_start = 0;
+  self->priv->render_stop = GST_CLOCK_TIME_NONE;
+
   self->priv->playsink =
       gst_element_factory_make ("playsink", "internal-sinks");
   self->priv->encodebin =
@@ -184,16 +196,430 @@ ges_timeline_pipeline_new (void)
   ( (GST_IS_ENCODING_AUDIO_PROFILE (profile) && (tracktype) == GES_TRACK_TYPE_AUDIO) || \
     (GST_IS_ENCODING_VIDEO_PROFILE (profile) && (tracktype) == GES_TRACK_TYPE_VIDEO))
 
+/* Smart rendering
+ *
+ * A range of the timeline can be copied from its file without decoding and
+ * encoding it again ("passed through") when, in every track, it is covered by
+ * a single active source, all of them from the same file source, with no
+ * effect nor transition over it, and that file has a stream matching the
+ * format the profile uses for the track.
+ *
+ * GES has no keyframe index, so a range is only known to start on a keyframe
+ * when it starts at the beginning of its file. */
+
+typedef struct
+{
+  GESTrack *track;
+  GstCaps *format;
+  GList *objects;               /* sorted by start, not yet reached */
+  GList *active;                /* the ones covering the current range */
+} TrackPlan;
+
+static GstCaps *
+get_track_format (GESTimelinePipeline * self, GESTrack * track)
+{
+  const GList *tmp;
+
+  tmp = gst_encoding_container_profile_get_profiles (
+      (GstEncodingContainerProfile *) self->priv->profile);
+  for (; tmp; tmp = tmp->next) {
+    if (TRACK_COMPATIBLE_PROFILE (track->type, tmp->data))
+      return gst_encoding_profile_get_format (tmp->data);
+  }
+
+  return NULL;
+}
+
+/* What a planning pass knows about the files of its sources. Every file is
+ * looked up once per pass, with a single discoverer. */
+typedef struct
+{
+  gboolean discover;            /* Whether unknown files may be discovered */
+  GstDiscoverer *discoverer;    /* Created on the first discovery */
+  GHashTable *caps;             /* uri -> GstCaps, empty when unknown */
+} PlanContext;
+
+/* Discovers the caps of the streams of @uri, returning empty caps when it
+ * can not be discovered, or NULL if no discovery could be attempted */
+static GstCaps *
+discover_stream_caps (PlanContext * ctx, const gchar * uri)
+{
+  GstCaps *caps;
+  GstDiscovererInfo *info;
+  DiscoveryCacheEntry *entry;
+
+  if (ctx->discoverer == NULL) {
+    ctx->discoverer = gst_discoverer_new (15 * GST_SECOND, NULL);
+    if (ctx->discoverer == NULL) {
+      ctx->discover = FALSE;
+      return NULL;
+    }
+  }
+
+  GST_DEBUG ("Discovering the streams of %s", uri);
+
+  info = gst_discoverer_discover_uri (ctx->discoverer, uri, NULL);
+  if (info == NULL ||
+      gst_discoverer_info_get_result (info) != GST_DISCOVERER_OK) {
+    GST_WARNING ("Could not discover %s, it will be re-encoded", uri);
+    if (info)
+      gst_discoverer_info_unref (info);
+    return gst_caps_new_empty ();
+  }
+
+  entry = discovery_cache_entry_new_from_info (info);
+  discovery_cache_store (uri, entry);
+  caps = discovery_cache_entry_get_caps (entry);
+  discovery_cache_entry_free (entry);
+  gst_discoverer_info_unref (info);
+
+  return caps;
+}
+
+/* Returns the caps of the streams of the file of @source, as discovered by
+ * the timeline or cached. Sources which had all their properties set were
+ * never discovered, their file is discovered here if @ctx allows it. The
+ * caps are empty if the file is unknown or could not be discovered, in
+ * which case it is re-encoded. */
+static GstCaps *
+get_stream_caps (PlanContext * ctx, GESTimelineFileSource * source)
+{
+  GstCaps *caps;
+  DiscoveryCacheEntry *entry;
+  const gchar *uri;
+
+  caps = timeline_filesource_get_stream_caps (source);
+  if (caps)
+    return caps;
+
+  uri = ges_timeline_filesource_get_uri (source);
+  caps = g_hash_table_lookup (ctx->caps, uri);
+  if (caps)
+    return gst_caps_ref (caps);
+
+  /* Older cache entries lack the caps */
+  entry = discovery_cache_lookup (uri);
+  if (entry && entry->caps)
+    caps = discovery_cache_entry_get_caps (entry);
+  if (entry)
+    discovery_cache_entry_free (entry);
+
+  if (caps == NULL && ctx->discover)
+    caps = discover_stream_caps (ctx, uri);
+
+  if (caps)
+    timeline_filesource_set_stream_caps (source, caps);
+  else
+    caps = gst_caps_new_empty ();
+
+  g_hash_table_insert (ctx->caps, g_strdup (uri), gst_caps_ref (caps));
+
+  return caps;
+}
+
+static gboolean
+source_has_format (PlanContext * ctx, GESTimelineFileSource * source,
+    const GstCaps * format)
+{
+  gboolean ret;
+  GstCaps *caps = get_stream_caps (ctx, source);
+
+  ret = gst_caps_can_intersect (caps, format);
+  gst_caps_unref (caps);
+
+  return ret;
+}
+
+static void
+add_object_edges (GESTrackObject * object, GArray * edges)
+{
+  guint64 start = ges_track_object_get_start (object);
+  guint64 end = start + ges_track_object_get_duration (object);
+
+  g_array_append_val (edges, start);
+  g_array_append_val (edges, end);
+}
+
+static gint
+compare_edges (gconstpointer a, gconstpointer b)
+{
+  guint64 ea = *(const guint64 *) a, eb = *(const guint64 *) b;
+
+  return ea < eb ? -1 : ea > eb;
+}
+
+/* Updates the active objects of @plan to the ones covering the range
+ * starting at @start, no object edge lying within that range */
+static void
+track_plan_advance (TrackPlan * plan, guint64 start)
+{
+  GList *tmp, *next;
+  GESTrackObject *object;
+
+  for (tmp = plan->active; tmp; tmp = next) {
+    object = tmp->data;
+    next = tmp->next;
+
+    if (ges_track_object_get_start (object) +
+        ges_track_object_get_duration (object) <= start) {
+      plan->active = g_list_delete_link (plan->active, tmp);
+      g_object_unref (object);
+    }
+  }
+
+  while (plan->objects &&
+      ges_track_object_get_start (plan->objects->data) <= start) {
+    tmp = plan->objects;
+    plan->objects = g_list_remove_link (plan->objects, tmp);
+    plan->active = g_list_concat (tmp, plan->active);
+  }
+}
+
+/* Returns the file source that can be passed through over the range the
+ * @plans were advanced to, or NULL */
+static GESTimelineObject *
+get_passthrough_source (PlanContext * ctx, GArray * plans)
+{
+  guint i;
+  TrackPlan *plan;
+  GESTrackObject *object;
+  GESTimelineObject *source = NULL;
+
+  for (i = 0; i < plans->len; i++) {
+    plan = &g_array_index (plans, TrackPlan, i);
+
+    if (plan->active == NULL || plan->active->next)
+      return NULL;
+
+    object = plan->active->data;
+    if (!GES_IS_TRACK_FILESOURCE (object))
+      return NULL;
+
+    if (source == NULL)
+      source = ges_track_object_get_timeline_object (object);
+    else if (ges_track_object_get_timeline_object (object) != source)
+      return NULL;
+  }
+
+  if (source == NULL || !GES_IS_TIMELINE_FILE_SOURCE (source) ||
+      ges_timeline_filesource_is_image (GES_TIMELINE_FILE_SOURCE (source)))
+    return NULL;
+
+  for (i = 0; i < plans->len; i++) {
+    plan = &g_array_index (plans, TrackPlan, i);
+
+    if (!source_has_format (ctx, GES_TIMELINE_FILE_SOURCE (source),
+            plan->format))
+      return NULL;
+  }
+
+  return source;
+}
+
+/* TRUE if the single active object of each of the @plans starts at @start
+ * and at the beginning of its file */
+static gboolean
+starts_on_keyframe (GArray * plans, guint64 start)
+{
+  guint i;
+  GESTrackObject *object;
+
+  for (i = 0; i < plans->len; i++) {
+    object = g_array_index (plans, TrackPlan, i).active->data;
+
+    if (ges_track_object_get_start (object) != start ||
+        ges_track_object_get_inpoint (object) != 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+track_plan_clear (TrackPlan * plan)
+{
+  if (plan->format)
+    gst_caps_unref (plan->format);
+  g_list_free_full (plan->objects, g_object_unref);
+  g_list_free_full (plan->active, g_object_unref);
+}
+
+/* Plans the passthrough ranges of @pipeline, discovering the files of the
+ * sources the timeline did not discover if @discover is set */
+static guint64 *
+get_passthrough_ranges (GESTimelinePipeline * pipeline, gboolean discover,
+    guint * n_ranges)
+{
+  guint i;
+  GList *tracks, *tmp;
+  GArray *plans, *edges, *ranges;
+  GESTimelineObject *source, *current = NULL;
+  PlanContext ctx = { discover, NULL, NULL };
+
+  *n_ranges = 0;
+  if (pipeline->priv->timeline == NULL || pipeline->priv->profile == NULL)
+    return NULL;
+
+  ctx.caps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) gst_caps_unref);
+  plans = g_array_new (FALSE, TRUE, sizeof (TrackPlan));
+  edges = g_array_new (FALSE, FALSE, sizeof (guint64));
+  ranges = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  tracks = ges_timeline_get_tracks (pipeline->priv->timeline);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    TrackPlan plan = { tmp->data, NULL, NULL, NULL };
+    GList *objects, *lobj;
+
+    plan.format = get_track_format (pipeline, plan.track);
+    g_array_append_val (plans, plan);
+
+    /* Nothing can be passed through in a track the profile does not encode */
+    if (plan.format == NULL)
+      goto done;
+
+    /* Inactive objects play no part in the output */
+    objects = ges_track_get_objects (plan.track);
+    for (lobj = objects; lobj; lobj = lobj->next) {
+      if (ges_track_object_is_active (lobj->data) &&
+          ges_track_object_get_duration (lobj->data) > 0) {
+        add_object_edges (lobj->data, edges);
+        plan.objects = g_list_prepend (plan.objects, lobj->data);
+      } else
+        g_object_unref (lobj->data);
+    }
+    g_list_free (objects);
+
+    g_array_index (plans, TrackPlan, plans->len - 1).objects =
+        g_list_reverse (plan.objects);
+  }
+
+  if (plans->len == 0)
+    goto done;
+
+  g_array_sort (edges, compare_edges);
+
+  /* Go through the ranges between two consecutive edges, merging the
+   * adjacent ones passing the same source through */
+  for (i = 0; i + 1 < edges->len; i++) {
+    guint64 start = g_array_index (edges, guint64, i);
+    guint64 stop = g_array_index (edges, guint64, i + 1);
+    guint j;
+
+    if (start == stop)
+      continue;
+
+    for (j = 0; j < plans->len; j++)
+      track_plan_advance (&g_array_index (plans, TrackPlan, j), start);
+
+    source = get_passthrough_source (&ctx, plans);
+    if (source && source == current) {
+      g_array_index (ranges, guint64, ranges->len - 1) = stop;
+    } else if (source && starts_on_keyframe (plans, start)) {
+      g_array_append_val (ranges, start);
+      g_array_append_val (ranges, stop);
+      current = source;
+    } else
+      current = NULL;
+  }
+
+done:
+  for (i = 0; i < plans->len; i++)
+    track_plan_clear (&g_array_index (plans, TrackPlan, i));
+  g_list_free_full (tracks, g_object_unref);
+  g_array_free (plans, TRUE);
+  g_array_free (edges, TRUE);
+  g_hash_table_unref (ctx.caps);
+  if (ctx.discoverer)
+    g_object_unref (ctx.discoverer);
+
+  *n_ranges = ranges->len / 2;
+  return (guint64 *) g_array_free (ranges, ranges->len == 0);
+}
+
+/**
+ * ges_timeline_pipeline_get_passthrough_ranges:
+ * @pipeline: a #GESTimelinePipeline with a timeline and render settings
+ * @n_ranges: (out): return location for the number of ranges
+ *
+ * Finds the ranges of the timeline of @pipeline that can be copied from their
+ * file, without being decoded and encoded again, when rendering with the
+ * profile given to ges_timeline_pipeline_set_render_settings(). Those are
+ * the ranges where, in every track, a single #GESTimelineFileSource plays
+ * from a keyframe with no effect nor transition over it, and whose file
+ * streams already are in the formats of the profile. Everything else has
+ * to be re-encoded.
+ *
+ * The formats of the file streams are the ones the timeline discovered, or
+ * the ones of the discovery cache. The files of the sources it did not have
+ * to discover are discovered during this call, which blocks until they are.
+ * #TIMELINE_MODE_SMART_RENDER never discovers them itself when the
+ * @pipeline changes state, and re-encodes the sources it knows nothing
+ * about, so call this before rendering a timeline in which every source
+ * had all its properties set.
+ *
+ * As GES does not index keyframes, a range is only considered to start on a
+ * keyframe when it starts at the beginning of its file.
+ *
+ * Returns: (transfer full): 2 * @n_ranges positions, the sorted start and
+ * stop of each range, or %NULL if there are none. Free with g_free().
+ */
+guint64 *
+ges_timeline_pipeline_get_passthrough_ranges (GESTimelinePipeline * pipeline,
+    guint * n_ranges)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), NULL);
+  g_return_val_if_fail (n_ranges != NULL, NULL);
+
+  return get_passthrough_ranges (pipeline, TRUE, n_ranges);
+}
+
+/* TRUE if the whole timeline can be passed through, in which case smart
+ * rendering only copies streams. Called while changing state, so nothing
+ * is discovered. */
+static gboolean
+timeline_is_passthrough (GESTimelinePipeline * self)
+{
+  guint i, n_ranges;
+  guint64 *ranges, duration;
+  gboolean ret;
+
+  ranges = get_passthrough_ranges (self, FALSE, &n_ranges);
+  if (ranges == NULL)
+    return FALSE;
+
+  g_object_get (self->priv->timeline, "duration", &duration, NULL);
+
+  /* The ranges of different sources can follow each other, the cuts between
+   * them being on keyframes */
+  ret = ranges[0] == 0 && ranges[2 * n_ranges - 1] >= duration;
+  for (i = 1; ret && i < n_ranges; i++)
+    ret = ranges[2 * i] == ranges[2 * i - 1];
+
+  g_free (ranges);
+
+  return ret;
+}
+
 static gboolean
 ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
 {
   GList *ltrack, *tracks, *lstream;
+  gboolean passthrough;
 
   if (!self->priv->profile)
     return TRUE;
 
   GST_DEBUG ("Updating track caps");
 
+  /* Copying the streams only works if nothing has to be re-encoded, mixing
+   * copied and re-encoded ranges in one output is not supported */
+  passthrough = self->priv->mode == TIMELINE_MODE_SMART_RENDER &&
+      timeline_is_passthrough (self);
+  if (self->priv->mode == TIMELINE_MODE_SMART_RENDER && !passthrough)
+    GST_INFO_OBJECT (self, "Parts of the timeline need to be re-encoded, "
+        "decoding everything");
+
   tracks = ges_timeline_get_tracks (self->priv->timeline);
 
   /* Take each stream of the encoding profile and find a matching
@@ -211,7 +637,7 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
       GstEncodingProfile *prof = (GstEncodingProfile *) lstream->data;
 
       if (TRACK_COMPATIBLE_PROFILE (track->type, prof)) {
-        if (self->priv->mode == TIMELINE_MODE_SMART_RENDER) {
+        if (passthrough) {
           GstCaps *ocaps, *rcaps;
 
           GST_DEBUG ("Smart Render mode, setting input caps");
@@ -251,6 +677,33 @@ ges_timeline_pipeline_update_caps (GESTimelinePipeline * self)
   return TRUE;
 }
 
+static gboolean
+has_render_range (GESTimelinePipeline * self)
+{
+  return self->priv->render_start != 0 ||
+      GST_CLOCK_TIME_IS_VALID (self->priv->render_stop);
+}
+
+/* Flushes the pipeline and restarts it at the beginning of the render range,
+ * the compositions then only instantiate the objects within it */
+static gboolean
+seek_render_range (GESTimelinePipeline * self)
+{
+  GESTimelinePipelinePrivate *priv = self->priv;
+
+  GST_DEBUG_OBJECT (self, "Seeking to render range %" GST_TIME_FORMAT
+      " -- %" GST_TIME_FORMAT, GST_TIME_ARGS (priv->render_start),
+      GST_TIME_ARGS (priv->render_stop));
+
+  priv->render_range_pending = FALSE;
+
+  return gst_element_seek (GST_ELEMENT_CAST (self), 1.0, GST_FORMAT_TIME,
+      GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE,
+      GST_SEEK_TYPE_SET, priv->render_start,
+      GST_CLOCK_TIME_IS_VALID (priv->render_stop) ?
+      GST_SEEK_TYPE_SET : GST_SEEK_TYPE_NONE, priv->render_stop);
+}
+
 static GstStateChangeReturn
 ges_timeline_pipeline_change_state (GstElement * element,
     GstStateChange transition)
@@ -277,7 +730,19 @@ ges_timeline_pipeline_change_state (GstElement * element,
         goto done;
       }
       /* Set caps on all tracks according to profile if present */
-      /* FIXME : Add a new SMART_RENDER mode to avoid decoding */
+      self->priv->render_range_pending = has_render_range (self);
+      break;
+    case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
+      /* The pipeline prerolled, seeking now, before any buffer is rendered,
+       * does not wait for anything. If the preroll failed we never get
+       * there. */
+      if (self->priv->render_range_pending &&
+          (self->priv->mode & (TIMELINE_MODE_RENDER |
+                  TIMELINE_MODE_SMART_RENDER)) && !seek_render_range (self)) {
+        GST_ERROR_OBJECT (element, "Could not seek to the render range");
+        ret = GST_STATE_CHANGE_FAILURE;
+        goto done;
+      }
       break;
     default:
       break;
@@ -287,6 +752,9 @@ ges_timeline_pipeline_change_state (GstElement * element,
       GST_ELEMENT_CLASS (ges_timeline_pipeline_parent_class)->change_state
       (element, transition);
 
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    self->priv->render_range_pending = FALSE;
+
 done:
   return ret;
 }
@@ -391,6 +859,172 @@ pad_blocked (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
   return GST_PAD_PROBE_OK;
 }
 
+static void
+unblock_chain (OutputChain * chain)
+{
+  if (chain->blocked_pad && chain->probe_id) {
+    GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
+    gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
+    chain->probe_id = 0;
+  }
+}
+
+/* Links the tee of @chain to a new playsink pad. The tee pad stays blocked
+ * until playsink got all its streams and is unblocked with unblock_chain() */
+static gboolean
+connect_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  const gchar *sinkpad_name;
+  GstPad *sinkpad, *tmppad;
+  gboolean reconfigured = FALSE;
+
+  GST_DEBUG_OBJECT (self, "Connecting to playsink");
+
+  switch (chain->track->type) {
+    case GES_TRACK_TYPE_VIDEO:
+      sinkpad_name = "video_sink";
+      break;
+    case GES_TRACK_TYPE_AUDIO:
+      sinkpad_name = "audio_sink";
+      break;
+    case GES_TRACK_TYPE_TEXT:
+      sinkpad_name = "text_sink";
+      break;
+    default:
+      GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
+          chain->track->type);
+      return FALSE;
+  }
+
+  /* Request a sinkpad from playsink */
+  if (G_UNLIKELY (!(sinkpad =
+              gst_element_get_request_pad (self->priv->playsink,
+                  sinkpad_name)))) {
+    GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
+    return FALSE;
+  }
+
+  tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
+  if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
+    gst_element_release_request_pad (chain->tee, tmppad);
+    gst_object_unref (tmppad);
+    gst_element_release_request_pad (self->priv->playsink, sinkpad);
+    gst_object_unref (sinkpad);
+    return FALSE;
+  }
+  chain->blocked_pad = tmppad;
+  GST_DEBUG_OBJECT (tmppad, "blocking pad");
+  chain->probe_id = gst_pad_add_probe (tmppad, GST_PAD_PROBE_TYPE_BLOCK,
+      pad_blocked, NULL, NULL);
+
+  GST_DEBUG ("Reconfiguring playsink");
+
+  /* reconfigure playsink */
+  g_signal_emit_by_name (self->priv->playsink, "reconfigure", &reconfigured);
+  GST_DEBUG ("'reconfigure' returned %d", reconfigured);
+
+  /* We still hold a reference on the sinkpad */
+  chain->playsinkpad = sinkpad;
+
+  return TRUE;
+}
+
+static gboolean
+connect_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  GstPad *sinkpad, *tmppad;
+
+  GST_DEBUG_OBJECT (self, "Connecting to encodebin");
+
+  if (!chain->encodebinpad) {
+    /* Check for unused static pads */
+    sinkpad = get_compatible_unlinked_pad (self->priv->encodebin,
+        chain->srcpad);
+
+    if (sinkpad == NULL) {
+      GstCaps *caps = gst_pad_query_caps (chain->srcpad, NULL);
+
+      /* If no compatible static pad is available, request a pad */
+      g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
+          &sinkpad);
+      gst_caps_unref (caps);
+
+      if (G_UNLIKELY (sinkpad == NULL)) {
+        GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
+        return FALSE;
+      }
+    }
+    chain->encodebinpad = sinkpad;
+  }
+
+  tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
+  if (G_UNLIKELY (gst_pad_link_full (tmppad,
+              chain->encodebinpad,
+              GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
+    GST_WARNING_OBJECT (self, "Couldn't link track pad to playsink");
+    gst_element_release_request_pad (chain->tee, tmppad);
+    gst_object_unref (tmppad);
+    return FALSE;
+  }
+  chain->encodebinteepad = tmppad;
+
+  return TRUE;
+}
+
+/* Unlinking an output is done in two steps. The tee pads are first unlinked,
+ * and once the output was shut down, so that no buffer is held in it
+ * anymore, the request pads are released. */
+static void
+unlink_playsink (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->playsinkpad && chain->blocked_pad) {
+    unblock_chain (chain);
+    gst_pad_unlink (chain->blocked_pad, chain->playsinkpad);
+  }
+}
+
+static void
+release_playsink_pads (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->playsinkpad) {
+    gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
+    gst_object_unref (chain->playsinkpad);
+    chain->playsinkpad = NULL;
+  }
+
+  if (chain->blocked_pad) {
+    gst_element_release_request_pad (chain->tee, chain->blocked_pad);
+    gst_object_unref (chain->blocked_pad);
+    chain->blocked_pad = NULL;
+  }
+}
+
+static void
+unlink_encodebin (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->encodebinpad && chain->encodebinteepad)
+    gst_pad_unlink (chain->encodebinteepad, chain->encodebinpad);
+}
+
+static void
+release_encodebin_pads (GESTimelinePipeline * self, OutputChain * chain)
+{
+  if (chain->encodebinpad) {
+    gst_element_release_request_pad (self->priv->encodebin,
+        chain->encodebinpad);
+    gst_object_unref (chain->encodebinpad);
+    chain->encodebinpad = NULL;
+  }
+
+  if (chain->encodebinteepad) {
+    gst_element_release_request_pad (chain->tee, chain->encodebinteepad);
+    gst_object_unref (chain->encodebinteepad);
+    chain->encodebinteepad = NULL;
+  }
+}
+
 static void
 pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 {
@@ -398,7 +1032,6 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
   GESTrack *track;
   GstPad *sinkpad;
   GstCaps *caps;
-  gboolean reconfigured = FALSE;
 
   caps = gst_pad_query_caps (pad, NULL);
 
@@ -445,91 +1078,14 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 
   /* Connect playsink */
   if (self->priv->mode & TIMELINE_MODE_PREVIEW) {
-    const gchar *sinkpad_name;
-    GstPad *tmppad;
-
-    GST_DEBUG_OBJECT (self, "Connecting to playsink");
-
-    switch (track->type) {
-      case GES_TRACK_TYPE_VIDEO:
-        sinkpad_name = "video_sink";
-        break;
-      case GES_TRACK_TYPE_AUDIO:
-        sinkpad_name = "audio_sink";
-        break;
-      case GES_TRACK_TYPE_TEXT:
-        sinkpad_name = "text_sink";
-        break;
-      default:
-        GST_WARNING_OBJECT (self, "Can't handle tracks of type %d yet",
-            track->type);
-        goto error;
-    }
-
-    /* Request a sinkpad from playsink */
-    if (G_UNLIKELY (!(sinkpad =
-                gst_element_get_request_pad (self->priv->playsink,
-                    sinkpad_name)))) {
-      GST_ERROR_OBJECT (self, "Couldn't get a pad from the playsink !");
-      goto error;
-    }
-
-    tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad, sinkpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_ERROR_OBJECT (self, "Couldn't link track pad to playsink");
-      gst_object_unref (tmppad);
+    if (!connect_playsink (self, chain))
       goto error;
-    }
-    chain->blocked_pad = tmppad;
-    GST_DEBUG_OBJECT (tmppad, "blocking pad");
-    chain->probe_id = gst_pad_add_probe (tmppad, GST_PAD_PROBE_TYPE_BLOCK,
-        pad_blocked, NULL, NULL);
-
-    GST_DEBUG ("Reconfiguring playsink");
-
-    /* reconfigure playsink */
-    g_signal_emit_by_name (self->priv->playsink, "reconfigure", &reconfigured);
-    GST_DEBUG ("'reconfigure' returned %d", reconfigured);
-
-    /* We still hold a reference on the sinkpad */
-    chain->playsinkpad = sinkpad;
   }
 
   /* Connect to encodebin */
   if (self->priv->mode & (TIMELINE_MODE_RENDER | TIMELINE_MODE_SMART_RENDER)) {
-    GstPad *tmppad;
-    GST_DEBUG_OBJECT (self, "Connecting to encodebin");
-
-    if (!chain->encodebinpad) {
-      /* Check for unused static pads */
-      sinkpad = get_compatible_unlinked_pad (self->priv->encodebin, pad);
-
-      if (sinkpad == NULL) {
-        GstCaps *caps = gst_pad_query_caps (pad, NULL);
-
-        /* If no compatible static pad is available, request a pad */
-        g_signal_emit_by_name (self->priv->encodebin, "request-pad", caps,
-            &sinkpad);
-        gst_caps_unref (caps);
-
-        if (G_UNLIKELY (sinkpad == NULL)) {
-          GST_ERROR_OBJECT (self, "Couldn't get a pad from encodebin !");
-          goto error;
-        }
-      }
-      chain->encodebinpad = sinkpad;
-    }
-
-    tmppad = gst_element_get_request_pad (chain->tee, "src_%u");
-    if (G_UNLIKELY (gst_pad_link_full (tmppad,
-                chain->encodebinpad,
-                GST_PAD_LINK_CHECK_NOTHING) != GST_PAD_LINK_OK)) {
-      GST_WARNING_OBJECT (self, "Couldn't link track pad to playsink");
+    if (!connect_encodebin (self, chain))
       goto error;
-    }
-    gst_object_unref (tmppad);
-
   }
 
   /* If chain wasn't already present, insert it in list */
@@ -541,11 +1097,13 @@ pad_added_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
 
 error:
   {
+    unlink_playsink (self, chain);
+    release_playsink_pads (self, chain);
+    unlink_encodebin (self, chain);
+    release_encodebin_pads (self, chain);
     if (chain->tee) {
       gst_bin_remove (GST_BIN_CAST (self), chain->tee);
     }
-    if (sinkpad)
-      gst_object_unref (sinkpad);
     g_free (chain);
   }
 }
@@ -571,30 +1129,12 @@ pad_removed_cb (GstElement * timeline, GstPad * pad, GESTimelinePipeline * self)
   }
 
   /* Unlink encodebin */
-  if (chain->encodebinpad) {
-    peer = gst_pad_get_peer (chain->encodebinpad);
-    gst_pad_unlink (peer, chain->encodebinpad);
-    gst_object_unref (peer);
-    gst_element_release_request_pad (self->priv->encodebin,
-        chain->encodebinpad);
-  }
+  unlink_encodebin (self, chain);
+  release_encodebin_pads (self, chain);
 
   /* Unlink playsink */
-  if (chain->playsinkpad) {
-    peer = gst_pad_get_peer (chain->playsinkpad);
-    gst_pad_unlink (peer, chain->playsinkpad);
-    gst_object_unref (peer);
-    gst_element_release_request_pad (self->priv->playsink, chain->playsinkpad);
-    gst_object_unref (chain->playsinkpad);
-  }
-
-  if (chain->blocked_pad) {
-    GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
-    gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
-    gst_object_unref (chain->blocked_pad);
-    chain->blocked_pad = NULL;
-    chain->probe_id = 0;
-  }
+  unlink_playsink (self, chain);
+  release_playsink_pads (self, chain);
 
   /* Unlike/remove tee */
   peer = gst_element_get_static_pad (chain->tee, "sink");
@@ -615,16 +1155,8 @@ no_more_pads_cb (GstElement * timeline, GESTimelinePipeline * self)
   GList *tmp;
 
   GST_DEBUG ("received no-more-pads");
-  for (tmp = self->priv->chains; tmp; tmp = g_list_next (tmp)) {
-    OutputChain *chain = (OutputChain *) tmp->data;
-
-    if (chain->blocked_pad) {
-      GST_DEBUG_OBJECT (chain->blocked_pad, "unblocking pad");
-      gst_pad_remove_probe (chain->blocked_pad, chain->probe_id);
-      chain->probe_id = 0;
-      /* do we need to unref and NULL the pad here? */
-    }
-  }
+  for (tmp = self->priv->chains; tmp; tmp = g_list_next (tmp))
+    unblock_chain ((OutputChain *) tmp->data);
 }
 
 /**
@@ -715,6 +1247,249 @@ ges_timeline_pipeline_set_render_settings (GESTimelinePipeline * pipeline,
   return TRUE;
 }
 
+/* Whether switching to @mode can be done by only (un)linking playsink and
+ * encodebin, while the timeline keeps running */
+static gboolean
+can_reconfigure_outputs (GESTimelinePipeline * pipeline, GESPipelineFlags mode)
+{
+  GESTimelinePipelinePrivate *priv = pipeline->priv;
+
+  if (GST_STATE (pipeline) < GST_STATE_PAUSED ||
+      GST_STATE_PENDING (pipeline) != GST_STATE_VOID_PENDING ||
+      priv->chains == NULL)
+    return FALSE;
+
+  /* Smart rendering changes the caps of the tracks */
+  if ((priv->mode | mode) & TIMELINE_MODE_SMART_RENDER)
+    return FALSE;
+
+  if ((mode & TIMELINE_MODE_RENDER) && priv->urisink == NULL)
+    return FALSE;
+
+  return TRUE;
+}
+
+static GstPadProbeReturn
+tee_blocked (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GST_DEBUG_OBJECT (pad, "blocked while reconfiguring the outputs");
+  return GST_PAD_PROBE_OK;
+}
+
+/* Keeps the data from entering the tees, which would return NOT_LINKED
+ * when none of their pads is linked */
+static void
+block_tees (GESTimelinePipeline * self)
+{
+  GList *tmp;
+  GstPad *sinkpad;
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = (OutputChain *) tmp->data;
+
+    sinkpad = gst_element_get_static_pad (chain->tee, "sink");
+    chain->tee_probe_id = gst_pad_add_probe (sinkpad,
+        GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, tee_blocked, NULL, NULL);
+    gst_object_unref (sinkpad);
+  }
+}
+
+static void
+unblock_tees (GESTimelinePipeline * self)
+{
+  GList *tmp;
+  GstPad *sinkpad;
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next) {
+    OutputChain *chain = (OutputChain *) tmp->data;
+
+    if (chain->tee_probe_id == 0)
+      continue;
+
+    sinkpad = gst_element_get_static_pad (chain->tee, "sink");
+    gst_pad_remove_probe (sinkpad, chain->tee_probe_id);
+    chain->tee_probe_id = 0;
+    gst_object_unref (sinkpad);
+  }
+}
+
+/* Unlinks @element from the tees with @unlink, shuts it down so that no
+ * buffer is held in it anymore, then releases the request pads with
+ * @release and takes @element out of the pipeline */
+static void
+remove_output (GESTimelinePipeline * self, GstElement * element,
+    GstElement * sink, void (*unlink) (GESTimelinePipeline *, OutputChain *),
+    void (*release) (GESTimelinePipeline *, OutputChain *))
+{
+  GList *tmp;
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next)
+    unlink (self, tmp->data);
+
+  gst_element_set_locked_state (element, TRUE);
+  gst_element_set_state (element, GST_STATE_NULL);
+  if (sink) {
+    gst_element_set_locked_state (sink, TRUE);
+    gst_element_set_state (sink, GST_STATE_NULL);
+  }
+
+  for (tmp = self->priv->chains; tmp; tmp = tmp->next)
+    release (self, tmp->data);
+
+  if (GST_OBJECT_PARENT (element) == GST_OBJECT_CAST (self)) {
+    g_object_ref (element);
+    gst_bin_remove (GST_BIN_CAST (self), element);
+  }
+  gst_element_set_locked_state (element, FALSE);
+
+  if (sink) {
+    if (GST_OBJECT_PARENT (sink) == GST_OBJECT_CAST (self)) {
+      g_object_ref (sink);
+      gst_bin_remove (GST_BIN_CAST (self), sink);
+    }
+    gst_element_set_locked_state (sink, FALSE);
+  }
+}
+
+static void
+remove_preview_output (GESTimelinePipeline * self)
+{
+  GST_DEBUG ("Disabling playsink");
+
+  remove_output (self, self->priv->playsink, NULL, unlink_playsink,
+      release_playsink_pads);
+}
+
+static void
+remove_render_output (GESTimelinePipeline * self)
+{
+  GST_DEBUG ("Disabling rendering bin");
+
+  remove_output (self, self->priv->encodebin, self->priv->urisink,
+      unlink_encodebin, release_encodebin_pads);
+}
+
+static gboolean
+add_render_output (GESTimelinePipeline * self)
+{
+  GList *tmp;
+  GESTimelinePipelinePrivate *priv = self->priv;
+
+  GST_DEBUG ("Adding render bin");
+
+  if (!gst_bin_add (GST_BIN_CAST (self), priv->encodebin) ||
+      !gst_bin_add (GST_BIN_CAST (self), priv->urisink)) {
+    GST_ERROR_OBJECT (self, "Couldn't add the render bin");
+    goto failed;
+  }
+
+  g_object_set (priv->encodebin, "avoid-reencoding", FALSE, NULL);
+  gst_element_link_pads_full (priv->encodebin, "src", priv->urisink, "sink",
+      GST_PAD_LINK_CHECK_NOTHING);
+
+  /* Data only flows to the render bin once it reached the state of the
+   * pipeline */
+  gst_element_sync_state_with_parent (priv->urisink);
+  gst_element_sync_state_with_parent (priv->encodebin);
+
+  for (tmp = priv->chains; tmp; tmp = tmp->next) {
+    if (!connect_encodebin (self, tmp->data))
+      goto failed;
+  }
+
+  return TRUE;
+
+failed:
+  remove_render_output (self);
+  return FALSE;
+}
+
+static gboolean
+add_preview_output (GESTimelinePipeline * self)
+{
+  GList *tmp;
+  GESTimelinePipelinePrivate *priv = self->priv;
+
+  GST_DEBUG ("Adding playsink");
+
+  if (!gst_bin_add (GST_BIN_CAST (self), priv->playsink)) {
+    GST_ERROR_OBJECT (self, "Couldn't add playsink");
+    return FALSE;
+  }
+
+  for (tmp = priv->chains; tmp; tmp = tmp->next) {
+    if (!connect_playsink (self, tmp->data)) {
+      remove_preview_output (self);
+      return FALSE;
+    }
+  }
+
+  gst_element_sync_state_with_parent (priv->playsink);
+
+  for (tmp = priv->chains; tmp; tmp = tmp->next)
+    unblock_chain (tmp->data);
+
+  return TRUE;
+}
+
+static gboolean
+reconfigure_outputs (GESTimelinePipeline * pipeline, GESPipelineFlags mode)
+{
+  gint64 position;
+  GESTimelinePipelinePrivate *priv = pipeline->priv;
+  gboolean had_preview = priv->mode & TIMELINE_MODE_PREVIEW;
+  gboolean want_preview = mode & TIMELINE_MODE_PREVIEW;
+  gboolean had_render = priv->mode & TIMELINE_MODE_RENDER;
+  gboolean want_render = mode & TIMELINE_MODE_RENDER;
+
+  GST_DEBUG_OBJECT (pipeline, "Reconfiguring the outputs");
+
+  if (!gst_element_query_position (GST_ELEMENT_CAST (pipeline),
+          GST_FORMAT_TIME, &position))
+    position = 0;
+
+  block_tees (pipeline);
+
+  /* The new outputs are linked before the old ones are unlinked, so that
+   * the tees always have a linked pad, and nothing changes if they can not
+   * be */
+  if (!had_render && want_render && !add_render_output (pipeline))
+    goto failed;
+
+  if (!had_preview && want_preview && !add_preview_output (pipeline)) {
+    if (!had_render && want_render)
+      remove_render_output (pipeline);
+    goto failed;
+  }
+
+  if (had_preview && !want_preview)
+    remove_preview_output (pipeline);
+
+  if (had_render && !want_render)
+    remove_render_output (pipeline);
+
+  unblock_tees (pipeline);
+  priv->mode = mode;
+
+  /* The new outputs need a new stream, and the old ones might have returned
+   * FLUSHING while being shut down. A new render starts from the beginning
+   * of its range, the rest from the current position. */
+  if (!had_render && want_render)
+    seek_render_range (pipeline);
+  else if (had_preview != want_preview || had_render != want_render)
+    gst_element_seek_simple (GST_ELEMENT_CAST (pipeline), GST_FORMAT_TIME,
+        GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, position);
+
+  return TRUE;
+
+failed:
+  unblock_tees (pipeline);
+  GST_ERROR_OBJECT (pipeline, "Could not switch from mode %d to %d",
+      priv->mode, mode);
+
+  return FALSE;
+}
+
 /**
  * ges_timeline_pipeline_set_mode:
  * @pipeline: a #GESTimelinePipeline
@@ -723,9 +1498,17 @@ ges_timeline_pipeline_set_render_settings (GESTimelinePipeline * pipeline,
  * switches the @pipeline to the specified @mode. The default mode when
  * creating a #GESTimelinePipeline is #TIMELINE_MODE_PREVIEW.
  *
- * Note: The @pipeline will be set to #GST_STATE_NULL during this call due to
- * the internal changes that happen. The caller will therefore have to 
- * set the @pipeline to the requested state after calling this method.
+ * When the @pipeline is paused or playing, switching between the preview and
+ * render modes only links and unlinks the outputs, the timeline keeps its
+ * elements and the playback continues from the current position. A render
+ * enabled that way starts from the beginning of the render range. If the new
+ * outputs can not be linked, the @pipeline is left in its current mode.
+ *
+ * Note: Otherwise, and when switching from or to #TIMELINE_MODE_SMART_RENDER
+ * which changes the caps of the tracks, the @pipeline will be set to
+ * #GST_STATE_NULL during this call due to the internal changes that happen.
+ * The caller will therefore have to set the @pipeline to the requested state
+ * after calling this method.
  *
  * Returns: %TRUE if the mode was properly set, else %FALSE.
  **/
@@ -740,9 +1523,8 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
   if (mode == pipeline->priv->mode)
     return TRUE;
 
-  /* FIXME: It would be nice if we are only (de)activating preview
-   * modes to not set the whole pipeline to NULL, but instead just
-   * do the proper (un)linking to playsink. */
+  if (can_reconfigure_outputs (pipeline, mode))
+    return reconfigure_outputs (pipeline, mode);
 
   /* Switch pipeline to NULL since we're changing the configuration */
   gst_element_set_state (GST_ELEMENT_CAST (pipeline), GST_STATE_NULL);
@@ -812,6 +1594,44 @@ ges_timeline_pipeline_set_mode (GESTimelinePipeline * pipeline,
   return TRUE;
 }
 
+/**
+ * ges_timeline_pipeline_set_render_range:
+ * @pipeline: a #GESTimelinePipeline
+ * @start: the timeline position at which rendering starts
+ * @stop: the timeline position at which rendering stops, or
+ * #GST_CLOCK_TIME_NONE to render until the end of the timeline
+ *
+ * Restricts the rendering to the [@start, @stop] range of the timeline.
+ *
+ * When @pipeline goes from %GST_STATE_PAUSED to %GST_STATE_PLAYING in
+ * #TIMELINE_MODE_RENDER or #TIMELINE_MODE_SMART_RENDER, it does a segment
+ * seek to the range once prerolled, so that only the objects within it are
+ * used, and posts EOS once @stop is reached.
+ *
+ * The range is applied the next time @pipeline goes to
+ * %GST_STATE_PLAYING from %GST_STATE_READY or below.
+ *
+ * Returns: %TRUE if the range could be set, else %FALSE.
+ */
+gboolean
+ges_timeline_pipeline_set_render_range (GESTimelinePipeline * pipeline,
+    GstClockTime start, GstClockTime stop)
+{
+  g_return_val_if_fail (GES_IS_TIMELINE_PIPELINE (pipeline), FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (start), FALSE);
+
+  if (GST_CLOCK_TIME_IS_VALID (stop) && stop <= start) {
+    GST_WARNING_OBJECT (pipeline, "Empty render range %" GST_TIME_FORMAT
+        " -- %" GST_TIME_FORMAT, GST_TIME_ARGS (start), GST_TIME_ARGS (stop));
+    return FALSE;
+  }
+
+  pipeline->priv->render_start = start;
+  pipeline->priv->render_stop = stop;
+
+  return TRUE;
+}
+
 /**
  * ges_timeline_pipeline_get_thumbnail:
  * @self: a #GESTimelinePipeline in %GST_STATE_PLAYING or %GST_STATE_PAUSED
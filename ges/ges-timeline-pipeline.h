@@ -88,6 +88,13 @@ gboolean ges_timeline_pipeline_set_render_settings (GESTimelinePipeline *pipelin
 gboolean ges_timeline_pipeline_set_mode (GESTimelinePipeline *pipeline,
 					 GESPipelineFlags mode);
 
+guint64 *ges_timeline_pipeline_get_passthrough_ranges (GESTimelinePipeline *pipeline,
+						       guint *n_ranges);
+
+gboolean ges_timeline_pipeline_set_render_range (GESTimelinePipeline *pipeline,
+						  GstClockTime start,
+						  GstClockTime stop);
+
 GstSample *
 ges_timeline_pipeline_get_thumbnail(GESTimelinePipeline *self, GstCaps *caps);
 
@@ -43,6 +43,7 @@
 #include "ges.h"
 
 typedef struct _MoveContext MoveContext;
+typedef struct _DiscovererWorker DiscovererWorker;
 
 static inline void init_movecontext (MoveContext * mv_ctx);
 
@@ -93,7 +94,18 @@ struct _MoveContext
   /* Last snapping  properties */
   GESTrackObject *last_snaped1;
   GESTrackObject *last_snaped2;
-  GstClockTime *last_snap_ts;
+  GstClockTime last_snap_ts;
+};
+
+/* One of the discoverers of the pool used to discover virgin sources */
+struct _DiscovererWorker
+{
+  GESTimeline *timeline;
+  GstDiscoverer *discoverer;
+
+  /* Number of URIs queued on the discoverer, protected by the
+   * pendingobjects_lock */
+  guint pending;
 };
 
 struct _GESTimelinePrivate
@@ -104,9 +116,12 @@ struct _GESTimelinePrivate
   /* The duration of the timeline */
   gint64 duration;
 
-  /* discoverer used for virgin sources */
-  GstDiscoverer *discoverer;
-  GList *pendingobjects;
+  /* discoverers used for virgin sources */
+  GPtrArray *discoverers;       /* Array of DiscovererWorker */
+  guint discovery_concurrency;
+  /* {uri: GList of GESTimelineFileSource} URIs being discovered and the
+   * sources waiting for them */
+  GHashTable *pendingobjects;
   /* lock to avoid discovery of objects that will be removed */
   GMutex pendingobjects_lock;
 
@@ -115,20 +130,25 @@ struct _GESTimelinePrivate
 
   /* Timeline edition modes and snapping management */
   guint64 snapping_distance;
+  GList *snapping_tracks;       /* GESTrack-s to snap to, NULL for all */
+  GList *snapping_layers;       /* GESTimelineLayer-s to snap to, NULL for all */
+  gint snapping_fps_n;          /* Frame grid to snap to, 0 to disable */
+  gint snapping_fps_d;
 
   /* FIXME: Should we offer an API over those fields ?
    * FIXME: Should other classes than subclasses of TrackSource also
    * be tracked? */
 
   /* Snapping fields */
-  GHashTable *by_start;         /* {TrackSource: start} */
-  GHashTable *by_end;           /* {TrackSource: end} */
-  GHashTable *by_object;        /* {timecode: TrackSource} */
-  GSequence *starts_ends;       /* Sorted list of starts/ends */
+  SnapIndex *snap_index;        /* Sorted starts/ends of the TrackSource-s */
   /* We keep 1 reference to our trackobject here */
-  GSequence *tracksources;      /* TrackSource-s sorted by start/priorities */
+  IntervalTree *tracksources;   /* TrackSource-s by start/end */
 
   MoveContext movecontext;
+
+  /* Edit transactions */
+  guint edit_depth;
+  GHashTable *edited_sources;   /* Set of TrackSource-s to reindex on commit */
 };
 
 /* private structure to contain our track-related information */
@@ -139,6 +159,9 @@ typedef struct
   GESTrack *track;
   GstPad *pad;                  /* Pad from the track */
   GstPad *ghostpad;
+
+  /* Whether the track was updating when the edit transaction started */
+  gboolean updating_before_edit;
 } TrackPrivate;
 
 enum
@@ -147,6 +170,7 @@ enum
   PROP_DURATION,
   PROP_SNAPPING_DISTANCE,
   PROP_UPDATE,
+  PROP_DISCOVERY_CONCURRENCY,
   PROP_LAST
 };
 
@@ -172,12 +196,73 @@ static gint custom_find_track (TrackPrivate * tr_priv, GESTrack * track);
 static GstStateChangeReturn
 ges_timeline_change_state (GstElement * element, GstStateChange transition);
 static void
-discoverer_finished_cb (GstDiscoverer * discoverer, GESTimeline * timeline);
+discoverer_finished_cb (GstDiscoverer * discoverer, DiscovererWorker * worker);
 static void
 discoverer_discovered_cb (GstDiscoverer * discoverer,
-    GstDiscovererInfo * info, GError * err, GESTimeline * timeline);
+    GstDiscovererInfo * info, GError * err, DiscovererWorker * worker);
 
 /* Internal methods */
+static DiscovererWorker *
+discoverer_worker_new (GESTimeline * timeline)
+{
+  DiscovererWorker *worker = g_slice_new0 (DiscovererWorker);
+
+  worker->timeline = timeline;
+
+  /* New discoverer with a 15s timeout */
+  worker->discoverer = gst_discoverer_new (15 * GST_SECOND, NULL);
+  g_signal_connect (worker->discoverer, "finished",
+      G_CALLBACK (discoverer_finished_cb), worker);
+  g_signal_connect (worker->discoverer, "discovered",
+      G_CALLBACK (discoverer_discovered_cb), worker);
+  gst_discoverer_start (worker->discoverer);
+
+  return worker;
+}
+
+static void
+discoverer_worker_free (DiscovererWorker * worker)
+{
+  gst_discoverer_stop (worker->discoverer);
+  g_signal_handlers_disconnect_by_func (worker->discoverer,
+      discoverer_finished_cb, worker);
+  g_signal_handlers_disconnect_by_func (worker->discoverer,
+      discoverer_discovered_cb, worker);
+  g_object_unref (worker->discoverer);
+
+  g_slice_free (DiscovererWorker, worker);
+}
+
+/* Returns the least busy discoverer, starting a new one if they are all
+ * busy and the concurrency allows it. Must be called with the
+ * pendingobjects_lock taken */
+static DiscovererWorker *
+get_discoverer_worker (GESTimeline * timeline)
+{
+  guint i, nb_workers;
+  DiscovererWorker *worker, *best = NULL;
+  GESTimelinePrivate *priv = timeline->priv;
+
+  nb_workers = MIN (priv->discoverers->len, priv->discovery_concurrency);
+  for (i = 0; i < nb_workers; i++) {
+    worker = g_ptr_array_index (priv->discoverers, i);
+
+    if (best == NULL || worker->pending < best->pending)
+      best = worker;
+  }
+
+  if ((best == NULL || best->pending > 0) &&
+      priv->discoverers->len < priv->discovery_concurrency) {
+    best = discoverer_worker_new (timeline);
+    g_ptr_array_add (priv->discoverers, best);
+
+    GST_DEBUG_OBJECT (timeline, "Started discoverer %d",
+        priv->discoverers->len);
+  }
+
+  return best;
+}
+
 static gboolean
 ges_timeline_enable_update_internal (GESTimeline * timeline, gboolean enabled)
 {
@@ -216,6 +301,9 @@ ges_timeline_get_property (GObject * object, guint property_id,
     case PROP_UPDATE:
       g_value_set_boolean (value, ges_timeline_is_updating (timeline));
       break;
+    case PROP_DISCOVERY_CONCURRENCY:
+      g_value_set_uint (value, timeline->priv->discovery_concurrency);
+      break;
   }
 }
 
@@ -233,6 +321,11 @@ ges_timeline_set_property (GObject * object, guint property_id,
       ges_timeline_enable_update_internal (timeline,
           g_value_get_boolean (value));
       break;
+    case PROP_DISCOVERY_CONCURRENCY:
+      GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+      timeline->priv->discovery_concurrency = g_value_get_uint (value);
+      GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -243,10 +336,9 @@ ges_timeline_dispose (GObject * object)
 {
   GESTimelinePrivate *priv = GES_TIMELINE (object)->priv;
 
-  if (priv->discoverer) {
-    gst_discoverer_stop (priv->discoverer);
-    g_object_unref (priv->discoverer);
-    priv->discoverer = NULL;
+  if (priv->discoverers) {
+    g_ptr_array_free (priv->discoverers, TRUE);
+    priv->discoverers = NULL;
   }
 
   while (priv->layers) {
@@ -264,11 +356,14 @@ ges_timeline_dispose (GObject * object)
     ges_timeline_remove_track (GES_TIMELINE (object), tr_priv->track);
   }
 
-  g_hash_table_unref (priv->by_start);
-  g_hash_table_unref (priv->by_end);
-  g_hash_table_unref (priv->by_object);
-  g_sequence_free (priv->starts_ends);
-  g_sequence_free (priv->tracksources);
+  g_hash_table_unref (priv->edited_sources);
+  interval_tree_free (priv->tracksources);
+  snap_index_free (priv->snap_index);
+
+  g_list_free_full (priv->snapping_tracks, g_object_unref);
+  priv->snapping_tracks = NULL;
+  g_list_free_full (priv->snapping_layers, g_object_unref);
+  priv->snapping_layers = NULL;
 
   G_OBJECT_CLASS (ges_timeline_parent_class)->dispose (object);
 }
@@ -278,6 +373,7 @@ ges_timeline_finalize (GObject * object)
 {
   GESTimeline *timeline = GES_TIMELINE (object);
 
+  g_hash_table_unref (timeline->priv->pendingobjects);
   g_mutex_clear (&timeline->priv->pendingobjects_lock);
 
   G_OBJECT_CLASS (ges_timeline_parent_class)->finalize (object);
@@ -346,6 +442,22 @@ ges_timeline_class_init (GESTimelineClass * klass)
   g_object_class_install_property (object_class, PROP_UPDATE,
       properties[PROP_UPDATE]);
 
+  /**
+   * GESTimeline:discovery-concurrency:
+   *
+   * The maximum number of sources that are discovered at the same time when
+   * #GESTimelineFileSource-s lacking information are added to the timeline.
+   *
+   * Raising it speeds up the loading of projects with many files, especially
+   * when they live on slow storage.
+   */
+  properties[PROP_DISCOVERY_CONCURRENCY] =
+      g_param_spec_uint ("discovery-concurrency", "Discovery concurrency",
+      "Maximum number of sources discovered at the same time", 1, 256, 1,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, PROP_DISCOVERY_CONCURRENCY,
+      properties[PROP_DISCOVERY_CONCURRENCY]);
+
   /**
    * GESTimeline::track-added
    * @timeline: the #GESTimeline
@@ -465,20 +577,17 @@ ges_timeline_init (GESTimeline * self)
   init_movecontext (&self->priv->movecontext);
   priv->movecontext.ignore_needs_ctx = FALSE;
 
-  priv->by_start = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_end = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->by_object = g_hash_table_new (g_direct_hash, g_direct_equal);
-  priv->starts_ends = g_sequence_new (g_free);
-  priv->tracksources = g_sequence_new (g_object_unref);
+  priv->edited_sources = g_hash_table_new (g_direct_hash, g_direct_equal);
+  priv->tracksources = interval_tree_new (g_object_unref);
+  priv->snap_index = snap_index_new ();
 
   g_mutex_init (&priv->pendingobjects_lock);
-  /* New discoverer with a 15s timeout */
-  priv->discoverer = gst_discoverer_new (15 * GST_SECOND, NULL);
-  g_signal_connect (priv->discoverer, "finished",
-      G_CALLBACK (discoverer_finished_cb), self);
-  g_signal_connect (priv->discoverer, "discovered",
-      G_CALLBACK (discoverer_discovered_cb), self);
-  gst_discoverer_start (priv->discoverer);
+  priv->pendingobjects = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) g_list_free);
+  /* Discoverers are created when needed */
+  priv->discoverers =
+      g_ptr_array_new_with_free_func ((GDestroyNotify) discoverer_worker_free);
+  priv->discovery_concurrency = 1;
 }
 
 /* Private methods */
@@ -507,58 +616,27 @@ sort_layers (gpointer a, gpointer b)
 static void
 timeline_update_duration (GESTimeline * timeline)
 {
-  GstClockTime *cduration;
-  GSequenceIter *it = g_sequence_get_end_iter (timeline->priv->starts_ends);
+  /* The last edge is the end of the timeline */
+  guint64 cduration = snap_index_get_last_position (timeline->priv->snap_index);
 
-  it = g_sequence_iter_prev (it);
-  if (g_sequence_iter_is_end (it))
-    return;
-
-  cduration = g_sequence_get (it);
-  if (cduration && timeline->priv->duration != *cduration) {
+  if (timeline->priv->duration != cduration) {
     GST_DEBUG ("track duration : %" GST_TIME_FORMAT " current : %"
-        GST_TIME_FORMAT, GST_TIME_ARGS (*cduration),
+        GST_TIME_FORMAT, GST_TIME_ARGS (cduration),
         GST_TIME_ARGS (timeline->priv->duration));
 
-    timeline->priv->duration = *cduration;
+    timeline->priv->duration = cduration;
 
     g_object_notify_by_pspec (G_OBJECT (timeline), properties[PROP_DURATION]);
   }
 }
 
-static gint
-objects_start_compare (GESTrackObject * a, GESTrackObject * b)
-{
-  if (a->start == b->start) {
-    if (a->priority < b->priority)
-      return -1;
-    if (a->priority > b->priority)
-      return 1;
-    return 0;
-  }
-  if (a->start < b->start)
-    return -1;
-  if (a->start > b->start)
-    return 1;
-  return 0;
-}
-
 static inline void
-sort_track_objects (GESTimeline * timeline)
-{
-  g_sequence_sort (timeline->priv->tracksources,
-      (GCompareDataFunc) objects_start_compare, NULL);
-}
-
-static gint
-compare_uint64 (guint64 * a, guint64 * b, gpointer user_data)
+update_track_source (GESTimeline * timeline, GESTrackObject * obj)
 {
-  if (*a > *b)
-    return 1;
-  else if (*a == *b)
-    return 0;
-  else
-    return -1;
+  interval_tree_update (timeline->priv->tracksources, obj, obj->start,
+      obj->start + obj->duration, obj->priority);
+  snap_index_update (timeline->priv->snap_index, obj, obj->start,
+      obj->start + obj->duration);
 }
 
 static gint
@@ -569,117 +647,64 @@ custom_find_track (TrackPrivate * tr_priv, GESTrack * track)
   return -1;
 }
 
-/* Look for the pointer passed as @value */
-static GSequenceIter *
-lookup_pointer_uint (GSequence * seq, guint64 * value)
+/* Reindex the sources that changed during the current edit transaction */
+static void
+flush_edited_sources (GESTimeline * timeline)
 {
-  GSequenceIter *iter, *tmpiter;
-  guint64 *found, *tmpval;
-
-  iter = g_sequence_lookup (seq, value,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  found = g_sequence_get (iter);
-
-  /* We have the same pointer so we are all fine */
-  if (found == value)
-    return iter;
+  GHashTableIter iter;
+  GESTrackObject *tckobj;
+  GESTimelinePrivate *priv = timeline->priv;
 
-  if (!g_sequence_iter_is_end (iter)) {
-    /* Looking frontward for the good pointer */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_next (tmpiter))) {
-      if (g_sequence_iter_is_end (tmpiter))
-        break;
+  if (g_hash_table_size (priv->edited_sources) == 0)
+    return;
 
-      tmpval = g_sequence_get (tmpiter);
-      if (tmpval == value)
-        return tmpiter;
-      else if (*tmpval != *value)
-        break;
-    }
-  }
+  GST_DEBUG_OBJECT (timeline, "Reindexing %d sources",
+      g_hash_table_size (priv->edited_sources));
 
-  if (!g_sequence_iter_is_begin (iter)) {
-    /* Looking backward for the good pointer */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_prev (tmpiter))) {
-      tmpval = g_sequence_get (tmpiter);
-      if (tmpval == value)
-        return tmpiter;
-      else if (*tmpval != *value || g_sequence_iter_is_begin (tmpiter))
-        break;
-    }
+  g_hash_table_iter_init (&iter, priv->edited_sources);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & tckobj, NULL)) {
+    update_track_source (timeline, tckobj);
   }
+  g_hash_table_remove_all (priv->edited_sources);
 
-  GST_ERROR ("Missing timecode %p %" GST_TIME_FORMAT
-      " this should never happen", value, GST_TIME_ARGS (*value));
-
-  return NULL;
+  timeline_update_duration (timeline);
 }
 
-static inline void
-sort_starts_ends_end (GESTimeline * timeline, GESTrackObject * obj)
+static void
+track_begin_edit (TrackPrivate * tr_priv)
 {
-  GSequenceIter *iter;
-
-  GESTimelinePrivate *priv = timeline->priv;
-  guint64 *end = g_hash_table_lookup (priv->by_end, obj);
+  tr_priv->updating_before_edit = ges_track_is_updating (tr_priv->track);
 
-  iter = lookup_pointer_uint (priv->starts_ends, end);
-  *end = obj->start + obj->duration;
-
-  g_sequence_sort_changed (iter, (GCompareDataFunc) compare_uint64, NULL);
-  timeline_update_duration (timeline);
+  g_object_freeze_notify (G_OBJECT (tr_priv->track));
+  ges_track_enable_update (tr_priv->track, FALSE);
 }
 
-static inline void
-sort_starts_ends_start (GESTimeline * timeline, GESTrackObject * obj)
+static void
+track_commit_edit (TrackPrivate * tr_priv)
 {
-  GSequenceIter *iter;
+  if (tr_priv->updating_before_edit)
+    ges_track_enable_update (tr_priv->track, TRUE);
 
-  GESTimelinePrivate *priv = timeline->priv;
-  guint64 *start = g_hash_table_lookup (priv->by_start, obj);
-
-  iter = lookup_pointer_uint (priv->starts_ends, start);
-  *start = obj->start;
-
-  g_sequence_sort_changed (iter, (GCompareDataFunc) compare_uint64, NULL);
-  timeline_update_duration (timeline);
+  g_object_thaw_notify (G_OBJECT (tr_priv->track));
 }
 
-static inline void
-resort_all_starts_ends (GESTimeline * timeline)
+gboolean
+timeline_is_editing (GESTimeline * timeline)
 {
-  GSequenceIter *iter;
-  GESTrackObject *tckobj;
-  guint64 *start, *end;
-
-  GESTimelinePrivate *priv = timeline->priv;
-
-  for (iter = g_sequence_get_begin_iter (priv->tracksources);
-      !g_sequence_iter_is_end (iter); iter = g_sequence_iter_next (iter)) {
-    tckobj = GES_TRACK_OBJECT (g_sequence_get (iter));
-
-    start = g_hash_table_lookup (priv->by_start, tckobj);
-    end = g_hash_table_lookup (priv->by_end, tckobj);
-
-    *start = tckobj->start;
-    *end = tckobj->start + tckobj->duration;
-  }
-
-  g_sequence_sort (priv->starts_ends, (GCompareDataFunc) compare_uint64, NULL);
-  timeline_update_duration (timeline);
+  return timeline->priv->edit_depth > 0;
 }
 
+/* Timeline edition functions */
+
+/* Forgets about the last snap */
 static inline void
-sort_all (GESTimeline * timeline)
+init_snapping (MoveContext * mv_ctx)
 {
-  sort_track_objects (timeline);
-  resort_all_starts_ends (timeline);
+  mv_ctx->last_snaped1 = NULL;
+  mv_ctx->last_snaped2 = NULL;
+  mv_ctx->last_snap_ts = GST_CLOCK_TIME_NONE;
 }
 
-/* Timeline edition functions */
 static inline void
 init_movecontext (MoveContext * mv_ctx)
 {
@@ -688,9 +713,7 @@ init_movecontext (MoveContext * mv_ctx)
   mv_ctx->max_trim_pos = G_MAXUINT64;
   mv_ctx->min_move_layer = G_MAXUINT;
   mv_ctx->max_layer_prio = 0;
-  mv_ctx->last_snaped1 = NULL;
-  mv_ctx->last_snaped2 = NULL;
-  mv_ctx->last_snap_ts = NULL;
+  init_snapping (mv_ctx);
 }
 
 static inline void
@@ -704,52 +727,23 @@ clean_movecontext (MoveContext * mv_ctx)
 static void
 stop_tracking_for_snapping (GESTimeline * timeline, GESTrackObject * tckobj)
 {
-  guint64 *start, *end;
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter_start, *iter_end, *tckobj_iter;
-
-
-  start = g_hash_table_lookup (priv->by_start, tckobj);
-  end = g_hash_table_lookup (priv->by_end, tckobj);
 
-  iter_start = lookup_pointer_uint (priv->starts_ends, start);
-  iter_end = lookup_pointer_uint (priv->starts_ends, end);
-  tckobj_iter = g_sequence_lookup (timeline->priv->tracksources, tckobj,
-      (GCompareDataFunc) objects_start_compare, NULL);
-
-  g_hash_table_remove (priv->by_start, tckobj);
-  g_hash_table_remove (priv->by_end, tckobj);
-  g_hash_table_remove (priv->by_object, end);
-  g_hash_table_remove (priv->by_object, start);
-
-  g_sequence_remove (iter_start);
-  g_sequence_remove (iter_end);
-  g_sequence_remove (tckobj_iter);
+  g_hash_table_remove (priv->edited_sources, tckobj);
+  snap_index_remove (priv->snap_index, tckobj);
+  interval_tree_remove (priv->tracksources, tckobj);
   timeline_update_duration (timeline);
 }
 
 static void
 start_tracking_track_obj (GESTimeline * timeline, GESTrackObject * tckobj)
 {
-  guint64 *pstart, *pend;
   GESTimelinePrivate *priv = timeline->priv;
+  guint64 start = tckobj->start, end = tckobj->start + tckobj->duration;
 
-  pstart = g_malloc (sizeof (guint64));
-  pend = g_malloc (sizeof (guint64));
-  *pstart = tckobj->start;
-  *pend = *pstart + tckobj->duration;
-
-  g_sequence_insert_sorted (priv->starts_ends, pstart,
-      (GCompareDataFunc) compare_uint64, NULL);
-  g_sequence_insert_sorted (priv->starts_ends, pend,
-      (GCompareDataFunc) compare_uint64, NULL);
-  g_sequence_insert_sorted (priv->tracksources, g_object_ref (tckobj),
-      (GCompareDataFunc) objects_start_compare, NULL);
-
-  g_hash_table_insert (priv->by_start, tckobj, pstart);
-  g_hash_table_insert (priv->by_object, pstart, tckobj);
-  g_hash_table_insert (priv->by_end, tckobj, pend);
-  g_hash_table_insert (priv->by_object, pend, tckobj);
+  interval_tree_insert (priv->tracksources, g_object_ref (tckobj), start, end,
+      tckobj->priority);
+  snap_index_add (priv->snap_index, tckobj, start, end);
 
   timeline->priv->movecontext.needs_move_ctx = TRUE;
 
@@ -758,136 +752,156 @@ start_tracking_track_obj (GESTimeline * timeline, GESTrackObject * tckobj)
 
 static inline void
 ges_timeline_emit_snappig (GESTimeline * timeline, GESTrackObject * obj1,
-    guint64 * timecode)
+    GESTrackObject * obj2, GstClockTime timecode)
 {
-  GESTrackObject *obj2;
   MoveContext *mv_ctx = &timeline->priv->movecontext;
-  GstClockTime snap_time = timecode ? *timecode : 0;
-  GstClockTime last_snap_ts = mv_ctx->last_snap_ts ?
-      *mv_ctx->last_snap_ts : GST_CLOCK_TIME_NONE;
 
   GST_DEBUG_OBJECT (timeline, "Distance: %" GST_TIME_FORMAT " snapping at %"
       GST_TIME_FORMAT, GST_TIME_ARGS (timeline->priv->snapping_distance),
-      GST_TIME_ARGS (snap_time));
+      GST_TIME_ARGS (timecode));
 
-  if (timecode == NULL) {
-    if (mv_ctx->last_snaped1 != NULL && mv_ctx->last_snaped2 != NULL) {
-      g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
-          mv_ctx->last_snaped1, mv_ctx->last_snaped2, last_snap_ts);
+  /* Nothing changed */
+  if (obj2 != NULL && mv_ctx->last_snap_ts == timecode)
+    return;
 
-      /* We then need to recalculate the moving context */
-      timeline->priv->movecontext.needs_move_ctx = TRUE;
-    }
+  if (mv_ctx->last_snaped1 != NULL && mv_ctx->last_snaped2 != NULL) {
+    g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
+        mv_ctx->last_snaped1, mv_ctx->last_snaped2, mv_ctx->last_snap_ts);
 
-    return;
+    /* We then need to recalculate the moving context */
+    if (obj2 == NULL)
+      mv_ctx->needs_move_ctx = TRUE;
   }
 
-  obj2 = g_hash_table_lookup (timeline->priv->by_object, timecode);
+  init_snapping (mv_ctx);
 
-  if (last_snap_ts != *timecode) {
-    g_signal_emit (timeline, ges_timeline_signals[SNAPING_ENDED], 0,
-        mv_ctx->last_snaped1, mv_ctx->last_snaped2, (last_snap_ts));
+  /* Snapping on the frame grid is not snapping with an object */
+  if (obj2 == NULL || !GST_CLOCK_TIME_IS_VALID (timecode))
+    return;
 
-    /* We want the snap start signal to be emited anyway */
-    mv_ctx->last_snap_ts = NULL;
-  }
+  mv_ctx->last_snaped1 = obj1;
+  mv_ctx->last_snaped2 = obj2;
+  mv_ctx->last_snap_ts = timecode;
 
-  if (mv_ctx->last_snap_ts == NULL) {
+  g_signal_emit (timeline, ges_timeline_signals[SNAPING_STARTED], 0,
+      obj1, obj2, timecode);
+}
 
-    mv_ctx->last_snaped1 = obj1;
-    mv_ctx->last_snaped2 = obj2;
-    mv_ctx->last_snap_ts = timecode;
+typedef struct
+{
+  GESTimeline *timeline;
+  GESTimelineObject *tlobj;
+} SnapFilterData;
 
-    g_signal_emit (timeline, ges_timeline_signals[SNAPING_STARTED], 0,
-        obj1, obj2, *timecode);
+/* Whether the edges of @tckobj are snapping targets */
+static gboolean
+snap_filter (GESTrackObject * tckobj, SnapFilterData * data)
+{
+  GESTimelineLayer *layer;
+  gboolean ret;
+  GESTimelinePrivate *priv = data->timeline->priv;
+  GESTimelineObject *tlobj = ges_track_object_get_timeline_object (tckobj);
 
-  }
+  /* Never snap an object with itself */
+  if (tlobj == data->tlobj)
+    return FALSE;
+
+  if (priv->snapping_tracks && !g_list_find (priv->snapping_tracks,
+          ges_track_object_get_track (tckobj)))
+    return FALSE;
+
+  if (priv->snapping_layers == NULL)
+    return TRUE;
+
+  layer = tlobj ? ges_timeline_object_get_layer (tlobj) : NULL;
+  if (layer == NULL)
+    return FALSE;
+
+  ret = g_list_find (priv->snapping_layers, layer) != NULL;
+  g_object_unref (layer);
+
+  return ret;
 }
 
-static guint64 *
+/* Looks for the position @timecode should snap to, if any. The edges of the
+ * TrackSource-s are found in the snap index so that only the edges within
+ * the snapping distance are visited.
+ *
+ * Returns: %TRUE if @timecode snaps, in which case @snapped is set to the
+ * position to snap to and @snapped_obj to the object it snaps with, or %NULL
+ * if it snaps on the frame grid */
+static gboolean
 ges_timeline_snap_position (GESTimeline * timeline, GESTrackObject * trackobj,
-    guint64 * current, guint64 timecode, gboolean emit)
+    guint64 timecode, guint64 * snapped, GESTrackObject ** snapped_obj,
+    gboolean emit)
 {
+  SnapFilterData data;
   GESTimelinePrivate *priv = timeline->priv;
-  GSequenceIter *iter, *prev_iter, *nxt_iter;
-  GESTrackObject *tmp_tckobj;
-  GESTimelineObject *tmp_tlobj, *tlobj;
-
-  GstClockTime *last_snap_ts = priv->movecontext.last_snap_ts;
-  guint64 snap_distance = timeline->priv->snapping_distance;
-  guint64 *prev_tc, *next_tc, *ret = NULL, off = G_MAXUINT64, off1 =
-      G_MAXUINT64;
+  MoveContext *mv_ctx = &priv->movecontext;
+  guint64 snap_distance = priv->snapping_distance;
+  guint64 off, ret = GST_CLOCK_TIME_NONE;
+  GESTrackObject *obj2 = NULL;
 
   /* Avoid useless calculations */
   if (snap_distance == 0)
-    return NULL;
+    return FALSE;
+
+  flush_edited_sources (timeline);
 
   /* If we can just resnap as last snap... do it */
-  if (last_snap_ts) {
-    off = timecode > *last_snap_ts ?
-        timecode - *last_snap_ts : *last_snap_ts - timecode;
+  if (GST_CLOCK_TIME_IS_VALID (mv_ctx->last_snap_ts)) {
+    off = timecode > mv_ctx->last_snap_ts ?
+        timecode - mv_ctx->last_snap_ts : mv_ctx->last_snap_ts - timecode;
     if (off <= snap_distance) {
-      ret = last_snap_ts;
+      ret = mv_ctx->last_snap_ts;
+      obj2 = mv_ctx->last_snaped2;
       goto done;
     }
   }
 
-  tlobj = ges_track_object_get_timeline_object (trackobj);
-
-  iter = g_sequence_search (priv->starts_ends, &timecode,
-      (GCompareDataFunc) compare_uint64, NULL);
-
-  /* Getting the next/previous  values, and use the closest one if any "respects"
-   * the snap_distance value */
-  nxt_iter = iter;
-  while (!g_sequence_iter_is_end (nxt_iter)) {
-    next_tc = g_sequence_get (iter);
-    tmp_tckobj = g_hash_table_lookup (timeline->priv->by_object, next_tc);
-    tmp_tlobj = ges_track_object_get_timeline_object (tmp_tckobj);
-
-    off = timecode > *next_tc ? timecode - *next_tc : *next_tc - timecode;
-    if (next_tc != current && off <= snap_distance && tlobj != tmp_tlobj) {
-
-      ret = next_tc;
-      break;
-    }
-
-    nxt_iter = g_sequence_iter_next (nxt_iter);
-  }
+  data.timeline = timeline;
+  data.tlobj = ges_track_object_get_timeline_object (trackobj);
 
-  if (ret == NULL)
+  if (snap_index_find_closest (priv->snap_index, timecode, snap_distance,
+          (SnapIndexFilter) snap_filter, &data, &ret, (gpointer *) & obj2))
+    off = timecode > ret ? timecode - ret : ret - timecode;
+  else
     off = G_MAXUINT64;
 
-  prev_iter = g_sequence_iter_prev (iter);
-  while (!g_sequence_iter_is_begin (prev_iter)) {
-    prev_tc = g_sequence_get (prev_iter);
-    tmp_tckobj = g_hash_table_lookup (timeline->priv->by_object, prev_tc);
-    tmp_tlobj = ges_track_object_get_timeline_object (tmp_tckobj);
+  /* Snap on the closest frame if it is closer than any edge */
+  if (priv->snapping_fps_n > 0) {
+    guint64 frame, frame_ts, frame_off;
 
-    off1 = timecode > *prev_tc ? timecode - *prev_tc : *prev_tc - timecode;
-    if (prev_tc != current && off1 < off && off1 <= snap_distance &&
-        tlobj != tmp_tlobj) {
-      ret = prev_tc;
+    frame = gst_util_uint64_scale_round (timecode, priv->snapping_fps_n,
+        priv->snapping_fps_d * GST_SECOND);
+    frame_ts = gst_util_uint64_scale_round (frame,
+        priv->snapping_fps_d * GST_SECOND, priv->snapping_fps_n);
+    frame_off = timecode > frame_ts ? timecode - frame_ts : frame_ts - timecode;
 
-      break;
+    if (frame_off <= snap_distance && frame_off < off) {
+      ret = frame_ts;
+      obj2 = NULL;
     }
-
-    prev_iter = g_sequence_iter_prev (prev_iter);
   }
 
 done:
   /* We emit the snapping signal only if we snapped with a different value
    * than the current one */
   if (emit) {
-    GstClockTime snap_time = ret ? *ret : GST_CLOCK_TIME_NONE;
-
-    ges_timeline_emit_snappig (timeline, trackobj, ret);
+    ges_timeline_emit_snappig (timeline, trackobj, obj2, ret);
 
     GST_DEBUG_OBJECT (timeline, "Snaping at %" GST_TIME_FORMAT,
-        GST_TIME_ARGS (snap_time));
+        GST_TIME_ARGS (ret));
   }
 
-  return ret;
+  if (!GST_CLOCK_TIME_IS_VALID (ret))
+    return FALSE;
+
+  *snapped = ret;
+  if (snapped_obj)
+    *snapped_obj = obj2;
+
+  return TRUE;
 }
 
 static inline GESTimelineObject *
@@ -925,41 +939,29 @@ static gboolean
 ges_move_context_set_objects (GESTimeline * timeline, GESTrackObject * obj,
     GESEdge edge)
 {
-  GSequenceIter *iter, *tckobj_iter;
+  GList *objects, *tmp;
   guint64 start, end, tmpend;
   GESTrackObject *tmptckobj;
 
   MoveContext *mv_ctx = &timeline->priv->movecontext;
 
-  tckobj_iter = g_sequence_lookup (timeline->priv->tracksources, obj,
-      (GCompareDataFunc) objects_start_compare, NULL);
-
   switch (edge) {
     case GES_EDGE_START:
       /* set it properly int the context of "trimming" */
       mv_ctx->max_trim_pos = 0;
       start = obj->start;
 
-      if (g_sequence_iter_is_begin (tckobj_iter))
-        break;
-
-      /* Look for the objects */
-      for (iter = g_sequence_iter_prev (tckobj_iter);
-          iter && !g_sequence_iter_is_end (iter);
-          iter = g_sequence_iter_prev (iter)) {
-
-        tmptckobj = GES_TRACK_OBJECT (g_sequence_get (iter));
-        tmpend = tmptckobj->start + tmptckobj->duration;
-
-        if (tmpend <= start) {
-          mv_ctx->max_trim_pos = MAX (mv_ctx->max_trim_pos, tmptckobj->start);
-          mv_ctx->moving_tckobjs =
-              g_list_prepend (mv_ctx->moving_tckobjs, tmptckobj);
-        }
+      /* Look for the objects ending before */
+      objects = interval_tree_get_ending_before (timeline->priv->tracksources,
+          start);
+      objects = g_list_remove (objects, obj);
 
-        if (g_sequence_iter_is_begin (iter))
-          break;
+      for (tmp = objects; tmp; tmp = tmp->next) {
+        tmptckobj = GES_TRACK_OBJECT (tmp->data);
+        mv_ctx->max_trim_pos = MAX (mv_ctx->max_trim_pos, tmptckobj->start);
       }
+
+      mv_ctx->moving_tckobjs = g_list_concat (objects, mv_ctx->moving_tckobjs);
       break;
 
     case GES_EDGE_END:
@@ -970,18 +972,18 @@ ges_move_context_set_objects (GESTimeline * timeline, GESTrackObject * obj,
       mv_ctx->max_trim_pos = G_MAXUINT64;
 
       /* Look for folowing objects */
-      for (iter = g_sequence_iter_next (tckobj_iter);
-          iter && !g_sequence_iter_is_end (iter);
-          iter = g_sequence_iter_next (iter)) {
-        tmptckobj = GES_TRACK_OBJECT (g_sequence_get (iter));
-
-        if (tmptckobj->start >= end) {
-          tmpend = tmptckobj->start + tmptckobj->duration;
-          mv_ctx->max_trim_pos = MIN (mv_ctx->max_trim_pos, tmpend);
-          mv_ctx->moving_tckobjs =
-              g_list_prepend (mv_ctx->moving_tckobjs, tmptckobj);
-        }
+      objects = interval_tree_get_starting_after (timeline->priv->tracksources,
+          end);
+      objects = g_list_remove (objects, obj);
+
+      for (tmp = objects; tmp; tmp = tmp->next) {
+        tmptckobj = GES_TRACK_OBJECT (tmp->data);
+        tmpend = tmptckobj->start + tmptckobj->duration;
+        mv_ctx->max_trim_pos = MIN (mv_ctx->max_trim_pos, tmpend);
       }
+
+      mv_ctx->moving_tckobjs = g_list_concat (g_list_reverse (objects),
+          mv_ctx->moving_tckobjs);
       break;
     default:
       GST_DEBUG ("Edge type %d no supported", edge);
@@ -998,6 +1000,8 @@ ges_timeline_set_moving_context (GESTimeline * timeline, GESTrackObject * obj,
   MoveContext *mv_ctx = &timeline->priv->movecontext;
   GESTimelineObject *tlobj = ges_track_object_get_timeline_object (obj);
 
+  flush_edited_sources (timeline);
+
   /* Still in the same mv_ctx */
   if ((mv_ctx->obj == tlobj && mv_ctx->mode == mode &&
           mv_ctx->edge == edge && !mv_ctx->needs_move_ctx)) {
@@ -1037,7 +1041,7 @@ gboolean
 ges_timeline_trim_object_simple (GESTimeline * timeline, GESTrackObject * obj,
     GList * layers, GESEdge edge, guint64 position, gboolean snapping)
 {
-  guint64 nstart, start, inpoint, duration, max_duration, *snapped, *cur;
+  guint64 nstart, start, inpoint, duration, max_duration;
   gboolean ret = TRUE;
   gint64 real_dur;
 
@@ -1053,12 +1057,8 @@ ges_timeline_trim_object_simple (GESTimeline * timeline, GESTrackObject * obj,
       duration = obj->duration;
 
       if (snapping) {
-        cur = g_hash_table_lookup (timeline->priv->by_start, obj);
-
-        snapped = ges_timeline_snap_position (timeline, obj, cur, position,
+        ges_timeline_snap_position (timeline, obj, position, &position, NULL,
             TRUE);
-        if (snapped)
-          position = *snapped;
       }
 
       nstart = position;
@@ -1079,10 +1079,8 @@ ges_timeline_trim_object_simple (GESTimeline * timeline, GESTrackObject * obj,
       break;
     case GES_EDGE_END:
     {
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      ges_timeline_snap_position (timeline, obj, position, &position, NULL,
+          TRUE);
 
       /* Calculate new values */
       real_dur = position - start;
@@ -1107,7 +1105,7 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackObject * obj,
   GList *tmp, *moved_tlobjs = NULL;
   GESTrackObject *tckobj;
   GESTimelineObject *tlobj;
-  guint64 duration, new_start, *snapped, *cur;
+  guint64 duration, new_start;
   gint64 offset;
 
   MoveContext *mv_ctx = &timeline->priv->movecontext;
@@ -1122,10 +1120,8 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackObject * obj,
     case GES_EDGE_NONE:
       GST_DEBUG ("Simply rippling");
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      ges_timeline_snap_position (timeline, obj, position, &position, NULL,
+          TRUE);
 
       offset = position - obj->start;
 
@@ -1154,10 +1150,8 @@ timeline_ripple_object (GESTimeline * timeline, GESTrackObject * obj,
     case GES_EDGE_END:
       GST_DEBUG ("Rippling end");
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      ges_timeline_snap_position (timeline, obj, position, &position, NULL,
+          TRUE);
 
       duration = obj->duration;
 
@@ -1245,7 +1239,7 @@ timeline_roll_object (GESTimeline * timeline, GESTrackObject * obj,
     GList * layers, GESEdge edge, guint64 position)
 {
   MoveContext *mv_ctx = &timeline->priv->movecontext;
-  guint64 start, duration, end, tmpstart, tmpduration, tmpend, *snapped, *cur;
+  guint64 start, duration, end, tmpstart, tmpduration, tmpend;
   gboolean ret = TRUE;
   GList *tmp;
 
@@ -1269,10 +1263,8 @@ timeline_roll_object (GESTimeline * timeline, GESTrackObject * obj,
       if (position < mv_ctx->max_trim_pos || position > end)
         goto error;
 
-      cur = g_hash_table_lookup (timeline->priv->by_start, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      ges_timeline_snap_position (timeline, obj, position, &position, NULL,
+          TRUE);
 
       ret &=
           ges_timeline_trim_object_simple (timeline, obj, layers,
@@ -1307,10 +1299,8 @@ timeline_roll_object (GESTimeline * timeline, GESTrackObject * obj,
 
       end = obj->start + obj->duration;
 
-      cur = g_hash_table_lookup (timeline->priv->by_end, obj);
-      snapped = ges_timeline_snap_position (timeline, obj, cur, position, TRUE);
-      if (snapped)
-        position = *snapped;
+      ges_timeline_snap_position (timeline, obj, position, &position, NULL,
+          TRUE);
 
       ret &= ges_timeline_trim_object_simple (timeline, obj, NULL, GES_EDGE_END,
           position, FALSE);
@@ -1373,36 +1363,38 @@ gboolean
 ges_timeline_move_object_simple (GESTimeline * timeline,
     GESTrackObject * object, GList * layers, GESEdge edge, guint64 position)
 {
-  guint64 *snap_end, *snap_st, *cur, off1, off2, end;
+  guint64 snap_end, snap_st, off1, off2, end;
+  GESTrackObject *obj_end = NULL, *obj_st = NULL;
+  gboolean snapped_end, snapped_st;
 
   end = position + object->duration;
-  cur = g_hash_table_lookup (timeline->priv->by_end, object);
 
   GST_DEBUG_OBJECT (timeline, "Moving to %" GST_TIME_FORMAT " (end %"
       GST_TIME_FORMAT ")", GST_TIME_ARGS (position), GST_TIME_ARGS (end));
 
-  snap_end = ges_timeline_snap_position (timeline, object, cur, end, FALSE);
-  if (snap_end)
-    off1 = end > *snap_end ? end - *snap_end : *snap_end - end;
+  snapped_end = ges_timeline_snap_position (timeline, object, end, &snap_end,
+      &obj_end, FALSE);
+  if (snapped_end)
+    off1 = end > snap_end ? end - snap_end : snap_end - end;
   else
     off1 = G_MAXUINT64;
 
-  cur = g_hash_table_lookup (timeline->priv->by_start, object);
-  snap_st = ges_timeline_snap_position (timeline, object, cur, position, FALSE);
-  if (snap_st)
-    off2 = position > *snap_st ? position - *snap_st : *snap_st - position;
+  snapped_st = ges_timeline_snap_position (timeline, object, position,
+      &snap_st, &obj_st, FALSE);
+  if (snapped_st)
+    off2 = position > snap_st ? position - snap_st : snap_st - position;
   else
     off2 = G_MAXUINT64;
 
   /* In the case we could snap on both sides, we snap on the end */
-  if (snap_end && off1 <= off2) {
-    position = position + *snap_end - end;
-    ges_timeline_emit_snappig (timeline, object, snap_end);
-  } else if (snap_st) {
-    position = position + *snap_st - position;
-    ges_timeline_emit_snappig (timeline, object, snap_st);
+  if (snapped_end && off1 <= off2) {
+    position = position + snap_end - end;
+    ges_timeline_emit_snappig (timeline, object, obj_end, snap_end);
+  } else if (snapped_st) {
+    position = snap_st;
+    ges_timeline_emit_snappig (timeline, object, obj_st, snap_st);
   } else
-    ges_timeline_emit_snappig (timeline, object, NULL);
+    ges_timeline_emit_snappig (timeline, object, NULL, GST_CLOCK_TIME_NONE);
 
 
   ges_track_object_set_start (object, position);
@@ -1526,125 +1518,144 @@ do_async_done (GESTimeline * timeline)
 
 /* Callbacks  */
 static void
-discoverer_finished_cb (GstDiscoverer * discoverer, GESTimeline * timeline)
-{
-  do_async_done (timeline);
-}
-
-static void
-discoverer_discovered_cb (GstDiscoverer * discoverer,
-    GstDiscovererInfo * info, GError * err, GESTimeline * timeline)
+discoverer_finished_cb (GstDiscoverer * discoverer, DiscovererWorker * worker)
 {
-  GList *tmp;
-  GList *stream_list;
-  GESTimelineObject *tlobj;
-  GESTrackType tfs_supportedformats;
-
-  gboolean found = FALSE;
-  gboolean is_image = FALSE;
-  GESTimelineFileSource *tfs = NULL;
-  GESTimelinePrivate *priv = timeline->priv;
-  const gchar *uri = gst_discoverer_info_get_uri (info);
+  guint i;
+  gboolean done = TRUE;
+  GESTimeline *timeline = worker->timeline;
 
+  /* We are done only once all the discoverers are */
   GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-
-  /* Find corresponding TimelineFileSource in the sources */
-  for (tmp = priv->pendingobjects; tmp; tmp = tmp->next) {
-    tfs = (GESTimelineFileSource *) tmp->data;
-
-    if (!g_strcmp0 (ges_timeline_filesource_get_uri (tfs), uri)) {
-      found = TRUE;
+  for (i = 0; i < timeline->priv->discoverers->len; i++) {
+    if (((DiscovererWorker *) g_ptr_array_index (timeline->priv->discoverers,
+                i))->pending) {
+      done = FALSE;
       break;
     }
   }
+  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
 
-  if (!found) {
-    GST_WARNING ("Discovered %s, that seems not to be in the list of sources"
-        "to discover", uri);
-    GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
-    return;
-  }
-
-  if (err) {
-    GError *propagate_error = NULL;
-
-    priv->pendingobjects = g_list_delete_link (priv->pendingobjects, tmp);
-    GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
-    GST_WARNING ("Error while discovering %s: %s", uri, err->message);
-
-    g_propagate_error (&propagate_error, err);
-    g_signal_emit (timeline, ges_timeline_signals[DISCOVERY_ERROR], 0, tfs,
-        propagate_error);
-
-    return;
+  if (done) {
+    discovery_cache_save ();
+    do_async_done (timeline);
   }
+}
 
-  /* Everything went fine... let's do our job! */
-  GST_DEBUG ("Discovered uri %s", uri);
-
-  /* The timeline file source will be updated with discovered information
-   * so it needs to not be finalized during this process */
-  g_object_ref (tfs);
-
-  /* Remove object from list */
-  priv->pendingobjects = g_list_delete_link (priv->pendingobjects, tmp);
-  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
-
-  /* FIXME : Handle errors in discovery */
-  stream_list = gst_discoverer_info_get_stream_list (info);
+/* Updates @tfs from the discovered @entry and adds it to the tracks */
+static void
+set_discovered_info (GESTimeline * timeline, GESTimelineFileSource * tfs,
+    DiscoveryCacheEntry * entry)
+{
+  GESTimelineObject *tlobj = GES_TIMELINE_OBJECT (tfs);
+  GESTrackType tfs_supportedformats =
+      ges_timeline_filesource_get_supported_formats (tfs);
+  gboolean is_image = FALSE;
+  GstCaps *caps;
 
-  tfs_supportedformats = ges_timeline_filesource_get_supported_formats (tfs);
-  if (tfs_supportedformats != GES_TRACK_TYPE_UNKNOWN)
-    goto check_image;
+  /* Kept for the smart render planning */
+  caps = discovery_cache_entry_get_caps (entry);
+  timeline_filesource_set_stream_caps (tfs, caps);
+  gst_caps_unref (caps);
 
   /* Update timelinefilesource properties based on info */
-  for (tmp = stream_list; tmp; tmp = tmp->next) {
-    GstDiscovererStreamInfo *sinf = (GstDiscovererStreamInfo *) tmp->data;
-
-    if (GST_IS_DISCOVERER_AUDIO_INFO (sinf)) {
+  if (tfs_supportedformats == GES_TRACK_TYPE_UNKNOWN) {
+    if (entry->has_audio)
       tfs_supportedformats |= GES_TRACK_TYPE_AUDIO;
-      ges_timeline_filesource_set_supported_formats (tfs, tfs_supportedformats);
-    } else if (GST_IS_DISCOVERER_VIDEO_INFO (sinf)) {
+    if (entry->has_video)
       tfs_supportedformats |= GES_TRACK_TYPE_VIDEO;
-      ges_timeline_filesource_set_supported_formats (tfs, tfs_supportedformats);
-      if (gst_discoverer_video_info_is_image ((GstDiscovererVideoInfo *)
-              sinf)) {
-        tfs_supportedformats |= GES_TRACK_TYPE_AUDIO;
-        ges_timeline_filesource_set_supported_formats (tfs,
-            tfs_supportedformats);
-        is_image = TRUE;
-      }
+    if (entry->is_image) {
+      tfs_supportedformats |= GES_TRACK_TYPE_AUDIO;
+      is_image = TRUE;
     }
-  }
-
-  if (stream_list)
-    gst_discoverer_stream_info_list_free (stream_list);
 
-check_image:
+    if (tfs_supportedformats != GES_TRACK_TYPE_UNKNOWN)
+      ges_timeline_filesource_set_supported_formats (tfs,
+          tfs_supportedformats);
+  }
 
-  tlobj = GES_TIMELINE_OBJECT (tfs);
   if (is_image) {
     /* don't set max-duration on still images */
     g_object_set (tfs, "is_image", (gboolean) TRUE, NULL);
   } else {
-    GstClockTime file_duration, tlobj_max_duration;
+    GstClockTime tlobj_max_duration;
 
     /* Properly set duration informations from the discovery */
-    file_duration = gst_discoverer_info_get_duration (info);
     tlobj_max_duration = ges_timeline_object_get_max_duration (tlobj);
 
     if (tlobj_max_duration == G_MAXUINT64)
-      ges_timeline_object_set_max_duration (tlobj, file_duration);
+      ges_timeline_object_set_max_duration (tlobj, entry->duration);
 
     if (GST_CLOCK_TIME_IS_VALID (tlobj->duration) == FALSE)
-      ges_timeline_object_set_duration (tlobj, file_duration);
+      ges_timeline_object_set_duration (tlobj, entry->duration);
   }
 
   /* Continue the processing on tfs */
   add_object_to_tracks (timeline, tlobj);
+}
+
+static void
+discoverer_discovered_cb (GstDiscoverer * discoverer,
+    GstDiscovererInfo * info, GError * err, DiscovererWorker * worker)
+{
+  gchar *key;
+  GList *tmp, *tfss = NULL;
+  DiscoveryCacheEntry *entry;
+  GESTimeline *timeline = worker->timeline;
+  GESTimelinePrivate *priv = timeline->priv;
+  const gchar *uri = gst_discoverer_info_get_uri (info);
 
-  /* Remove the ref as the timeline file source is no longer needed here */
-  g_object_unref (tfs);
+  GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+  worker->pending--;
+
+  /* Get all the TimelineFileSource-s waiting for that uri */
+  if (!g_hash_table_lookup_extended (priv->pendingobjects, uri,
+          (gpointer *) & key, (gpointer *) & tfss)) {
+    GST_DEBUG ("Discovered %s, but no source is waiting for it anymore", uri);
+    GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+    return;
+  }
+
+  g_hash_table_steal (priv->pendingobjects, uri);
+  g_free (key);
+
+  /* The timeline file sources will be updated with discovered information
+   * so they need to not be finalized during this process */
+  g_list_foreach (tfss, (GFunc) g_object_ref, NULL);
+  GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+  if (err) {
+    GstCaps *caps = gst_caps_new_empty ();
+
+    GST_WARNING ("Error while discovering %s: %s", uri, err->message);
+
+    /* Nothing of those files can be passed through when smart rendering */
+    for (tmp = tfss; tmp; tmp = tmp->next) {
+      timeline_filesource_set_stream_caps (tmp->data, caps);
+      g_signal_emit (timeline, ges_timeline_signals[DISCOVERY_ERROR], 0,
+          tmp->data, err);
+    }
+    gst_caps_unref (caps);
+
+    goto done;
+  }
+
+  /* Everything went fine... let's do our job! */
+  GST_DEBUG ("Discovered uri %s for %d sources", uri, g_list_length (tfss));
+
+  entry = discovery_cache_entry_new_from_info (info);
+  /* Timeouts and the like leave partial results which must not be reused */
+  if (gst_discoverer_info_get_result (info) == GST_DISCOVERER_OK)
+    discovery_cache_store (uri, entry);
+
+  /* Continue the processing on every tfs */
+  for (tmp = tfss; tmp; tmp = tmp->next)
+    set_discovered_info (timeline, tmp->data, entry);
+
+  discovery_cache_entry_free (entry);
+
+done:
+  /* Remove the refs as the timeline file sources are no longer needed here */
+  g_list_free_full (tfss, g_object_unref);
 }
 
 static void
@@ -1666,6 +1677,10 @@ layer_object_added_cb (GESTimelineLayer * layer, GESTimelineObject * object,
         ges_timeline_filesource_get_supported_formats (tfs);
     guint64 tfs_maxdur = ges_timeline_filesource_get_max_duration (tfs);
     const gchar *tfs_uri;
+    DiscovererWorker *worker;
+    DiscoveryCacheEntry *entry;
+    GList *tfss;
+    gchar *key;
 
     /* Send the filesource to the discoverer if:
      * * it doesn't have specified supported formats
@@ -1674,20 +1689,45 @@ layer_object_added_cb (GESTimelineLayer * layer, GESTimelineObject * object,
 
     if (tfs_supportedformats == GES_TRACK_TYPE_UNKNOWN ||
         tfs_maxdur == GST_CLOCK_TIME_NONE || object->duration == 0) {
-      GST_LOG ("Incomplete TimelineFileSource, discovering it");
       tfs_uri = ges_timeline_filesource_get_uri (tfs);
 
-      GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-      timeline->priv->pendingobjects =
-          g_list_append (timeline->priv->pendingobjects, object);
-      GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+      /* No need to discover files we already know */
+      entry = discovery_cache_lookup (tfs_uri);
+      if (entry) {
+        GST_LOG ("Incomplete TimelineFileSource, using cached information");
+        set_discovered_info (timeline, tfs, entry);
+        discovery_cache_entry_free (entry);
 
-      gst_discoverer_discover_uri_async (timeline->priv->discoverer, tfs_uri);
-    } else
-      add_object_to_tracks (timeline, object);
-  } else {
-    add_object_to_tracks (timeline, object);
-  }
+        return;
+      }
+
+      GST_LOG ("Incomplete TimelineFileSource, discovering it");
+
+      GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
+      if (g_hash_table_lookup_extended (timeline->priv->pendingobjects,
+              tfs_uri, (gpointer *) & key, (gpointer *) & tfss)) {
+        /* Already being discovered, just wait for the result */
+        g_hash_table_steal (timeline->priv->pendingobjects, tfs_uri);
+        g_hash_table_insert (timeline->priv->pendingobjects, key,
+            g_list_prepend (tfss, object));
+        GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+        return;
+      }
+
+      g_hash_table_insert (timeline->priv->pendingobjects, g_strdup (tfs_uri),
+          g_list_prepend (NULL, object));
+
+      worker = get_discoverer_worker (timeline);
+      worker->pending++;
+      GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
+
+      gst_discoverer_discover_uri_async (worker->discoverer, tfs_uri);
+    } else
+      add_object_to_tracks (timeline, object);
+  } else {
+    add_object_to_tracks (timeline, object);
+  }
 
   GST_DEBUG ("done");
 }
@@ -1740,9 +1780,20 @@ layer_object_removed_cb (GESTimelineLayer * layer, GESTimelineObject * object,
    * it no longer needs to be discovered so remove it from the pendingobjects
    * list if it belongs to this layer */
   if (GES_IS_TIMELINE_FILE_SOURCE (object)) {
+    gchar *key;
+    GList *tfss;
+    const gchar *tfs_uri =
+        ges_timeline_filesource_get_uri (GES_TIMELINE_FILE_SOURCE (object));
+
     GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-    timeline->priv->pendingobjects =
-        g_list_remove_all (timeline->priv->pendingobjects, object);
+    if (g_hash_table_lookup_extended (timeline->priv->pendingobjects,
+            tfs_uri, (gpointer *) & key, (gpointer *) & tfss)) {
+      /* The uri stays pending until its discovery is over, even if no
+       * source waits for it anymore */
+      g_hash_table_steal (timeline->priv->pendingobjects, tfs_uri);
+      g_hash_table_insert (timeline->priv->pendingobjects, key,
+          g_list_remove_all (tfss, object));
+    }
     GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
   }
 
@@ -1753,9 +1804,14 @@ static void
 trackobj_start_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
 {
-  sort_track_objects (timeline);
-  sort_starts_ends_start (timeline, child);
-  sort_starts_ends_end (timeline, child);
+  /* Reindexed once the edit is commited */
+  if (timeline->priv->edit_depth > 0) {
+    g_hash_table_insert (timeline->priv->edited_sources, child, child);
+    return;
+  }
+
+  update_track_source (timeline, child);
+  timeline_update_duration (timeline);
 
   /* If the timeline is set to snap objects together, we
    * are sure that all movement of TrackObject-s are done within
@@ -1770,7 +1826,13 @@ static void
 trackobj_duration_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTimeline * timeline)
 {
-  sort_starts_ends_end (timeline, child);
+  if (timeline->priv->edit_depth > 0) {
+    g_hash_table_insert (timeline->priv->edited_sources, child, child);
+    return;
+  }
+
+  update_track_source (timeline, child);
+  timeline_update_duration (timeline);
 
   /* If the timeline is set to snap objects together, we
    * are sure that all movement of TrackObject-s are done within
@@ -1803,9 +1865,9 @@ track_object_removed_cb (GESTrack * track, GESTrackObject * object,
   /* We only work with sources */
   if (GES_IS_TRACK_SOURCE (object)) {
     g_signal_handlers_disconnect_by_func (object, trackobj_start_changed_cb,
-        NULL);
+        timeline);
     g_signal_handlers_disconnect_by_func (object, trackobj_duration_changed_cb,
-        NULL);
+        timeline);
 
     /* Make sure to reinitialise the moving context next time */
     timeline->priv->movecontext.needs_move_ctx = TRUE;
@@ -1889,7 +1951,7 @@ ges_timeline_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       GES_TIMELINE_PENDINGOBJS_LOCK (timeline);
-      if (timeline->priv->pendingobjects) {
+      if (g_hash_table_size (timeline->priv->pendingobjects)) {
         GES_TIMELINE_PENDINGOBJS_UNLOCK (timeline);
         do_async_start (timeline);
         ret = GST_STATE_CHANGE_ASYNC;
@@ -2236,6 +2298,9 @@ ges_timeline_add_track (GESTimeline * timeline, GESTrack * track)
   /* Add the track to the list of tracks we track */
   priv->tracks = g_list_append (priv->tracks, tr_priv);
 
+  if (priv->edit_depth > 0)
+    track_begin_edit (tr_priv);
+
   /* Listen to pad-added/-removed */
   g_signal_connect (track, "pad-added", (GCallback) pad_added_cb, tr_priv);
   g_signal_connect (track, "pad-removed", (GCallback) pad_removed_cb, tr_priv);
@@ -2308,6 +2373,9 @@ ges_timeline_remove_track (GESTimeline * timeline, GESTrack * track)
   tr_priv = tmp->data;
   priv->tracks = g_list_remove (priv->tracks, tr_priv);
 
+  if (priv->edit_depth > 0)
+    track_commit_edit (tr_priv);
+
   ges_track_set_timeline (track, NULL);
 
   /* Remove ghost pad */
@@ -2479,3 +2547,632 @@ ges_timeline_get_duration (GESTimeline * timeline)
 
   return timeline->priv->duration;
 }
+
+/**
+ * ges_timeline_get_track_objects_in_range:
+ * @timeline: a #GESTimeline
+ * @start: The start of the range
+ * @end: The end of the range
+ *
+ * Gets the #GESTrackSource-s of @timeline which are playing at some point
+ * between @start and @end, that is to say the ones starting before @end and
+ * ending after @start, in any #GESTrack.
+ *
+ * Returns: (transfer full) (element-type GESTrackObject): The list of
+ * #GESTrackObject overlapping the range, sorted by start and priority. The
+ * caller should unref each object once done with them.
+ */
+GList *
+ges_timeline_get_track_objects_in_range (GESTimeline * timeline,
+    GstClockTime start, GstClockTime end)
+{
+  GList *ret;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+
+  flush_edited_sources (timeline);
+  ret = interval_tree_get_overlapping (timeline->priv->tracksources, start,
+      end);
+  g_list_foreach (ret, (GFunc) g_object_ref, NULL);
+
+  return ret;
+}
+
+/**
+ * ges_timeline_get_render_cut_points:
+ * @timeline: a #GESTimeline
+ * @n_ranges: the number of ranges to split @timeline into
+ * @n_points: (out): return location for the number of positions returned
+ *
+ * Splits @timeline into at most @n_ranges ranges of similar durations which
+ * can be rendered independently, for example in parallel by several
+ * #GESTimelinePipeline-s each seeking to its range. Each cut is moved to the
+ * closest edge of a #GESTrackSource within half a range, so that the ranges
+ * start at the beginning of a clip where possible rather than in the middle
+ * of one.
+ *
+ * Returns: (transfer full) (array length=n_points): the sorted boundaries of
+ * the ranges, starting with 0 and ending with the duration of @timeline. Free
+ * with g_free().
+ */
+guint64 *
+ges_timeline_get_render_cut_points (GESTimeline * timeline, guint n_ranges,
+    guint * n_points)
+{
+  guint i, n = 0;
+  guint64 *ret, ideal, snapped, duration, distance;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (n_ranges > 0, NULL);
+  g_return_val_if_fail (n_points != NULL, NULL);
+
+  flush_edited_sources (timeline);
+
+  duration = timeline->priv->duration;
+  distance = duration / n_ranges / 2;
+
+  ret = g_new (guint64, n_ranges + 1);
+  ret[n++] = 0;
+
+  for (i = 1; i < n_ranges; i++) {
+    ideal = gst_util_uint64_scale (duration, i, n_ranges);
+
+    if (!snap_index_find_closest (timeline->priv->snap_index, ideal, distance,
+            NULL, NULL, &snapped, NULL))
+      snapped = ideal;
+
+    /* Keep the cuts sorted and drop the empty ranges */
+    if (snapped > ret[n - 1] && snapped < duration)
+      ret[n++] = snapped;
+  }
+
+  if (duration > 0)
+    ret[n++] = duration;
+
+  *n_points = n;
+
+  return ret;
+}
+
+/* Thumbnail extraction
+ *
+ * Thumbnails are taken from a copy of the timeline, with only its video
+ * tracks, in a pipeline of its own ending in a fakesink. A worker thread
+ * keeps it PAUSED and does one accurate seek per timestamp, in increasing
+ * order so that the sources and their decoders stay in place between
+ * nearby timestamps, and takes the prerolled frame. It waits for the
+ * prerolls on the bus, so that an error or a stalled source stops the
+ * extraction instead of blocking it. The samples are then handed to the
+ * callback from idle sources of the default main context. */
+
+#define THUMBNAIL_TIMEOUT (15 * GST_SECOND)
+
+typedef struct
+{
+  GESTimeline *timeline;
+  GESTimeline *copy;            /* owned by the pipeline */
+  GstElement *pipeline;
+  GstElement *convert;
+  GstElement *sink;
+  GstClockTime duration;
+
+  GstClockTime *timestamps;
+  guint n_timestamps;
+
+  GESTimelineThumbnailCallback callback;
+  gpointer user_data;
+  GDestroyNotify notify;
+} ThumbnailJob;
+
+typedef struct
+{
+  ThumbnailJob *job;
+  GstClockTime timestamp;
+  GstSample *sample;
+} ThumbnailResult;
+
+static gint
+compare_timestamps (gconstpointer a, gconstpointer b, gpointer unused)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : ta > tb;
+}
+
+/* Calls @func from the default main context, even when it is owned by the
+ * calling thread, after the functions scheduled before it */
+static void
+invoke_in_default_context (GSourceFunc func, gpointer data,
+    GDestroyNotify notify)
+{
+  GSource *source = g_idle_source_new ();
+
+  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (source, func, data, notify);
+  g_source_attach (source, NULL);
+  g_source_unref (source);
+}
+
+static gboolean
+deliver_thumbnail (ThumbnailResult * result)
+{
+  ThumbnailJob *job = result->job;
+
+  job->callback (job->timeline, result->timestamp, result->sample,
+      job->user_data);
+
+  return FALSE;
+}
+
+static void
+thumbnail_result_free (ThumbnailResult * result)
+{
+  if (result->sample)
+    gst_sample_unref (result->sample);
+  g_slice_free (ThumbnailResult, result);
+}
+
+static gboolean
+finish_thumbnail_job (ThumbnailJob * job)
+{
+  if (job->notify)
+    job->notify (job->user_data);
+
+  gst_object_unref (job->pipeline);
+  gst_object_unref (job->timeline);
+  g_free (job->timestamps);
+  g_slice_free (ThumbnailJob, job);
+
+  return FALSE;
+}
+
+static void
+thumbnail_pad_added_cb (GESTimeline * copy, GstPad * pad, ThumbnailJob * job)
+{
+  GstPad *sinkpad = gst_element_get_static_pad (job->convert, "sink");
+
+  if (gst_pad_is_linked (sinkpad) ||
+      gst_pad_link (pad, sinkpad) != GST_PAD_LINK_OK)
+    GST_WARNING_OBJECT (copy, "Could not link %" GST_PTR_FORMAT, pad);
+
+  gst_object_unref (sinkpad);
+}
+
+/* TRUE if the frame of @sample is still the one displayed at @timestamp */
+static gboolean
+sample_covers (GstSample * sample, GstClockTime timestamp)
+{
+  GstBuffer *buffer = gst_sample_get_buffer (sample);
+  GstClockTime start;
+
+  if (!GST_BUFFER_PTS_IS_VALID (buffer) ||
+      !GST_BUFFER_DURATION_IS_VALID (buffer))
+    return FALSE;
+
+  start = gst_segment_to_stream_time (gst_sample_get_segment (sample),
+      GST_FORMAT_TIME, GST_BUFFER_PTS (buffer));
+
+  return GST_CLOCK_TIME_IS_VALID (start) && start <= timestamp &&
+      timestamp < start + GST_BUFFER_DURATION (buffer);
+}
+
+/* Waits for the pipeline of @job to preroll, FALSE if it failed to */
+static gboolean
+wait_for_preroll (ThumbnailJob * job)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean ret;
+
+  bus = gst_element_get_bus (job->pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, THUMBNAIL_TIMEOUT,
+      GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+  gst_object_unref (bus);
+
+  if (msg == NULL) {
+    GST_WARNING_OBJECT (job->timeline, "The thumbnailer timed out");
+    return FALSE;
+  }
+
+  ret = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_DONE;
+  if (!ret)
+    GST_WARNING_OBJECT (job->timeline, "The thumbnailer got an error from %"
+        GST_PTR_FORMAT, GST_MESSAGE_SRC (msg));
+  gst_message_unref (msg);
+
+  return ret;
+}
+
+/* Returns the frame at @timestamp, sets @failed if the pipeline broke and
+ * can not be used anymore */
+static GstSample *
+take_thumbnail (ThumbnailJob * job, GstClockTime timestamp, gboolean * failed)
+{
+  GstSample *sample = NULL;
+
+  if (timestamp >= job->duration)
+    return NULL;
+
+  if (!gst_element_seek_simple (job->pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE, timestamp) ||
+      !wait_for_preroll (job)) {
+    *failed = TRUE;
+    return NULL;
+  }
+
+  g_object_get (job->sink, "last-sample", &sample, NULL);
+
+  return sample;
+}
+
+static gpointer
+thumbnail_job_run (ThumbnailJob * job)
+{
+  guint i;
+  gboolean failed = FALSE;
+  ThumbnailResult *result;
+  GstSample *last = NULL;
+
+  switch (gst_element_set_state (job->pipeline, GST_STATE_PAUSED)) {
+    case GST_STATE_CHANGE_FAILURE:
+      failed = TRUE;
+      break;
+    case GST_STATE_CHANGE_ASYNC:
+      failed = !wait_for_preroll (job);
+      break;
+    default:
+      break;
+  }
+
+  if (!failed)
+    job->duration = ges_timeline_get_duration (job->copy);
+  else
+    GST_WARNING_OBJECT (job->timeline, "Could not preroll the thumbnailer");
+
+  for (i = 0; i < job->n_timestamps; i++) {
+    result = g_slice_new0 (ThumbnailResult);
+    result->job = job;
+    result->timestamp = job->timestamps[i];
+
+    /* No need to seek to another timestamp within the same frame */
+    if (last && sample_covers (last, result->timestamp))
+      result->sample = gst_sample_ref (last);
+    else if (!failed)
+      result->sample = take_thumbnail (job, result->timestamp, &failed);
+
+    if (last)
+      gst_sample_unref (last);
+    last = result->sample ? gst_sample_ref (result->sample) : NULL;
+
+    invoke_in_default_context ((GSourceFunc) deliver_thumbnail, result,
+        (GDestroyNotify) thumbnail_result_free);
+  }
+
+  if (last)
+    gst_sample_unref (last);
+
+  gst_element_set_state (job->pipeline, GST_STATE_NULL);
+  invoke_in_default_context ((GSourceFunc) finish_thumbnail_job, job, NULL);
+
+  return NULL;
+}
+
+/* Copies the layers and tracks of @timeline into a new timeline with the
+ * #GESKeyfileFormatter, so only the objects it can save are copied */
+GESTimeline *
+timeline_copy (GESTimeline * timeline)
+{
+  GESFormatter *formatter;
+  GESTimeline *copy;
+  GList *layers;
+
+  /* Empty timelines can not be saved */
+  layers = ges_timeline_get_layers (timeline);
+  if (layers == NULL)
+    return NULL;
+  g_list_free_full (layers, g_object_unref);
+
+  formatter = GES_FORMATTER (ges_keyfile_formatter_new ());
+  copy = ges_timeline_new ();
+
+  if (!ges_formatter_save (formatter, timeline) ||
+      !ges_formatter_load (formatter, copy)) {
+    g_object_unref (formatter);
+    gst_object_unref (gst_object_ref_sink (copy));
+    return NULL;
+  }
+  g_object_unref (formatter);
+
+  return copy;
+}
+
+/* Copies the layers and video tracks of @timeline into a new timeline */
+static GESTimeline *
+copy_video_timeline (GESTimeline * timeline)
+{
+  GESTimeline *copy;
+  GList *tracks, *tmp;
+  gboolean has_video = FALSE;
+
+  copy = timeline_copy (timeline);
+  if (copy == NULL)
+    return NULL;
+
+  tracks = ges_timeline_get_tracks (copy);
+  for (tmp = tracks; tmp; tmp = tmp->next) {
+    GESTrack *track = tmp->data;
+
+    if (track->type == GES_TRACK_TYPE_VIDEO && !has_video)
+      has_video = TRUE;
+    else
+      ges_timeline_remove_track (copy, track);
+  }
+  g_list_free_full (tracks, gst_object_unref);
+
+  if (!has_video) {
+    gst_object_unref (gst_object_ref_sink (copy));
+    return NULL;
+  }
+
+  return copy;
+}
+
+/**
+ * ges_timeline_get_thumbnails:
+ * @timeline: a #GESTimeline with a video track
+ * @timestamps: (array length=n_timestamps): the positions to take thumbnails
+ * at
+ * @n_timestamps: the number of @timestamps
+ * @caps: (allow-none): the format of the thumbnails, or %NULL for the one of
+ * the video track
+ * @callback: (scope notified): the function called with each thumbnail
+ * @user_data: data passed to @callback
+ * @notify: (allow-none): called with @user_data once all the thumbnails were
+ * delivered
+ *
+ * Extracts the frames of the first video track of @timeline at @timestamps,
+ * for example to draw filmstrips, independently of any #GESTimelinePipeline
+ * @timeline might be playing in.
+ *
+ * The frames are extracted as fast as possible, by a pipeline of its own
+ * working on a copy of @timeline as it is when this function is called.
+ * @callback is called from the default main context, once per timestamp, in
+ * increasing timestamp order, with a %NULL sample for the timestamps past
+ * the end of the timeline or when the extraction failed, for example on an
+ * undecodable source. As the copy is made with the
+ * #GESKeyfileFormatter, only the objects it can save are taken into
+ * account.
+ *
+ * Returns: %TRUE if the extraction was started, else %FALSE, in which case
+ * neither @callback nor @notify will be called.
+ */
+gboolean
+ges_timeline_get_thumbnails (GESTimeline * timeline,
+    const GstClockTime * timestamps, guint n_timestamps, GstCaps * caps,
+    GESTimelineThumbnailCallback callback, gpointer user_data,
+    GDestroyNotify notify)
+{
+  ThumbnailJob *job;
+  GESTimeline *copy;
+  GstElement *scale, *filter;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (timestamps != NULL || n_timestamps == 0, FALSE);
+  g_return_val_if_fail (callback != NULL, FALSE);
+
+  copy = copy_video_timeline (timeline);
+  if (copy == NULL) {
+    GST_WARNING_OBJECT (timeline, "Could not copy the video of the timeline");
+    return FALSE;
+  }
+
+  job = g_slice_new0 (ThumbnailJob);
+  job->timeline = gst_object_ref (timeline);
+  job->callback = callback;
+  job->user_data = user_data;
+  job->notify = notify;
+  job->copy = copy;
+
+  job->timestamps = g_memdup (timestamps, n_timestamps * sizeof (GstClockTime));
+  job->n_timestamps = n_timestamps;
+  g_qsort_with_data (job->timestamps, n_timestamps, sizeof (GstClockTime),
+      compare_timestamps, NULL);
+
+  job->pipeline = gst_pipeline_new ("ges-thumbnailer");
+  job->convert = gst_element_factory_make ("videoconvert", NULL);
+  scale = gst_element_factory_make ("videoscale", NULL);
+  filter = gst_element_factory_make ("capsfilter", NULL);
+  job->sink = gst_element_factory_make ("fakesink", NULL);
+
+  if (!job->convert || !scale || !filter || !job->sink)
+    goto missing_element;
+
+  if (caps)
+    g_object_set (filter, "caps", caps, NULL);
+  g_object_set (job->sink, "sync", FALSE, "enable-last-sample", TRUE, NULL);
+
+  gst_bin_add_many (GST_BIN (job->pipeline), GST_ELEMENT (copy), job->convert,
+      scale, filter, job->sink, NULL);
+  gst_element_link_many (job->convert, scale, filter, job->sink, NULL);
+  g_signal_connect (copy, "pad-added", G_CALLBACK (thumbnail_pad_added_cb),
+      job);
+
+  g_thread_unref (g_thread_new ("ges-thumbnailer",
+          (GThreadFunc) thumbnail_job_run, job));
+
+  return TRUE;
+
+missing_element:
+  {
+    GST_ERROR_OBJECT (timeline, "Missing element for the thumbnailer");
+    gst_object_unref (gst_object_ref_sink (copy));
+    if (job->convert)
+      gst_object_unref (job->convert);
+    if (scale)
+      gst_object_unref (scale);
+    if (filter)
+      gst_object_unref (filter);
+    if (job->sink)
+      gst_object_unref (job->sink);
+    job->notify = NULL;
+    finish_thumbnail_job (job);
+    return FALSE;
+  }
+}
+
+static GList *
+copy_object_list (GList * list)
+{
+  GList *copy = g_list_copy (list);
+
+  g_list_foreach (copy, (GFunc) g_object_ref, NULL);
+
+  return copy;
+}
+
+/**
+ * ges_timeline_set_snapping_tracks:
+ * @timeline: a #GESTimeline
+ * @tracks: (element-type GESTrack) (allow-none): The #GESTrack-s to snap to,
+ * or %NULL to snap to all of them
+ *
+ * Restricts the edges moving objects snap to, when #GESTimeline:snapping-distance
+ * is set, to the ones of the objects in @tracks.
+ */
+void
+ges_timeline_set_snapping_tracks (GESTimeline * timeline, GList * tracks)
+{
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  g_list_free_full (priv->snapping_tracks, g_object_unref);
+  priv->snapping_tracks = copy_object_list (tracks);
+  init_snapping (&priv->movecontext);
+}
+
+/**
+ * ges_timeline_set_snapping_layers:
+ * @timeline: a #GESTimeline
+ * @layers: (element-type GESTimelineLayer) (allow-none): The
+ * #GESTimelineLayer-s to snap to, or %NULL to snap to all of them
+ *
+ * Restricts the edges moving objects snap to, when #GESTimeline:snapping-distance
+ * is set, to the ones of the objects in @layers.
+ */
+void
+ges_timeline_set_snapping_layers (GESTimeline * timeline, GList * layers)
+{
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+  g_list_free_full (priv->snapping_layers, g_object_unref);
+  priv->snapping_layers = copy_object_list (layers);
+  init_snapping (&priv->movecontext);
+}
+
+/**
+ * ges_timeline_set_snapping_framerate:
+ * @timeline: a #GESTimeline
+ * @fps_n: The numerator of the framerate, or 0 to disable the frame grid
+ * @fps_d: The denominator of the framerate
+ *
+ * Makes moving objects also snap to the frame boundaries of the given
+ * framerate, when they are within #GESTimeline:snapping-distance of one
+ * and no object edge is closer.
+ */
+void
+ges_timeline_set_snapping_framerate (GESTimeline * timeline, gint fps_n,
+    gint fps_d)
+{
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+  g_return_if_fail (fps_n >= 0);
+  g_return_if_fail (fps_n == 0 || fps_d > 0);
+
+  timeline->priv->snapping_fps_n = fps_n;
+  timeline->priv->snapping_fps_d = fps_d;
+}
+
+/**
+ * ges_timeline_begin_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Starts an edit transaction on @timeline. Until the matching call to
+ * ges_timeline_commit_edit(), the changes made to the objects of @timeline
+ * are not applied to its tracks, the automatic transitions of its layers
+ * are not recalculated and the notifications of @timeline and its tracks
+ * are held back. Everything is then done once, when the edit is commited.
+ *
+ * Transactions can be nested, the changes are only commited when the
+ * outermost transaction is.
+ *
+ * Use this when doing lots of changes at once, like moving many clips.
+ */
+void
+ges_timeline_begin_edit (GESTimeline * timeline)
+{
+  GList *tmp;
+  GESTimelinePrivate *priv;
+
+  g_return_if_fail (GES_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+
+  if (priv->edit_depth++ > 0)
+    return;
+
+  GST_DEBUG_OBJECT (timeline, "Beginning edit");
+
+  g_object_freeze_notify (G_OBJECT (timeline));
+  for (tmp = priv->tracks; tmp; tmp = tmp->next)
+    track_begin_edit (tmp->data);
+}
+
+/**
+ * ges_timeline_commit_edit:
+ * @timeline: a #GESTimeline
+ *
+ * Ends the edit transaction started with ges_timeline_begin_edit(). If it is
+ * the outermost one, all the changes done since it started are applied to
+ * the tracks in one go.
+ *
+ * Returns: %TRUE if the transaction could be ended, %FALSE if no transaction
+ * was in progress.
+ */
+gboolean
+ges_timeline_commit_edit (GESTimeline * timeline)
+{
+  GList *tmp;
+  GESTimelinePrivate *priv;
+
+  g_return_val_if_fail (GES_IS_TIMELINE (timeline), FALSE);
+
+  priv = timeline->priv;
+
+  if (G_UNLIKELY (priv->edit_depth == 0)) {
+    GST_WARNING_OBJECT (timeline, "No edit in progress");
+    return FALSE;
+  }
+
+  if (--priv->edit_depth > 0)
+    return TRUE;
+
+  GST_DEBUG_OBJECT (timeline, "Commiting edit");
+
+  flush_edited_sources (timeline);
+  priv->movecontext.needs_move_ctx = TRUE;
+
+  /* Layers might add or remove transitions which will still be commited
+   * with everything else */
+  for (tmp = priv->layers; tmp; tmp = tmp->next)
+    timeline_layer_commit_edit (tmp->data);
+
+  for (tmp = priv->tracks; tmp; tmp = tmp->next)
+    track_commit_edit (tmp->data);
+  g_object_thaw_notify (G_OBJECT (timeline));
+
+  return TRUE;
+}
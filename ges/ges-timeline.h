@@ -80,6 +80,22 @@ struct _GESTimelineClass {
   gpointer _ges_reserved[GES_PADDING];
 };
 
+/**
+ * GESTimelineThumbnailCallback:
+ * @timeline: the #GESTimeline the thumbnails are taken from
+ * @timestamp: the position of the thumbnail
+ * @sample: (transfer none) (allow-none): the frame at @timestamp, or %NULL if
+ * it could not be extracted
+ * @user_data: the user data given to ges_timeline_get_thumbnails()
+ *
+ * Called for each of the thumbnails requested with
+ * ges_timeline_get_thumbnails().
+ */
+typedef void (*GESTimelineThumbnailCallback) (GESTimeline *timeline,
+                                              GstClockTime timestamp,
+                                              GstSample *sample,
+                                              gpointer user_data);
+
 GType ges_timeline_get_type (void);
 
 GESTimeline* ges_timeline_new (void);
@@ -104,6 +120,30 @@ gboolean ges_timeline_is_updating (GESTimeline * timeline);
 
 GstClockTime ges_timeline_get_duration (GESTimeline *timeline);
 
+void ges_timeline_begin_edit (GESTimeline *timeline);
+gboolean ges_timeline_commit_edit (GESTimeline *timeline);
+
+GList *ges_timeline_get_track_objects_in_range (GESTimeline *timeline,
+                                                GstClockTime start,
+                                                GstClockTime end);
+
+guint64 *ges_timeline_get_render_cut_points (GESTimeline *timeline,
+                                             guint n_ranges,
+                                             guint *n_points);
+
+gboolean ges_timeline_get_thumbnails (GESTimeline *timeline,
+                                      const GstClockTime *timestamps,
+                                      guint n_timestamps,
+                                      GstCaps *caps,
+                                      GESTimelineThumbnailCallback callback,
+                                      gpointer user_data,
+                                      GDestroyNotify notify);
+
+void ges_timeline_set_snapping_tracks (GESTimeline *timeline, GList *tracks);
+void ges_timeline_set_snapping_layers (GESTimeline *timeline, GList *layers);
+void ges_timeline_set_snapping_framerate (GESTimeline *timeline, gint fps_n,
+                                          gint fps_d);
+
 G_END_DECLS
 
 #endif /* _GES_TIMELINE */
@@ -38,9 +38,16 @@
 G_DEFINE_ABSTRACT_TYPE (GESTrackObject, ges_track_object,
     G_TYPE_INITIALLY_UNOWNED);
 
+struct _GESChildProperty
+{
+  GParamSpec *pspec;
+  GstElement *element;          /* The child having the property */
+};
+
 struct _GESTrackObjectPrivate
 {
-  /* These fields are only used before the gnlobject is available */
+  /* These fields are only used while the gnlobject is not available, when
+   * the object is not in a track yet or when its track released it */
   guint64 pending_start;
   guint64 pending_inpoint;
   guint64 pending_duration;
@@ -55,6 +62,11 @@ struct _GESTrackObjectPrivate
    * {GParamaSpec ---> element,}*/
   GHashTable *properties_hashtable;
 
+  /* Index of the children properties
+   * {"property-name" and "ClassName::property-name" ---> GESChildProperty} */
+  GHashTable *children_props_index;
+  GPtrArray *children_props;    /* Array of GESChildProperty */
+
   GESTimelineObject *timelineobj;
   GESTrack *track;
 
@@ -198,8 +210,20 @@ ges_track_object_dispose (GObject * object)
 {
   GESTrackObjectPrivate *priv = GES_TRACK_OBJECT (object)->priv;
 
-  if (priv->properties_hashtable)
+  if (priv->children_props_index) {
+    g_hash_table_destroy (priv->children_props_index);
+    priv->children_props_index = NULL;
+  }
+
+  if (priv->children_props) {
+    g_ptr_array_free (priv->children_props, TRUE);
+    priv->children_props = NULL;
+  }
+
+  if (priv->properties_hashtable) {
     g_hash_table_destroy (priv->properties_hashtable);
+    priv->properties_hashtable = NULL;
+  }
 
   if (priv->gnlobject) {
     GstState cstate;
@@ -382,8 +406,12 @@ ges_track_object_set_start_internal (GESTrackObject * object, guint64 start)
       return FALSE;
 
     g_object_set (object->priv->gnlobject, "start", start, NULL);
-  } else
+  } else {
     object->priv->pending_start = start;
+    /* The track still needs to know where the object is */
+    if (object->priv->track)
+      object->start = start;
+  }
   return TRUE;
 };
 
@@ -415,8 +443,11 @@ ges_track_object_set_inpoint_internal (GESTrackObject * object, guint64 inpoint)
       return FALSE;
 
     g_object_set (object->priv->gnlobject, "media-start", inpoint, NULL);
-  } else
+  } else {
     object->priv->pending_inpoint = inpoint;
+    if (object->priv->track)
+      object->inpoint = inpoint;
+  }
 
   return TRUE;
 }
@@ -456,8 +487,11 @@ ges_track_object_set_duration_internal (GESTrackObject * object,
 
     g_object_set (priv->gnlobject, "duration", duration,
         "media-duration", duration, NULL);
-  } else
+  } else {
     priv->pending_duration = duration;
+    if (priv->track)
+      object->duration = duration;
+  }
 
   return TRUE;
 }
@@ -490,8 +524,11 @@ ges_track_object_set_priority_internal (GESTrackObject * object,
       return FALSE;
 
     g_object_set (object->priv->gnlobject, "priority", priority, NULL);
-  } else
+  } else {
     object->priv->pending_priority = priority;
+    if (object->priv->track)
+      object->priority = priority;
+  }
   return TRUE;
 }
 
@@ -538,8 +575,11 @@ ges_track_object_set_active (GESTrackObject * object, gboolean active)
       return FALSE;
 
     g_object_set (object->priv->gnlobject, "active", active, NULL);
-  } else
+  } else {
     object->priv->pending_active = active;
+    if (object->priv->track)
+      object->active = active;
+  }
   return TRUE;
 }
 
@@ -585,6 +625,50 @@ connect_signal (gpointer key, gpointer value, gpointer user_data)
   g_free (signame);
 }
 
+static void
+child_property_free (GESChildProperty * prop)
+{
+  g_slice_free (GESChildProperty, prop);
+}
+
+static void
+index_child_property (GParamSpec * pspec, GstElement * element,
+    GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+  GESChildProperty *prop = g_slice_new (GESChildProperty);
+
+  prop->pspec = pspec;
+  prop->element = element;
+  g_ptr_array_add (priv->children_props, prop);
+
+  /* In case various elements have the same property, the bare name is
+   * associated with the first one found */
+  if (!g_hash_table_lookup (priv->children_props_index, pspec->name))
+    g_hash_table_insert (priv->children_props_index, g_strdup (pspec->name),
+        prop);
+
+  g_hash_table_insert (priv->children_props_index,
+      g_strdup_printf ("%s::%s", G_OBJECT_TYPE_NAME (element), pspec->name),
+      prop);
+}
+
+/* Builds the name ---> property index so that looking up properties by
+ * name is a simple hash table lookup */
+static void
+index_children_properties (GESTrackObject * object)
+{
+  GESTrackObjectPrivate *priv = object->priv;
+
+  priv->children_props_index = g_hash_table_new_full (g_str_hash,
+      g_str_equal, g_free, NULL);
+  priv->children_props = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      child_property_free);
+
+  g_hash_table_foreach (priv->properties_hashtable,
+      (GHFunc) index_child_property, object);
+}
+
 static void
 connect_properties_signals (GESTrackObject * object)
 {
@@ -788,8 +872,14 @@ ensure_gnl_object (GESTrackObject * object)
   /* 2. Fill in the GnlObject */
   if (object->priv->gnlobject == NULL) {
 
-    /* call the create_gnl_object virtual method */
-    gnlobject = class->create_gnl_object (object);
+    /* Take over the gnlobject a similar source released if possible, else
+     * call the create_gnl_object virtual method */
+    gnlobject = NULL;
+    if (object->priv->track)
+      gnlobject = track_pop_pooled_gnl_object (object->priv->track, object,
+          &object->priv->element);
+    if (gnlobject == NULL)
+      gnlobject = class->create_gnl_object (object);
 
     if (G_UNLIKELY (gnlobject == NULL)) {
       GST_ERROR
@@ -843,6 +933,7 @@ ensure_gnl_object (GESTrackObject * object)
               "properties_hashtable is available");
         } else {
           object->priv->properties_hashtable = props_hash;
+          index_children_properties (object);
           connect_properties_signals (object);
         }
       }
@@ -871,6 +962,14 @@ ges_track_object_set_track (GESTrackObject * object, GESTrack * track)
       g_object_set (object->priv->gnlobject,
           "caps", ges_track_get_caps (object->priv->track), NULL);
       return TRUE;
+    } else if (!track_wants_materialized (track, object)) {
+      /* Only the timing is needed until the track materializes it */
+      object->start = object->priv->pending_start;
+      object->inpoint = object->priv->pending_inpoint;
+      object->duration = object->priv->pending_duration;
+      object->priority = object->priv->pending_priority;
+      object->active = object->priv->pending_active;
+      return TRUE;
     } else {
       return ensure_gnl_object (object);
     }
@@ -879,6 +978,48 @@ ges_track_object_set_track (GESTrackObject * object, GESTrack * track)
   return TRUE;
 }
 
+/* Creates the gnlobject of an object its track released, returns %TRUE if
+ * it is available */
+gboolean
+track_object_materialize (GESTrackObject * object)
+{
+  if (object->priv->gnlobject == NULL)
+    ensure_gnl_object (object);
+
+  return object->priv->gnlobject != NULL;
+}
+
+/* Gives up the gnlobject, once its track removed it from its composition,
+ * and returns it with the element created in it. The object keeps its
+ * timing, and gets a gnlobject again when materialized. */
+GstElement *
+track_object_release (GESTrackObject * object, GstElement ** element)
+{
+  GstElement *gnlobject;
+  GESTrackObjectPrivate *priv = object->priv;
+
+  if (priv->gnlobject == NULL)
+    return NULL;
+
+  GST_DEBUG_OBJECT (object, "Releasing %" GST_PTR_FORMAT, priv->gnlobject);
+
+  priv->pending_start = object->start;
+  priv->pending_inpoint = object->inpoint;
+  priv->pending_duration = object->duration;
+  priv->pending_priority = object->priority;
+  priv->pending_active = object->active;
+
+  g_signal_handlers_disconnect_matched (priv->gnlobject, G_SIGNAL_MATCH_DATA,
+      0, 0, NULL, NULL, object);
+  gnlobject = priv->gnlobject;
+  *element = priv->element;
+  priv->gnlobject = NULL;
+  priv->element = NULL;
+  priv->valid = FALSE;
+
+  return gnlobject;
+}
+
 /**
  * ges_track_object_get_track:
  * @object: a #GESTrackObject
@@ -1143,44 +1284,87 @@ gboolean
 ges_track_object_lookup_child (GESTrackObject * object, const gchar * prop_name,
     GstElement ** element, GParamSpec ** pspec)
 {
-  GHashTableIter iter;
-  gpointer key, value;
-  gchar **names, *name, *classename;
-  gboolean res;
-  GESTrackObjectPrivate *priv;
+  GESChildProperty *prop;
 
   g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), FALSE);
 
-  priv = object->priv;
+  prop = ges_track_object_lookup_child_property (object, prop_name);
+  if (prop == NULL)
+    return FALSE;
 
-  classename = NULL;
-  res = FALSE;
+  GST_DEBUG ("The %s property has been found", prop_name);
+  if (element)
+    *element = g_object_ref (prop->element);
 
-  names = g_strsplit (prop_name, "::", 2);
-  if (names[1] != NULL) {
-    classename = names[0];
-    name = names[1];
-  } else
-    name = names[0];
+  *pspec = g_param_spec_ref (prop->pspec);
 
-  g_hash_table_iter_init (&iter, priv->properties_hashtable);
-  while (g_hash_table_iter_next (&iter, &key, &value)) {
-    if (g_strcmp0 (G_PARAM_SPEC (key)->name, name) == 0) {
-      if (classename == NULL ||
-          g_strcmp0 (G_OBJECT_TYPE_NAME (G_OBJECT (value)), classename) == 0) {
-        GST_DEBUG ("The %s property from %s has been found", name, classename);
-        if (element)
-          *element = g_object_ref (value);
-
-        *pspec = g_param_spec_ref (key);
-        res = TRUE;
-        break;
-      }
-    }
+  return TRUE;
+}
+
+/**
+ * ges_track_object_lookup_child_property:
+ * @object: object to lookup the property in
+ * @prop_name: name of the property to look up, as for
+ *     ges_track_object_lookup_child()
+ *
+ * Resolves @prop_name to a #GESChildProperty that can then be used to set and
+ * get the property without looking it up again, see
+ * ges_track_object_set_child_property_by_handle() and
+ * ges_track_object_get_child_property_by_handle().
+ *
+ * Returns: (transfer none): The #GESChildProperty, owned by @object and valid
+ * as long as @object is, or %NULL if no child of @object has the property.
+ */
+GESChildProperty *
+ges_track_object_lookup_child_property (GESTrackObject * object,
+    const gchar * prop_name)
+{
+  g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), NULL);
+  g_return_val_if_fail (prop_name != NULL, NULL);
+
+  if (G_UNLIKELY (object->priv->children_props_index == NULL)) {
+    GST_DEBUG ("The child properties haven't been set on %p", object);
+    return NULL;
   }
-  g_strfreev (names);
 
-  return res;
+  return g_hash_table_lookup (object->priv->children_props_index, prop_name);
+}
+
+/**
+ * ges_track_object_set_child_property_by_handle:
+ * @object: a #GESTrackObject
+ * @prop: a #GESChildProperty of @object
+ * @value: the value
+ *
+ * Sets the property of a child of @object that @prop designates.
+ */
+void
+ges_track_object_set_child_property_by_handle (GESTrackObject * object,
+    GESChildProperty * prop, const GValue * value)
+{
+  g_return_if_fail (GES_IS_TRACK_OBJECT (object));
+  g_return_if_fail (prop != NULL);
+
+  g_object_set_property (G_OBJECT (prop->element), prop->pspec->name, value);
+}
+
+/**
+ * ges_track_object_get_child_property_by_handle:
+ * @object: a #GESTrackObject
+ * @prop: a #GESChildProperty of @object
+ * @value: (out): return location for the value, initialized to the type of
+ * the property
+ *
+ * Gets the property of a child of @object that @prop designates.
+ */
+void
+ges_track_object_get_child_property_by_handle (GESTrackObject * object,
+    GESChildProperty * prop, GValue * value)
+{
+  g_return_if_fail (GES_IS_TRACK_OBJECT (object));
+  g_return_if_fail (prop != NULL);
+
+  g_object_get_property (G_OBJECT (prop->element), prop->pspec->name, value);
 }
 
 /**
@@ -1247,7 +1431,7 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
 {
   const gchar *name;
   GParamSpec *pspec;
-  GstElement *element;
+  GESChildProperty *prop;
 
   gchar *error = NULL;
   GValue value = { 0, };
@@ -1261,9 +1445,12 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
 
   /* iterate over pairs */
   while (name) {
-    if (!ges_track_object_lookup_child (object, name, &element, &pspec))
+    prop = ges_track_object_lookup_child_property (object, name);
+    if (prop == NULL)
       goto not_found;
 
+    pspec = prop->pspec;
+
 #if GLIB_CHECK_VERSION(2,23,3)
     G_VALUE_COLLECT_INIT (&value, pspec->value_type, var_args,
         G_VALUE_NOCOPY_CONTENTS, &error);
@@ -1275,9 +1462,8 @@ ges_track_object_set_child_property_valist (GESTrackObject * object,
     if (error)
       goto cant_copy;
 
-    g_object_set_property (G_OBJECT (element), pspec->name, &value);
+    g_object_set_property (G_OBJECT (prop->element), pspec->name, &value);
 
-    g_object_unref (element);
     g_value_unset (&value);
 
     name = va_arg (var_args, gchar *);
@@ -1348,7 +1534,7 @@ ges_track_object_get_child_property_valist (GESTrackObject * object,
   gchar *error = NULL;
   GValue value = { 0, };
   GParamSpec *pspec;
-  GstElement *element;
+  GESChildProperty *prop;
 
   g_return_if_fail (G_IS_OBJECT (object));
 
@@ -1356,12 +1542,13 @@ ges_track_object_get_child_property_valist (GESTrackObject * object,
 
   /* This part is in big part copied from the gst_child_object_get_valist method */
   while (name) {
-    if (!ges_track_object_lookup_child (object, name, &element, &pspec))
+    prop = ges_track_object_lookup_child_property (object, name);
+    if (prop == NULL)
       goto not_found;
 
+    pspec = prop->pspec;
     g_value_init (&value, pspec->value_type);
-    g_object_get_property (G_OBJECT (element), pspec->name, &value);
-    g_object_unref (element);
+    g_object_get_property (G_OBJECT (prop->element), pspec->name, &value);
 
     G_VALUE_LCOPY (&value, var_args, 0, &error);
     if (error)
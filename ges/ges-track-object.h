@@ -72,6 +72,14 @@ G_BEGIN_DECLS
 
 typedef struct _GESTrackObjectPrivate GESTrackObjectPrivate;
 
+/**
+ * GESChildProperty:
+ *
+ * An opaque handle on a property of a child of a #GESTrackObject, see
+ * ges_track_object_lookup_child_property().
+ */
+typedef struct _GESChildProperty GESChildProperty;
+
 /**
  * GESTrackObject:
  *
@@ -226,6 +234,20 @@ void ges_track_object_set_child_property     (GESTrackObject * object,
                                               const gchar * first_property_name,
                                               ...) G_GNUC_NULL_TERMINATED;
 
+GESChildProperty *
+ges_track_object_lookup_child_property       (GESTrackObject * object,
+                                              const gchar * prop_name);
+
+void
+ges_track_object_set_child_property_by_handle (GESTrackObject * object,
+                                               GESChildProperty * prop,
+                                               const GValue * value);
+
+void
+ges_track_object_get_child_property_by_handle (GESTrackObject * object,
+                                               GESChildProperty * prop,
+                                               GValue * value);
+
 GESTrackObject * ges_track_object_copy       (GESTrackObject * object,
                                               gboolean deep);
 
@@ -32,9 +32,14 @@
 #include "ges-internal.h"
 #include "ges-track.h"
 #include "ges-track-object.h"
+#include "ges-track-filesource.h"
+#include "ges-track-image-source.h"
 
 G_DEFINE_TYPE (GESTrack, ges_track, GST_TYPE_BIN);
 
+/* Number of released source gnlobjects kept for reuse */
+#define POOL_SIZE 8
+
 /* Structure that represents gaps and keep knowledge
  * of the gaps filled in the track */
 typedef struct
@@ -46,12 +51,41 @@ typedef struct
   GESTrack *track;
 } Gap;
 
+/* The coverage of the track is kept as a step function: each Segment starts
+ * at @start and lasts until the start of the next one (or until the end of
+ * the timeline for the last one) and @count TrackObjects are playing during
+ * it. Segments with a @count of 0 are the gaps of the track. */
+typedef struct
+{
+  GstClockTime start;
+  gint count;
+
+  Gap *gap;
+} Segment;
+
+/* What the track knows about each of its TrackObjects */
+typedef struct
+{
+  GSequenceIter *iter;          /* Position in tckobjs_by_start */
+
+  /* The span currently accounted for in the segments */
+  GstClockTime start;
+  GstClockTime end;
+} TrackObjectData;
+
 struct _GESTrackPrivate
 {
   /*< private > */
   GESTimeline *timeline;
   GSequence *tckobjs_by_start;
-  GList *gaps;
+  GHashTable *tckobjs_data;
+
+  /* The coverage of the track, sorted by start, first one always starts at 0 */
+  GSequence *segments;
+
+  /* The part of the track where gaps need to be updated */
+  GstClockTime dirty_start;
+  GstClockTime dirty_end;
 
   guint64 duration;
 
@@ -62,6 +96,22 @@ struct _GESTrackPrivate
 
   gboolean updating;
 
+  /* When set, a single filler at the lowest priority spanning the whole track
+   * is used instead of one gap per hole */
+  gboolean use_background_filler;
+  Gap *filler;
+
+  /* When valid, the sources further than materialize_window from the
+   * playhead do not have a gnlobject */
+  GstClockTime materialize_window;
+  GstClockTime playhead;
+  guint max_materialized;       /* 0 for no limit */
+  IntervalTree *virtual_objects;        /* The sources which can be released */
+  GHashTable *materialized;     /* {TrackObject: TrackObject} */
+
+  /* The gnlobjects of the sources which were released or removed */
+  ElementPool *pool;
+
   /* Virtual method to create GstElement that fill gaps */
   GESCreateElementForGapFunc create_element_for_gaps;
 };
@@ -72,6 +122,10 @@ enum
   ARG_CAPS,
   ARG_TYPE,
   ARG_DURATION,
+  ARG_USE_BACKGROUND_FILLER,
+  ARG_MATERIALIZE_WINDOW,
+  ARG_MAX_MATERIALIZED,
+  ARG_PLAYHEAD,
   ARG_LAST,
   TRACK_OBJECT_ADDED,
   TRACK_OBJECT_REMOVED,
@@ -184,72 +238,488 @@ free_gap (Gap * gap)
   g_slice_free (Gap, gap);
 }
 
-static inline void
-update_gaps (GESTrack * track)
+static void
+release_gap (Segment * seg, GList ** unused_gaps)
 {
-  Gap *gap;
-  GSequenceIter *it;
+  if (seg->gap == NULL)
+    return;
 
-  GESTrackObject *tckobj;
-  GstClockTime start, end, duration = 0, timeline_duration;
+  if (unused_gaps)
+    *unused_gaps = g_list_prepend (*unused_gaps, seg->gap);
+  else
+    free_gap (seg->gap);
 
-  GESTrackPrivate *priv = track->priv;
+  seg->gap = NULL;
+}
+
+/* Makes sure @seg has a gap of @duration, reusing the gaps that have been
+ * released in @unused_gaps if possible */
+static void
+fill_segment (GESTrack * track, Segment * seg, GstClockTime duration,
+    GList ** unused_gaps)
+{
+  Gap *gap = seg->gap;
+
+  if (gap == NULL && unused_gaps && *unused_gaps) {
+    gap = (*unused_gaps)->data;
+    *unused_gaps = g_list_delete_link (*unused_gaps, *unused_gaps);
+
+    /* Make sure it is updated hereafter */
+    gap->duration = GST_CLOCK_TIME_NONE;
+  }
+
+  if (gap == NULL) {
+    seg->gap = gap_new (track, seg->start, duration);
 
-  if (priv->create_element_for_gaps == NULL) {
-    GST_INFO ("Not filling the gaps as no create_element_for_gaps vmethod"
-        " provided");
     return;
   }
 
-  /* 1- Remove all gaps */
-  g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
-  priv->gaps = NULL;
+  if (gap->start != seg->start || gap->duration != duration) {
+    gap->start = seg->start;
+    gap->duration = duration;
+
+    g_object_set (gap->gnlobj, "start", gap->start, "duration", gap->duration,
+        NULL);
 
-  /* 2- And recalculate gaps */
-  for (it = g_sequence_get_begin_iter (priv->tckobjs_by_start);
-      g_sequence_iter_is_end (it) == FALSE; it = g_sequence_iter_next (it)) {
-    tckobj = g_sequence_get (it);
+    GST_DEBUG_OBJECT (track, "Moved gap to start %" GST_TIME_FORMAT
+        " duration %" GST_TIME_FORMAT, GST_TIME_ARGS (gap->start),
+        GST_TIME_ARGS (gap->duration));
+  }
+
+  seg->gap = gap;
+}
+
+static void
+segment_update_gap (GESTrack * track, Segment * seg, GSequenceIter * next,
+    GList ** unused_gaps)
+{
+  GstClockTime end;
+  GESTrackPrivate *priv = track->priv;
 
-    start = GES_TRACK_OBJECT_START (tckobj);
-    end = start + GES_TRACK_OBJECT_DURATION (tckobj);
+  if (seg->count == 0 && priv->create_element_for_gaps &&
+      priv->use_background_filler == FALSE) {
+    if (g_sequence_iter_is_end (next)) {
+      /* The last gap goes until the end of the timeline */
+      end = priv->timeline ? ges_timeline_get_duration (priv->timeline) : 0;
+    } else
+      end = ((Segment *) g_sequence_get (next))->start;
 
-    if (start > duration) {
-      /* 3- Fill gap */
-      gap = gap_new (track, duration, start - duration);
+    if (end > seg->start) {
+      fill_segment (track, seg, end - seg->start, unused_gaps);
+
+      return;
+    }
+  }
+
+  release_gap (seg, unused_gaps);
+}
+
+/* Makes the background filler span from 0 to the end of the track */
+static void
+update_background_filler (GESTrack * track)
+{
+  GSequenceIter *last;
+  GstClockTime duration = 0;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->use_background_filler && priv->create_element_for_gaps) {
+    last = g_sequence_iter_prev (g_sequence_get_end_iter (priv->segments));
+    duration = ((Segment *) g_sequence_get (last))->start;
+
+    if (priv->timeline)
+      duration = MAX (duration, ges_timeline_get_duration (priv->timeline));
+  }
 
-      if (G_LIKELY (gap != NULL))
-        priv->gaps = g_list_prepend (priv->gaps, gap);
+  if (duration == 0) {
+    if (priv->filler) {
+      free_gap (priv->filler);
+      priv->filler = NULL;
     }
 
-    duration = MAX (duration, end);
+    return;
   }
 
-  /* 4- Add a gap at the end of the timeline if needed */
-  if (priv->timeline) {
-    g_object_get (priv->timeline, "duration", &timeline_duration, NULL);
+  if (priv->filler == NULL) {
+    priv->filler = gap_new (track, 0, duration);
+
+    /* Below anything else in the composition */
+    if (G_LIKELY (priv->filler != NULL))
+      g_object_set (priv->filler->gnlobj, "priority", G_MAXUINT32, NULL);
+  } else if (priv->filler->duration != duration) {
+    priv->filler->duration = duration;
+    g_object_set (priv->filler->gnlobj, "duration", duration, NULL);
+
+    GST_DEBUG_OBJECT (track, "Background filler duration %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (duration));
+  }
+}
+
+static void
+free_segment (Segment * seg)
+{
+  release_gap (seg, NULL);
+
+  g_slice_free (Segment, seg);
+}
+
+static gint
+compare_segments (Segment * a, Segment * b, gpointer user_data)
+{
+  if (a->start < b->start)
+    return -1;
+  if (a->start > b->start)
+    return 1;
+  return 0;
+}
+
+/* Returns the segment containing @time */
+static inline GSequenceIter *
+segment_iter_at (GESTrack * track, GstClockTime time)
+{
+  Segment needle;
+
+  needle.start = time;
+
+  /* The first segment starts at 0 so we always have a previous one */
+  return g_sequence_iter_prev (g_sequence_search (track->priv->segments,
+          &needle, (GCompareDataFunc) compare_segments, NULL));
+}
+
+/* Returns the segment starting at @time, splitting the segment containing it
+ * if needed */
+static GSequenceIter *
+split_segment_at (GESTrack * track, GstClockTime time)
+{
+  Segment *seg, *nseg;
+  GSequenceIter *iter = segment_iter_at (track, time);
+
+  seg = g_sequence_get (iter);
+  if (seg->start == time)
+    return iter;
+
+  nseg = g_slice_new0 (Segment);
+  nseg->start = time;
+  nseg->count = seg->count;
+
+  return g_sequence_insert_before (g_sequence_iter_next (iter), nseg);
+}
+
+static void
+update_coverage (GESTrack * track, GstClockTime start, GstClockTime end,
+    gint delta)
+{
+  GSequenceIter *iter, *end_iter;
+  GESTrackPrivate *priv = track->priv;
+
+  if (start >= end)
+    return;
+
+  iter = split_segment_at (track, start);
+  end_iter = split_segment_at (track, end);
+
+  for (; iter != end_iter; iter = g_sequence_iter_next (iter))
+    ((Segment *) g_sequence_get (iter))->count += delta;
+
+  priv->dirty_start = MIN (priv->dirty_start, start);
+  priv->dirty_end = MAX (priv->dirty_end, end);
+}
+
+/* Only update the gaps in the part of the track that changed since last time,
+ * moving the existing gaps around instead of recreating them */
+static void
+update_gaps (GESTrack * track)
+{
+  Segment *seg, *nseg;
+  GSequenceIter *iter, *next;
+
+  GList *unused_gaps = NULL;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->dirty_start > priv->dirty_end)
+    return;
+
+  GST_DEBUG_OBJECT (track, "Updating gaps between %" GST_TIME_FORMAT " and %"
+      GST_TIME_FORMAT, GST_TIME_ARGS (priv->dirty_start),
+      GST_TIME_ARGS (priv->dirty_end));
 
-    if (duration < timeline_duration) {
-      gap = gap_new (track, duration, timeline_duration - duration);
+  /* The previous segment might have to be merged or resized as well */
+  iter = g_sequence_iter_prev (segment_iter_at (track, priv->dirty_start));
+  for (;;) {
+    seg = g_sequence_get (iter);
+    next = g_sequence_iter_next (iter);
 
-      if (G_LIKELY (gap != NULL)) {
-        priv->gaps = g_list_prepend (priv->gaps, gap);
-      }
+    /* Merge the following segments that have the same coverage */
+    while (!g_sequence_iter_is_end (next)) {
+      nseg = g_sequence_get (next);
+      if (nseg->count != seg->count)
+        break;
 
-      priv->duration = timeline_duration;
+      release_gap (nseg, &unused_gaps);
+      g_sequence_remove (next);
+      next = g_sequence_iter_next (iter);
     }
 
+    segment_update_gap (track, seg, next, &unused_gaps);
+
+    if (g_sequence_iter_is_end (next) || seg->start > priv->dirty_end)
+      break;
+
+    iter = next;
+  }
+
+  g_list_free_full (unused_gaps, (GDestroyNotify) free_gap);
+
+  update_background_filler (track);
+
+  priv->dirty_start = GST_CLOCK_TIME_NONE;
+  priv->dirty_end = 0;
+}
+
+/* Virtualization of the sources far from the playhead */
+static inline gboolean
+object_is_virtualizable (GESTrackObject * tckobj)
+{
+  return GES_IS_TRACK_FILESOURCE (tckobj) || GES_IS_TRACK_IMAGE_SOURCE (tckobj);
+}
+
+static const gchar *
+source_uri (GESTrackObject * tckobj)
+{
+  if (GES_IS_TRACK_FILESOURCE (tckobj))
+    return GES_TRACK_FILESOURCE (tckobj)->uri;
+  if (GES_IS_TRACK_IMAGE_SOURCE (tckobj))
+    return GES_TRACK_IMAGE_SOURCE (tckobj)->uri;
+
+  return NULL;
+}
+
+/* Takes the gnlobject of @tckobj, which is out of the composition, and keeps
+ * it for a later source reading the same uri */
+static void
+pool_gnl_object (GESTrack * track, GESTrackObject * tckobj)
+{
+  GstElement *gnlobject, *element;
+
+  gnlobject = track_object_release (tckobj, &element);
+  if (gnlobject == NULL)
+    return;
+
+  if (track->priv->pool)
+    element_pool_push (track->priv->pool, G_OBJECT_TYPE (tckobj),
+        source_uri (tckobj), track->priv->caps, gnlobject, element);
+  else
+    gst_object_unref (gnlobject);
+}
+
+GstElement *
+track_pop_pooled_gnl_object (GESTrack * track, GESTrackObject * tckobj,
+    GstElement ** element)
+{
+  if (track->priv->pool == NULL || !object_is_virtualizable (tckobj))
+    return NULL;
+
+  return element_pool_pop (track->priv->pool, G_OBJECT_TYPE (tckobj),
+      source_uri (tckobj), track->priv->caps, element);
+}
+
+static void
+materialize_window_bounds (GESTrackPrivate * priv, GstClockTime * start,
+    GstClockTime * end)
+{
+  if (priv->playhead > priv->materialize_window)
+    *start = priv->playhead - priv->materialize_window;
+  else
+    *start = 0;
+
+  if (G_MAXUINT64 - priv->playhead > priv->materialize_window)
+    *end = priv->playhead + priv->materialize_window + 1;
+  else
+    *end = G_MAXUINT64;
+}
+
+gboolean
+track_wants_materialized (GESTrack * track, GESTrackObject * tckobj)
+{
+  GstClockTime start, end, wstart, wend;
+  GESTrackPrivate *priv = track->priv;
+
+  if (!GST_CLOCK_TIME_IS_VALID (priv->materialize_window) ||
+      !object_is_virtualizable (tckobj))
+    return TRUE;
+
+  materialize_window_bounds (priv, &wstart, &wend);
+
+  /* The object might not be in the track yet, use its pending values */
+  start = ges_track_object_get_start (tckobj);
+  end = start + ges_track_object_get_duration (tckobj);
+
+  return start < wend && end > wstart;
+}
+
+static void
+materialize_object (GESTrack * track, GESTrackObject * tckobj)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  if (g_hash_table_lookup (priv->materialized, tckobj))
+    return;
+
+  if (!track_object_materialize (tckobj)) {
+    GST_WARNING_OBJECT (track, "Could not materialize %p", tckobj);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (track, "Materializing %p", tckobj);
+
+  if (G_UNLIKELY (!gst_bin_add (GST_BIN (priv->composition),
+              ges_track_object_get_gnlobject (tckobj)))) {
+    GST_WARNING ("Couldn't add object to the GnlComposition");
+    return;
   }
+
+  g_hash_table_insert (priv->materialized, tckobj, tckobj);
+}
+
+static void
+release_object (GESTrack * track, GESTrackObject * tckobj)
+{
+  GstElement *gnlobject;
+  GESTrackPrivate *priv = track->priv;
+
+  if (!g_hash_table_remove (priv->materialized, tckobj))
+    return;
+
+  GST_DEBUG_OBJECT (track, "Releasing %p", tckobj);
+
+  gnlobject = ges_track_object_get_gnlobject (tckobj);
+  gst_bin_remove (GST_BIN (priv->composition), gnlobject);
+  gst_element_set_state (gnlobject, GST_STATE_NULL);
+
+  pool_gnl_object (track, tckobj);
 }
 
-static inline void
-resort_and_fill_gaps (GESTrack * track)
+static gint
+compare_playhead_distance (GESTrackObject * a, GESTrackObject * b,
+    GESTrackPrivate * priv)
 {
-  g_sequence_sort (track->priv->tckobjs_by_start,
+  GstClockTime da, db, start, end;
+
+  start = GES_TRACK_OBJECT_START (a);
+  end = start + GES_TRACK_OBJECT_DURATION (a);
+  da = priv->playhead < start ? start - priv->playhead :
+      (priv->playhead > end ? priv->playhead - end : 0);
+
+  start = GES_TRACK_OBJECT_START (b);
+  end = start + GES_TRACK_OBJECT_DURATION (b);
+  db = priv->playhead < start ? start - priv->playhead :
+      (priv->playhead > end ? priv->playhead - end : 0);
+
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+/* Makes sure exactly the sources within the window, up to max-materialized
+ * of them, have their gnlobject */
+static void
+update_materialized (GESTrack * track)
+{
+  GList *wanted, *tmp, *unwanted = NULL;
+  GHashTable *keep;
+  GHashTableIter iter;
+  GESTrackObject *tckobj;
+  GstClockTime wstart, wend;
+  GESTrackPrivate *priv = track->priv;
+
+  if (priv->virtual_objects == NULL)
+    return;
+
+  materialize_window_bounds (priv, &wstart, &wend);
+  wanted = interval_tree_get_overlapping (priv->virtual_objects, wstart, wend);
+
+  if (priv->max_materialized && g_list_length (wanted) > priv->max_materialized) {
+    wanted = g_list_sort_with_data (wanted,
+        (GCompareDataFunc) compare_playhead_distance, priv);
+    tmp = g_list_nth (wanted, priv->max_materialized);
+    tmp->prev->next = NULL;
+    tmp->prev = NULL;
+    g_list_free (tmp);
+  }
+
+  keep = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (tmp = wanted; tmp; tmp = tmp->next)
+    g_hash_table_insert (keep, tmp->data, tmp->data);
+
+  /* Release first so the cap holds while materializing */
+  g_hash_table_iter_init (&iter, priv->materialized);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & tckobj, NULL)) {
+    if (!g_hash_table_lookup (keep, tckobj))
+      unwanted = g_list_prepend (unwanted, tckobj);
+  }
+  for (tmp = unwanted; tmp; tmp = tmp->next)
+    release_object (track, tmp->data);
+  g_list_free (unwanted);
+
+  for (tmp = wanted; tmp; tmp = tmp->next)
+    materialize_object (track, tmp->data);
+
+  g_hash_table_unref (keep);
+  g_list_free (wanted);
+}
+
+static void
+update_virtual_object (GESTrack * track, GESTrackObject * tckobj,
+    GstClockTime start, GstClockTime end)
+{
+  GESTrackPrivate *priv = track->priv;
+
+  if (interval_tree_contains (priv->virtual_objects, tckobj))
+    interval_tree_update (priv->virtual_objects, tckobj, start, end, 0);
+  else
+    interval_tree_insert (priv->virtual_objects, tckobj, start, end, 0);
+
+  if (!track_wants_materialized (track, tckobj))
+    release_object (track, tckobj);
+  else if (priv->max_materialized == 0 ||
+      g_hash_table_size (priv->materialized) < priv->max_materialized)
+    materialize_object (track, tckobj);
+  else if (!g_hash_table_lookup (priv->materialized, tckobj))
+    /* Let the cap decide which sources are the closest to the playhead */
+    update_materialized (track);
+}
+
+static void
+track_object_update_position (GESTrack * track, GESTrackObject * tckobj,
+    TrackObjectData * data)
+{
+  GstClockTime start, end;
+  GESTrackPrivate *priv = track->priv;
+
+  g_sequence_sort_changed (data->iter,
       (GCompareDataFunc) objects_start_compare, NULL);
 
-  if (track->priv->updating == TRUE) {
+  start = GES_TRACK_OBJECT_START (tckobj);
+  end = start + GES_TRACK_OBJECT_DURATION (tckobj);
+
+  if (priv->virtual_objects && object_is_virtualizable (tckobj) &&
+      (start != data->start || end != data->end ||
+          !interval_tree_contains (priv->virtual_objects, tckobj)))
+    update_virtual_object (track, tckobj, start, end);
+
+  if (start == data->start && end == data->end)
+    return;
+
+  update_coverage (track, data->start, data->end, -1);
+  update_coverage (track, start, end, 1);
+  data->start = start;
+  data->end = end;
+
+  if (priv->updating == TRUE)
     update_gaps (track);
-  }
+}
+
+static void
+track_object_data_free (TrackObjectData * data)
+{
+  g_slice_free (TrackObjectData, data);
 }
 
 /* callbacks */
@@ -257,25 +727,30 @@ static void
 timeline_duration_changed_cb (GESTimeline * timeline,
     GParamSpec * arg, GESTrack * track)
 {
+  GSequenceIter *last;
   GESTrackPrivate *priv = track->priv;
 
-  /* Remove the last gap on the timeline if not needed anymore */
-  if (priv->updating == TRUE && priv->gaps) {
-    Gap *gap = (Gap *) priv->gaps->data;
-    GstClockTime tl_duration = ges_timeline_get_duration (timeline);
+  /* Only the last gap depends on the timeline duration */
+  if (priv->updating == TRUE) {
+    last = g_sequence_iter_prev (g_sequence_get_end_iter (priv->segments));
 
-    if (gap->start + gap->duration > tl_duration) {
-      free_gap (gap);
-      priv->gaps = g_list_remove (priv->gaps, gap);
-    }
+    segment_update_gap (track, g_sequence_get (last),
+        g_sequence_get_end_iter (priv->segments), NULL);
+    update_background_filler (track);
   }
 }
 
 static void
-sort_track_objects_cb (GESTrackObject * child,
+track_object_changed_cb (GESTrackObject * child,
     GParamSpec * arg G_GNUC_UNUSED, GESTrack * track)
 {
-  resort_and_fill_gaps (track);
+  TrackObjectData *data;
+
+  data = g_hash_table_lookup (track->priv->tckobjs_data, child);
+  if (G_UNLIKELY (data == NULL))
+    return;
+
+  track_object_update_position (track, child, data);
 }
 
 static void
@@ -386,61 +861,29 @@ remove_object_internal (GESTrack * track, GESTrackObject * object)
     gst_element_set_state (gnlobject, GST_STATE_NULL);
   }
 
-  g_signal_handlers_disconnect_by_func (object, sort_track_objects_cb, NULL);
+  g_signal_handlers_disconnect_by_func (object, track_object_changed_cb,
+      track);
+
+  if (priv->virtual_objects) {
+    interval_tree_remove (priv->virtual_objects, object);
+    g_hash_table_remove (priv->materialized, object);
+  }
 
   ges_track_object_set_track (object, NULL);
 
   g_signal_emit (track, ges_track_signals[TRACK_OBJECT_REMOVED], 0,
       GES_TRACK_OBJECT (object));
 
+  /* While sources are virtualized, a source of the same file added or
+   * materialized later can reuse the elements */
+  if (priv->pool && object_is_virtualizable (object))
+    pool_gnl_object (track, object);
+
   g_object_unref (object);
 
   return TRUE;
 }
 
-static GSequenceIter *
-lookup_trackobj_it (GSequence * seq, GESTrackObject * object)
-{
-  GSequenceIter *iter, *tmpiter;
-  GESTrackObject *found, *tmptckobj;
-
-  iter = g_sequence_lookup (seq, object,
-      (GCompareDataFunc) objects_start_compare, NULL);
-
-  found = g_sequence_get (iter);
-
-  /* We have the same TrackObject so we are all fine */
-  if (found == object)
-    return iter;
-
-  if (!g_sequence_iter_is_end (iter)) {
-    /* Looking frontward for the good TrackObject */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_next (tmpiter))) {
-      if (g_sequence_iter_is_end (tmpiter))
-        break;
-
-      tmptckobj = g_sequence_get (tmpiter);
-      if (tmptckobj == object)
-        return tmpiter;
-    }
-  }
-
-  if (!g_sequence_iter_is_begin (iter)) {
-    /* Looking backward for the good TrackObject */
-    tmpiter = iter;
-    while ((tmpiter = g_sequence_iter_prev (tmpiter))) {
-      tmptckobj = g_sequence_get (tmpiter);
-      if (tmptckobj == object)
-        return tmpiter;
-    }
-  }
-
-  GST_ERROR_OBJECT (object, "TrackObject not found this should never happen");
-
-  return NULL;
-}
-
 static void
 dispose_tckobjs_foreach (GESTrackObject * tckobj, GESTrack * track)
 {
@@ -469,6 +912,18 @@ ges_track_get_property (GObject * object, guint property_id,
     case ARG_DURATION:
       g_value_set_uint64 (value, track->priv->duration);
       break;
+    case ARG_USE_BACKGROUND_FILLER:
+      g_value_set_boolean (value, track->priv->use_background_filler);
+      break;
+    case ARG_MATERIALIZE_WINDOW:
+      g_value_set_uint64 (value, track->priv->materialize_window);
+      break;
+    case ARG_MAX_MATERIALIZED:
+      g_value_set_uint (value, track->priv->max_materialized);
+      break;
+    case ARG_PLAYHEAD:
+      g_value_set_uint64 (value, track->priv->playhead);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -487,6 +942,18 @@ ges_track_set_property (GObject * object, guint property_id,
     case ARG_TYPE:
       track->type = g_value_get_flags (value);
       break;
+    case ARG_USE_BACKGROUND_FILLER:
+      ges_track_set_use_background_filler (track, g_value_get_boolean (value));
+      break;
+    case ARG_MATERIALIZE_WINDOW:
+      ges_track_set_materialize_window (track, g_value_get_uint64 (value));
+      break;
+    case ARG_MAX_MATERIALIZED:
+      ges_track_set_max_materialized (track, g_value_get_uint (value));
+      break;
+    case ARG_PLAYHEAD:
+      ges_track_set_playhead (track, g_value_get_uint64 (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
   }
@@ -498,11 +965,33 @@ ges_track_dispose (GObject * object)
   GESTrack *track = (GESTrack *) object;
   GESTrackPrivate *priv = track->priv;
 
+  /* No need to keep the elements of the objects we remove */
+  if (priv->pool) {
+    element_pool_free (priv->pool);
+    priv->pool = NULL;
+  }
+
   /* Remove all TrackObjects and drop our reference */
   g_sequence_foreach (track->priv->tckobjs_by_start,
       (GFunc) dispose_tckobjs_foreach, track);
   g_sequence_free (priv->tckobjs_by_start);
-  g_list_free_full (priv->gaps, (GDestroyNotify) free_gap);
+  g_hash_table_unref (priv->tckobjs_data);
+
+  if (priv->virtual_objects) {
+    interval_tree_free (priv->virtual_objects);
+    priv->virtual_objects = NULL;
+  }
+  if (priv->materialized) {
+    g_hash_table_unref (priv->materialized);
+    priv->materialized = NULL;
+  }
+
+  /* Removes the gaps from the composition */
+  g_sequence_free (priv->segments);
+  if (priv->filler) {
+    free_gap (priv->filler);
+    priv->filler = NULL;
+  }
 
   if (priv->composition) {
     gst_bin_remove (GST_BIN (object), priv->composition);
@@ -579,6 +1068,72 @@ ges_track_class_init (GESTrackClass * klass)
   g_object_class_install_property (object_class, ARG_TYPE,
       properties[ARG_TYPE]);
 
+  /**
+   * GESTrack:use-background-filler
+   *
+   * Whether the gaps of the track are filled by a single element placed below
+   * all the other objects and spanning the whole track, instead of one
+   * element per gap. The element is created with the function set with
+   * #ges_track_set_create_element_for_gap_func.
+   *
+   * Default value: %FALSE
+   */
+  properties[ARG_USE_BACKGROUND_FILLER] =
+      g_param_spec_boolean ("use-background-filler", "Use background filler",
+      "Fill the gaps with a single element spanning the whole track", FALSE,
+      G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_USE_BACKGROUND_FILLER,
+      properties[ARG_USE_BACKGROUND_FILLER]);
+
+  /**
+   * GESTrack:materialize-window
+   *
+   * When set, the file and image sources of the track only have their
+   * elements while they are within this distance of the
+   * #GESTrack:playhead. The other ones only keep their timing. The elements
+   * given up by those sources, or by the ones removed from the track, are
+   * kept for a while and reused by sources of the same file. Set to
+   * #GST_CLOCK_TIME_NONE to keep the elements of all the objects.
+   *
+   * Default value: #GST_CLOCK_TIME_NONE
+   */
+  properties[ARG_MATERIALIZE_WINDOW] =
+      g_param_spec_uint64 ("materialize-window", "Materialize window",
+      "Distance from the playhead within which sources have their elements",
+      0, G_MAXUINT64, GST_CLOCK_TIME_NONE, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_MATERIALIZE_WINDOW,
+      properties[ARG_MATERIALIZE_WINDOW]);
+
+  /**
+   * GESTrack:max-materialized
+   *
+   * The maximum number of sources having their elements when
+   * #GESTrack:materialize-window is set, the closest ones to the playhead
+   * being kept. 0 means no limit.
+   *
+   * Default value: 0
+   */
+  properties[ARG_MAX_MATERIALIZED] =
+      g_param_spec_uint ("max-materialized", "Max materialized",
+      "Maximum number of sources having their elements (0 = no limit)",
+      0, G_MAXUINT, 0, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_MAX_MATERIALIZED,
+      properties[ARG_MAX_MATERIALIZED]);
+
+  /**
+   * GESTrack:playhead
+   *
+   * The playback or rendering position around which sources have their
+   * elements when #GESTrack:materialize-window is set.
+   *
+   * Default value: 0
+   */
+  properties[ARG_PLAYHEAD] = g_param_spec_uint64 ("playhead", "Playhead",
+      "The position around which sources have their elements", 0,
+      G_MAXUINT64, 0, G_PARAM_READWRITE);
+  g_object_class_install_property (object_class, ARG_PLAYHEAD,
+      properties[ARG_PLAYHEAD]);
+
   /**
    * GESTrack::track-object-added
    * @object: the #GESTrack
@@ -617,8 +1172,18 @@ ges_track_init (GESTrack * self)
   self->priv->composition = gst_element_factory_make ("gnlcomposition", NULL);
   self->priv->updating = TRUE;
   self->priv->tckobjs_by_start = g_sequence_new (NULL);
+  self->priv->tckobjs_data = g_hash_table_new_full (g_direct_hash,
+      g_direct_equal, NULL, (GDestroyNotify) track_object_data_free);
   self->priv->create_element_for_gaps = NULL;
-  self->priv->gaps = NULL;
+  self->priv->materialize_window = GST_CLOCK_TIME_NONE;
+  self->priv->playhead = 0;
+  self->priv->max_materialized = 0;
+
+  /* Nothing is covered yet */
+  self->priv->segments = g_sequence_new ((GDestroyNotify) free_segment);
+  g_sequence_append (self->priv->segments, g_slice_new0 (Segment));
+  self->priv->dirty_start = 0;
+  self->priv->dirty_end = 0;
 
   g_signal_connect (G_OBJECT (self->priv->composition), "notify::duration",
       G_CALLBACK (composition_duration_cb), self);
@@ -746,6 +1311,9 @@ ges_track_set_caps (GESTrack * track, const GstCaps * caps)
     gst_caps_unref (priv->caps);
   priv->caps = gst_caps_copy (caps);
 
+  /* The released elements were made for the previous caps */
+  element_pool_clear (priv->pool);
+
   g_object_set (priv->composition, "caps", caps, NULL);
   /* FIXME : update all trackobjects ? */
 }
@@ -766,11 +1334,16 @@ ges_track_set_caps (GESTrack * track, const GstCaps * caps)
 gboolean
 ges_track_add_object (GESTrack * track, GESTrackObject * object)
 {
+  TrackObjectData *data;
+  GESTrackPrivate *priv;
+
   g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
   g_return_val_if_fail (GES_IS_TRACK_OBJECT (object), FALSE);
 
   GST_DEBUG ("track:%p, object:%p", track, object);
 
+  priv = track->priv;
+
   if (G_UNLIKELY (ges_track_object_get_track (object) != NULL)) {
     GST_WARNING ("Object already belongs to another track");
     return FALSE;
@@ -781,33 +1354,43 @@ ges_track_add_object (GESTrack * track, GESTrackObject * object)
     return FALSE;
   }
 
-  GST_DEBUG ("Adding object %s to ourself %s",
-      GST_OBJECT_NAME (ges_track_object_get_gnlobject (object)),
-      GST_OBJECT_NAME (track->priv->composition));
+  /* Sources far from the playhead do not get a gnlobject */
+  if (ges_track_object_get_gnlobject (object)) {
+    GST_DEBUG ("Adding object %s to ourself %s",
+        GST_OBJECT_NAME (ges_track_object_get_gnlobject (object)),
+        GST_OBJECT_NAME (track->priv->composition));
 
-  if (G_UNLIKELY (!gst_bin_add (GST_BIN (track->priv->composition),
-              ges_track_object_get_gnlobject (object)))) {
-    GST_WARNING ("Couldn't add object to the GnlComposition");
-    return FALSE;
+    if (G_UNLIKELY (!gst_bin_add (GST_BIN (track->priv->composition),
+                ges_track_object_get_gnlobject (object)))) {
+      GST_WARNING ("Couldn't add object to the GnlComposition");
+      return FALSE;
+    }
+
+    if (priv->virtual_objects && object_is_virtualizable (object))
+      g_hash_table_insert (priv->materialized, object, object);
   }
 
   g_object_ref_sink (object);
-  g_sequence_insert_sorted (track->priv->tckobjs_by_start, object,
+
+  data = g_slice_new (TrackObjectData);
+  data->iter = g_sequence_insert_sorted (priv->tckobjs_by_start, object,
       (GCompareDataFunc) objects_start_compare, NULL);
+  data->start = data->end = 0;
+  g_hash_table_insert (priv->tckobjs_data, object, data);
 
   g_signal_emit (track, ges_track_signals[TRACK_OBJECT_ADDED], 0,
       GES_TRACK_OBJECT (object));
 
   g_signal_connect (GES_TRACK_OBJECT (object), "notify::start",
-      G_CALLBACK (sort_track_objects_cb), track);
+      G_CALLBACK (track_object_changed_cb), track);
 
   g_signal_connect (GES_TRACK_OBJECT (object), "notify::duration",
-      G_CALLBACK (sort_track_objects_cb), track);
+      G_CALLBACK (track_object_changed_cb), track);
 
   g_signal_connect (GES_TRACK_OBJECT (object), "notify::priority",
-      G_CALLBACK (sort_track_objects_cb), track);
+      G_CALLBACK (track_object_changed_cb), track);
 
-  resort_and_fill_gaps (track);
+  track_object_update_position (track, object, data);
 
   return TRUE;
 }
@@ -851,7 +1434,7 @@ ges_track_get_objects (GESTrack * track)
 gboolean
 ges_track_remove_object (GESTrack * track, GESTrackObject * object)
 {
-  GSequenceIter *it;
+  TrackObjectData *data;
   GESTrackPrivate *priv;
 
   g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
@@ -859,11 +1442,19 @@ ges_track_remove_object (GESTrack * track, GESTrackObject * object)
 
   priv = track->priv;
 
+  data = g_hash_table_lookup (priv->tckobjs_data, object);
+  if (G_UNLIKELY (data == NULL)) {
+    GST_WARNING_OBJECT (track, "Object %p not in the track", object);
+    return FALSE;
+  }
+
   if (remove_object_internal (track, object) == TRUE) {
-    it = lookup_trackobj_it (priv->tckobjs_by_start, object);
-    g_sequence_remove (it);
+    update_coverage (track, data->start, data->end, -1);
+    g_sequence_remove (data->iter);
+    g_hash_table_remove (priv->tckobjs_data, object);
 
-    resort_and_fill_gaps (track);
+    if (priv->updating == TRUE)
+      update_gaps (track);
 
     return TRUE;
   }
@@ -928,7 +1519,7 @@ ges_track_enable_update (GESTrack * track, gboolean enabled)
   track->priv->updating = update;
 
   if (update == TRUE)
-    resort_and_fill_gaps (track);
+    update_gaps (track);
 
   return update == enabled;
 }
@@ -968,3 +1559,226 @@ ges_track_set_create_element_for_gap_func (GESTrack * track,
 
   track->priv->create_element_for_gaps = func;
 }
+
+/**
+ * ges_track_set_use_background_filler:
+ * @track: a #GESTrack
+ * @use_filler: Whether to use a single background filler
+ *
+ * Sets whether the gaps of @track should be filled by a single element placed
+ * below every other object and spanning the whole track, instead of creating
+ * one element for each gap. This keeps the number of elements in the track
+ * constant however fragmented it is.
+ */
+void
+ges_track_set_use_background_filler (GESTrack * track, gboolean use_filler)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+
+  if (priv->use_background_filler == use_filler)
+    return;
+
+  priv->use_background_filler = use_filler;
+
+  /* All the gaps have to be recomputed */
+  priv->dirty_start = 0;
+  priv->dirty_end = G_MAXUINT64;
+  if (priv->updating == TRUE)
+    update_gaps (track);
+
+  g_object_notify_by_pspec (G_OBJECT (track),
+      properties[ARG_USE_BACKGROUND_FILLER]);
+}
+
+/**
+ * ges_track_get_use_background_filler:
+ * @track: a #GESTrack
+ *
+ * Get whether the gaps of @track are filled by a single background filler.
+ *
+ * Returns: %TRUE if @track uses a single background filler, else %FALSE.
+ */
+gboolean
+ges_track_get_use_background_filler (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), FALSE);
+
+  return track->priv->use_background_filler;
+}
+
+static void
+add_virtual_object_foreach (GESTrackObject * tckobj, GESTrack * track)
+{
+  GstClockTime start;
+
+  if (!object_is_virtualizable (tckobj))
+    return;
+
+  start = GES_TRACK_OBJECT_START (tckobj);
+  interval_tree_insert (track->priv->virtual_objects, tckobj, start,
+      start + GES_TRACK_OBJECT_DURATION (tckobj), 0);
+
+  if (ges_track_object_get_gnlobject (tckobj))
+    g_hash_table_insert (track->priv->materialized, tckobj, tckobj);
+}
+
+static void
+materialize_virtual_object_foreach (GESTrackObject * tckobj, GESTrack * track)
+{
+  if (object_is_virtualizable (tckobj))
+    materialize_object (track, tckobj);
+}
+
+/**
+ * ges_track_set_materialize_window:
+ * @track: a #GESTrack
+ * @window: the distance from the playhead, or #GST_CLOCK_TIME_NONE
+ *
+ * Sets the distance from the #GESTrack:playhead within which the file and
+ * image sources of @track have their elements. The other ones only keep
+ * their timing until the playhead gets close to them, which keeps the
+ * number of elements of long timelines bounded.
+ *
+ * Setting #GST_CLOCK_TIME_NONE gives their elements back to all the sources.
+ */
+void
+ges_track_set_materialize_window (GESTrack * track, GstClockTime window)
+{
+  GESTrackPrivate *priv;
+
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  priv = track->priv;
+
+  if (priv->materialize_window == window)
+    return;
+
+  priv->materialize_window = window;
+
+  if (GST_CLOCK_TIME_IS_VALID (window)) {
+    if (priv->virtual_objects == NULL) {
+      priv->virtual_objects = interval_tree_new (NULL);
+      priv->materialized = g_hash_table_new (g_direct_hash, g_direct_equal);
+      priv->pool = element_pool_new (POOL_SIZE);
+      g_sequence_foreach (priv->tckobjs_by_start,
+          (GFunc) add_virtual_object_foreach, track);
+    }
+
+    update_materialized (track);
+  } else if (priv->virtual_objects) {
+    g_sequence_foreach (priv->tckobjs_by_start,
+        (GFunc) materialize_virtual_object_foreach, track);
+
+    interval_tree_free (priv->virtual_objects);
+    priv->virtual_objects = NULL;
+    g_hash_table_unref (priv->materialized);
+    priv->materialized = NULL;
+    element_pool_free (priv->pool);
+    priv->pool = NULL;
+  }
+
+  g_object_notify_by_pspec (G_OBJECT (track),
+      properties[ARG_MATERIALIZE_WINDOW]);
+}
+
+/**
+ * ges_track_get_materialize_window:
+ * @track: a #GESTrack
+ *
+ * Get the distance from the playhead within which the sources of @track
+ * have their elements.
+ *
+ * Returns: the materialize window of @track, #GST_CLOCK_TIME_NONE if all
+ * the sources have their elements.
+ */
+GstClockTime
+ges_track_get_materialize_window (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), GST_CLOCK_TIME_NONE);
+
+  return track->priv->materialize_window;
+}
+
+/**
+ * ges_track_set_max_materialized:
+ * @track: a #GESTrack
+ * @max_materialized: the maximum number of sources with elements, or 0
+ *
+ * Sets the maximum number of sources having their elements when a
+ * materialize window is set, the closest ones to the playhead being kept.
+ * 0 means no limit.
+ */
+void
+ges_track_set_max_materialized (GESTrack * track, guint max_materialized)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+
+  if (track->priv->max_materialized == max_materialized)
+    return;
+
+  track->priv->max_materialized = max_materialized;
+  update_materialized (track);
+
+  g_object_notify_by_pspec (G_OBJECT (track),
+      properties[ARG_MAX_MATERIALIZED]);
+}
+
+/**
+ * ges_track_get_max_materialized:
+ * @track: a #GESTrack
+ *
+ * Get the maximum number of sources having their elements.
+ *
+ * Returns: the maximum number of sources with elements, 0 if unlimited.
+ */
+guint
+ges_track_get_max_materialized (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), 0);
+
+  return track->priv->max_materialized;
+}
+
+/**
+ * ges_track_set_playhead:
+ * @track: a #GESTrack
+ * @position: the current playback or rendering position
+ *
+ * Sets the position around which the sources of @track have their elements
+ * when a materialize window is set. The application is expected to update
+ * it as playback progresses or when seeking.
+ */
+void
+ges_track_set_playhead (GESTrack * track, GstClockTime position)
+{
+  g_return_if_fail (GES_IS_TRACK (track));
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (position));
+
+  if (track->priv->playhead == position)
+    return;
+
+  track->priv->playhead = position;
+  update_materialized (track);
+
+  g_object_notify_by_pspec (G_OBJECT (track), properties[ARG_PLAYHEAD]);
+}
+
+/**
+ * ges_track_get_playhead:
+ * @track: a #GESTrack
+ *
+ * Get the position around which the sources of @track have their elements.
+ *
+ * Returns: the playhead of @track.
+ */
+GstClockTime
+ges_track_get_playhead (GESTrack * track)
+{
+  g_return_val_if_fail (GES_IS_TRACK (track), 0);
+
+  return track->priv->playhead;
+}
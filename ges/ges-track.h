@@ -123,6 +123,22 @@ void
 ges_track_set_create_element_for_gap_func (GESTrack *track,
                                            GESCreateElementForGapFunc func);
 
+void ges_track_set_use_background_filler  (GESTrack * track,
+                                           gboolean use_filler);
+gboolean ges_track_get_use_background_filler (GESTrack * track);
+
+void ges_track_set_materialize_window     (GESTrack * track,
+                                           GstClockTime window);
+GstClockTime ges_track_get_materialize_window (GESTrack * track);
+
+void ges_track_set_max_materialized       (GESTrack * track,
+                                           guint max_materialized);
+guint ges_track_get_max_materialized      (GESTrack * track);
+
+void ges_track_set_playhead               (GESTrack * track,
+                                           GstClockTime position);
+GstClockTime ges_track_get_playhead       (GESTrack * track);
+
 G_END_DECLS
 
 #endif /* _GES_TRACK */
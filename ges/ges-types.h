@@ -47,6 +47,9 @@ typedef struct _GESTimelineOperationClass GESTimelineOperationClass;
 typedef struct _GESTimelinePipeline GESTimelinePipeline;
 typedef struct _GESTimelinePipelineClass GESTimelinePipelineClass;
 
+typedef struct _GESParallelRenderer GESParallelRenderer;
+typedef struct _GESParallelRendererClass GESParallelRendererClass;
+
 typedef struct _GESTimelineSource GESTimelineSource;
 typedef struct _GESTimelineSourceClass GESTimelineSourceClass;
 
@@ -31,6 +31,7 @@
 #include <ges/ges-simple-timeline-layer.h>
 #include <ges/ges-timeline-object.h>
 #include <ges/ges-timeline-pipeline.h>
+#include <ges/ges-parallel-renderer.h>
 #include <ges/ges-timeline-source.h>
 #include <ges/ges-timeline-test-source.h>
 #include <ges/ges-timeline-title-source.h>
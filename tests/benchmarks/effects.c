@@ -0,0 +1,119 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the time it takes to move clips which have many effects, in two
+ * tracks, and to change their priority.
+ *
+ * Usage: effects [number of clips] [number of effects per track] [number of edits]
+ */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+
+static gboolean
+fill_track_func (GESTimelineObject * object,
+    GESTrackObject * trobject, GstElement * gnlobj, gpointer user_data)
+{
+  return gst_bin_add (GST_BIN (gnlobj), gst_element_factory_make ("fakesrc",
+          NULL));
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *tracks[2];
+  GESTimelineObject **objects;
+  GstClockTime start_ts, end_ts;
+  guint i, j, k, nb_clips = 100, nb_effects = 10, nb_edits = 100;
+
+  gst_init (&argc, &argv);
+  ges_init ();
+
+  if (argc > 1)
+    nb_clips = MAX (1, atoi (argv[1]));
+  if (argc > 2)
+    nb_effects = MAX (1, atoi (argv[2]));
+  if (argc > 3)
+    nb_edits = MAX (1, atoi (argv[3]));
+
+  timeline = ges_timeline_new ();
+  for (k = 0; k < 2; k++) {
+    tracks[k] = ges_track_new (GES_TRACK_TYPE_CUSTOM, gst_caps_new_any ());
+    ges_timeline_add_track (timeline, tracks[k]);
+  }
+
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  objects = g_new (GESTimelineObject *, nb_clips);
+  for (i = 0; i < nb_clips; i++) {
+    objects[i] =
+        GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (fill_track_func,
+            NULL));
+    g_object_set (objects[i], "start", (guint64) i * GST_SECOND,
+        "duration", (guint64) GST_SECOND, NULL);
+    ges_timeline_layer_add_object (layer, objects[i]);
+  }
+
+  start_ts = gst_util_get_timestamp ();
+  for (i = 0; i < nb_clips; i++) {
+    for (k = 0; k < 2; k++) {
+      for (j = 0; j < nb_effects; j++) {
+        GESTrackObject *effect =
+            GES_TRACK_OBJECT (ges_track_parse_launch_effect_new ("identity"));
+
+        ges_timeline_object_add_track_object (objects[i], effect);
+        ges_track_add_object (tracks[k], effect);
+      }
+    }
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("Added %u effects to %u clips in %" GST_TIME_FORMAT "\n",
+      2 * nb_effects, nb_clips, GST_TIME_ARGS (end_ts - start_ts));
+
+  start_ts = gst_util_get_timestamp ();
+  for (k = 0; k < nb_edits; k++) {
+    for (i = 0; i < nb_clips; i++)
+      ges_timeline_object_set_start (objects[i],
+          (guint64) (i + k % 2) * GST_SECOND);
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("%u start changes in %" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
+      " per change)\n", nb_edits * nb_clips, GST_TIME_ARGS (end_ts - start_ts),
+      GST_TIME_ARGS ((end_ts - start_ts) / (nb_edits * nb_clips)));
+
+  start_ts = gst_util_get_timestamp ();
+  for (k = 0; k < nb_edits; k++) {
+    for (i = 0; i < nb_clips; i++)
+      ges_timeline_object_set_priority (objects[i], k % 2);
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("%u priority changes in %" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
+      " per change)\n", nb_edits * nb_clips, GST_TIME_ARGS (end_ts - start_ts),
+      GST_TIME_ARGS ((end_ts - start_ts) / (nb_edits * nb_clips)));
+
+  g_free (objects);
+  g_object_unref (timeline);
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how many gap filling elements a track creates, and how long it
+ * takes, when moving clips around in a timeline full of gaps.
+ *
+ * Usage: gaps [number of clips] [number of edits]
+ */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+
+static guint gaps_created = 0;
+
+static GstElement *
+create_counted_gap (GESTrack * track)
+{
+  gaps_created++;
+
+  return gst_element_factory_make ("fakesrc", NULL);
+}
+
+static gboolean
+fill_track_func (GESTimelineObject * object,
+    GESTrackObject * trobject, GstElement * gnlobj, gpointer user_data)
+{
+  return gst_bin_add (GST_BIN (gnlobj), gst_element_factory_make ("fakesrc",
+          NULL));
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject **objects;
+  GstClockTime start_ts, end_ts;
+  guint i, nb_clips = 1000, nb_edits = 1000, created;
+
+  gst_init (&argc, &argv);
+  ges_init ();
+
+  if (argc > 1)
+    nb_clips = MAX (1, atoi (argv[1]));
+  if (argc > 2)
+    nb_edits = MAX (1, atoi (argv[2]));
+
+  timeline = ges_timeline_new ();
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, gst_caps_new_any ());
+  ges_track_set_create_element_for_gap_func (track, create_counted_gap);
+  ges_timeline_add_track (timeline, track);
+
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  objects = g_new0 (GESTimelineObject *, nb_clips);
+
+  /* One second long clips separated by one second gaps */
+  start_ts = gst_util_get_timestamp ();
+  for (i = 0; i < nb_clips; i++) {
+    objects[i] =
+        GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (fill_track_func,
+            NULL));
+    g_object_set (objects[i], "start", (guint64) (2 * i + 1) * GST_SECOND,
+        "duration", (guint64) GST_SECOND, NULL);
+    ges_timeline_layer_add_object (layer, objects[i]);
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("Added %u clips in %" GST_TIME_FORMAT ", %u gaps created\n",
+      nb_clips, GST_TIME_ARGS (end_ts - start_ts), gaps_created);
+
+  /* Move the clips inside the gap that precedes them and back */
+  gaps_created = 0;
+  start_ts = gst_util_get_timestamp ();
+  for (i = 0; i < nb_edits; i++) {
+    GESTimelineObject *object = objects[g_random_int_range (0, nb_clips)];
+    GstClockTime start = GES_TIMELINE_OBJECT_START (object);
+
+    if (start % GST_SECOND)
+      start += GST_SECOND / 2;
+    else
+      start -= GST_SECOND / 2;
+
+    ges_timeline_object_set_start (object, start);
+  }
+  end_ts = gst_util_get_timestamp ();
+  created = gaps_created;
+
+  g_print ("%u edits in %" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
+      " per edit), %u gaps created (%.2f per edit)\n", nb_edits,
+      GST_TIME_ARGS (end_ts - start_ts),
+      GST_TIME_ARGS ((end_ts - start_ts) / nb_edits), created,
+      (gdouble) created / nb_edits);
+
+  g_free (objects);
+  g_object_unref (timeline);
+
+  return 0;
+}
@@ -0,0 +1,174 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures how long rendering a timeline takes in a single pipeline, and in
+ * several pipelines running in parallel with a GESParallelRenderer, each one
+ * rendering one of its ranges to its own file.
+ *
+ * The parallel renders only produce unjoined chunks, which still have to be
+ * concatenated into one file, so their time is not comparable with the time
+ * of a complete render.
+ *
+ * Usage: render [number of pipelines] [number of clips] [output directory]
+ */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+#include <gst/pbutils/encoding-profile.h>
+
+#define CLIP_DURATION (2 * GST_SECOND)
+
+static GESTimeline *
+create_timeline (guint nb_clips)
+{
+  guint i;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *object;
+
+  timeline = ges_timeline_new ();
+  ges_timeline_add_track (timeline, ges_track_video_raw_new ());
+  ges_timeline_add_track (timeline, ges_track_audio_raw_new ());
+  layer = ges_timeline_append_layer (timeline);
+
+  for (i = 0; i < nb_clips; i++) {
+    object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+    g_object_set (object, "start", (guint64) i * CLIP_DURATION,
+        "duration", (guint64) CLIP_DURATION,
+        "vpattern", i % 2 ? GES_VIDEO_TEST_PATTERN_SMPTE :
+        GES_VIDEO_TEST_PATTERN_SNOW, NULL);
+    ges_timeline_layer_add_object (layer, object);
+  }
+
+  return timeline;
+}
+
+static GstEncodingProfile *
+create_profile (void)
+{
+  GstCaps *caps;
+  GstEncodingContainerProfile *profile;
+
+  caps = gst_caps_from_string ("application/ogg");
+  profile = gst_encoding_container_profile_new ("render-benchmark", NULL, caps,
+      NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("video/x-theora");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_video_profile_new (caps, NULL, NULL,
+          0));
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("audio/x-vorbis");
+  gst_encoding_container_profile_add_profile (profile,
+      (GstEncodingProfile *) gst_encoding_audio_profile_new (caps, NULL, NULL,
+          0));
+  gst_caps_unref (caps);
+
+  return (GstEncodingProfile *) profile;
+}
+
+static void
+done_cb (GESParallelRenderer * renderer, GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+static void
+error_cb (GESParallelRenderer * renderer, GError * error, GMainLoop * loop)
+{
+  g_printerr ("Error while rendering: %s\n", error->message);
+  g_main_loop_quit (loop);
+}
+
+/* Renders the timeline with a #GESParallelRenderer using @nb_pipelines
+ * pipelines at once, each one encoding its own range */
+static void
+render (guint nb_pipelines, guint nb_clips, const gchar * directory)
+{
+  guint nb_chunks;
+  gchar *uri, **chunks;
+  GESTimeline *timeline;
+  GESParallelRenderer *renderer;
+  GstEncodingProfile *profile;
+  GstClockTime start_ts, end_ts;
+  GMainLoop *loop;
+
+  timeline = create_timeline (nb_clips);
+  renderer = ges_parallel_renderer_new (timeline, nb_pipelines);
+  g_object_unref (timeline);
+
+  uri = g_strdup_printf ("file://%s/render-%u.ogg", directory, nb_pipelines);
+  profile = create_profile ();
+  ges_parallel_renderer_set_render_settings (renderer, uri, profile);
+  gst_encoding_profile_unref (profile);
+  g_free (uri);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (renderer, "done", G_CALLBACK (done_cb), loop);
+  g_signal_connect (renderer, "error", G_CALLBACK (error_cb), loop);
+
+  start_ts = gst_util_get_timestamp ();
+
+  if (!ges_parallel_renderer_start (renderer)) {
+    g_printerr ("Could not start rendering\n");
+    goto done;
+  }
+  g_main_loop_run (loop);
+
+  end_ts = gst_util_get_timestamp ();
+
+  /* There can be less ranges than asked for */
+  chunks = ges_parallel_renderer_get_chunk_uris (renderer);
+  nb_chunks = g_strv_length (chunks);
+  g_strfreev (chunks);
+
+  if (nb_chunks == 1)
+    g_print ("Complete render of %u clips in %" GST_TIME_FORMAT "\n",
+        nb_clips, GST_TIME_ARGS (end_ts - start_ts));
+  else
+    g_print ("%u unjoined chunks of %u clips in %" GST_TIME_FORMAT "\n",
+        nb_chunks, nb_clips, GST_TIME_ARGS (end_ts - start_ts));
+
+done:
+  g_main_loop_unref (loop);
+  g_object_unref (renderer);
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  guint nb_pipelines = 4, nb_clips = 30;
+  const gchar *directory = g_get_tmp_dir ();
+
+  gst_init (&argc, &argv);
+  ges_init ();
+
+  if (argc > 1)
+    nb_pipelines = MAX (1, atoi (argv[1]));
+  if (argc > 2)
+    nb_clips = MAX (1, atoi (argv[2]));
+  if (argc > 3)
+    directory = argv[3];
+
+  render (1, nb_clips, directory);
+  render (nb_pipelines, nb_clips, directory);
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Measures the time it takes to ripple all the clips of a timeline by
+ * moving its first clip back and forth.
+ *
+ * Usage: ripple [number of clips] [number of edits]
+ */
+
+#include <stdlib.h>
+#include <ges/ges.h>
+
+static gboolean
+fill_track_func (GESTimelineObject * object,
+    GESTrackObject * trobject, GstElement * gnlobj, gpointer user_data)
+{
+  return gst_bin_add (GST_BIN (gnlobj), gst_element_factory_make ("fakesrc",
+          NULL));
+}
+
+int
+main (int argc, gchar ** argv)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *first = NULL, *object;
+  GstClockTime start_ts, end_ts;
+  guint i, nb_clips = 10000, nb_edits = 20;
+
+  gst_init (&argc, &argv);
+  ges_init ();
+
+  if (argc > 1)
+    nb_clips = MAX (1, atoi (argv[1]));
+  if (argc > 2)
+    nb_edits = MAX (1, atoi (argv[2]));
+
+  timeline = ges_timeline_new ();
+  ges_timeline_add_track (timeline, ges_track_new (GES_TRACK_TYPE_CUSTOM,
+          gst_caps_new_any ()));
+
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  start_ts = gst_util_get_timestamp ();
+  for (i = 0; i < nb_clips; i++) {
+    object =
+        GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (fill_track_func,
+            NULL));
+    g_object_set (object, "start", (guint64) i * GST_SECOND,
+        "duration", (guint64) GST_SECOND, NULL);
+    ges_timeline_layer_add_object (layer, object);
+
+    if (first == NULL)
+      first = object;
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("Added %u clips in %" GST_TIME_FORMAT "\n", nb_clips,
+      GST_TIME_ARGS (end_ts - start_ts));
+
+  start_ts = gst_util_get_timestamp ();
+  for (i = 0; i < nb_edits; i++) {
+    ges_timeline_object_edit (first, NULL, -1, GES_EDIT_MODE_RIPPLE,
+        GES_EDGE_NONE, i % 2 ? 0 : GST_SECOND);
+  }
+  end_ts = gst_util_get_timestamp ();
+
+  g_print ("%u ripples of %u clips in %" GST_TIME_FORMAT " (%" GST_TIME_FORMAT
+      " per edit)\n", nb_edits, nb_clips, GST_TIME_ARGS (end_ts - start_ts),
+      GST_TIME_ARGS ((end_ts - start_ts) / nb_edits));
+
+  g_object_unref (timeline);
+
+  return 0;
+}
@@ -332,6 +332,167 @@ GST_START_TEST (test_gap_filling_basic)
 
 GST_END_TEST;
 
+static guint gaps_created = 0;
+
+static GstElement *
+create_counted_gap (GESTrack * track)
+{
+  gaps_created++;
+
+  return gst_element_factory_make ("audiotestsrc", NULL);
+}
+
+GST_START_TEST (test_gap_filling_update)
+{
+  GESTrack *track;
+  GESTrackObject *trackobject, *trackobject1;
+  GESTimelineObject *object, *object1;
+  GstElement *gnlsrc, *gnlsrc1, *gap = NULL;
+  GstElement *composition;
+  GList *tmp;
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  fail_unless (track != NULL);
+  ges_track_set_create_element_for_gap_func (track, create_counted_gap);
+  gaps_created = 0;
+
+  composition = find_composition (track);
+  fail_unless (composition != NULL);
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "start", (guint64) 0, "duration", (guint64) 5, NULL);
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_add_object (track, trackobject));
+  gnlsrc = ges_track_object_get_gnlobject (trackobject);
+
+  object1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object1, "start", (guint64) 15, "duration", (guint64) 5, NULL);
+  trackobject1 = ges_timeline_object_create_track_object (object1, track);
+  ges_timeline_object_add_track_object (object1, trackobject1);
+  fail_unless (ges_track_add_object (track, trackobject1));
+  gnlsrc1 = ges_track_object_get_gnlobject (trackobject1);
+
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 1);
+
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    if (tmp->data != gnlsrc && tmp->data != gnlsrc1)
+      gap = GST_ELEMENT (tmp->data);
+  }
+  fail_unless (gap != NULL);
+  gap_object_check (gap, 5, 10, 0);
+
+  /* Moving the object resizes the existing gap */
+  g_object_set (object1, "start", (guint64) 25, NULL);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 1);
+  gap_object_check (gap, 5, 20, 0);
+
+  /* Overlapping objects do not leave any gap */
+  g_object_set (object1, "start", (guint64) 2, NULL);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 2);
+
+  g_object_set (object1, "start", (guint64) 10, NULL);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 2);
+
+  gap = NULL;
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    if (tmp->data != gnlsrc && tmp->data != gnlsrc1)
+      gap = GST_ELEMENT (tmp->data);
+  }
+  fail_unless (gap != NULL);
+  gap_object_check (gap, 5, 5, 0);
+
+  /* Gaps are only updated once the track updates again */
+  fail_unless (ges_track_enable_update (track, FALSE));
+  g_object_set (object1, "start", (guint64) 30, NULL);
+  gap_object_check (gap, 5, 5, 0);
+  fail_unless (ges_track_enable_update (track, TRUE));
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 2);
+  gap_object_check (gap, 5, 25, 0);
+
+  /* Removing the object removes the gap before it */
+  g_object_ref (trackobject1);
+  fail_unless (ges_track_remove_object (track, trackobject1));
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 1);
+
+  g_object_unref (trackobject1);
+  gst_object_unref (track);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_gap_filling_background)
+{
+  GESTrack *track;
+  GESTrackObject *trackobject, *trackobject1;
+  GESTimelineObject *object, *object1;
+  GstElement *gnlsrc, *gnlsrc1, *filler = NULL;
+  GstElement *composition;
+  GList *tmp;
+  guint64 start, duration;
+  guint priority;
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  fail_unless (track != NULL);
+  ges_track_set_create_element_for_gap_func (track, create_counted_gap);
+  ges_track_set_use_background_filler (track, TRUE);
+  fail_unless (ges_track_get_use_background_filler (track));
+  gaps_created = 0;
+
+  composition = find_composition (track);
+  fail_unless (composition != NULL);
+
+  object = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object, "start", (guint64) 10, "duration", (guint64) 5, NULL);
+  trackobject = ges_timeline_object_create_track_object (object, track);
+  ges_timeline_object_add_track_object (object, trackobject);
+  fail_unless (ges_track_add_object (track, trackobject));
+  gnlsrc = ges_track_object_get_gnlobject (trackobject);
+
+  object1 = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (object1, "start", (guint64) 25, "duration", (guint64) 5, NULL);
+  trackobject1 = ges_timeline_object_create_track_object (object1, track);
+  ges_timeline_object_add_track_object (object1, trackobject1);
+  fail_unless (ges_track_add_object (track, trackobject1));
+  gnlsrc1 = ges_track_object_get_gnlobject (trackobject1);
+
+  /* Only one filler for the two gaps */
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 1);
+
+  for (tmp = GST_BIN_CHILDREN (composition); tmp; tmp = tmp->next) {
+    if (tmp->data != gnlsrc && tmp->data != gnlsrc1)
+      filler = GST_ELEMENT (tmp->data);
+  }
+  fail_unless (filler != NULL);
+  g_object_get (filler, "priority", &priority, NULL);
+  assert_equals_int (priority, G_MAXUINT32);
+
+  /* The filler follows the end of the track */
+  g_object_set (object1, "start", (guint64) 45, NULL);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 3);
+  assert_equals_int (gaps_created, 1);
+  g_object_get (filler, "start", &start, "duration", &duration, NULL);
+  assert_equals_uint64 (start, 0);
+  assert_equals_uint64 (duration, 50);
+
+  /* Going back to one gap per hole */
+  ges_track_set_use_background_filler (track, FALSE);
+  assert_equals_int (g_list_length (GST_BIN_CHILDREN (composition)), 4);
+
+  gst_object_unref (track);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -344,6 +505,8 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_test_source_properties);
   tcase_add_test (tc_chain, test_test_source_in_layer);
   tcase_add_test (tc_chain, test_gap_filling_basic);
+  tcase_add_test (tc_chain, test_gap_filling_update);
+  tcase_add_test (tc_chain, test_gap_filling_background);
 
   return s;
 }
@@ -568,6 +568,305 @@ GST_START_TEST (test_ges_timeline_remove_track)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ges_timeline_discovery_concurrency)
+{
+  guint concurrency;
+  GESTimeline *timeline;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+
+  g_object_get (timeline, "discovery-concurrency", &concurrency, NULL);
+  assert_equals_int (concurrency, 1);
+
+  g_object_set (timeline, "discovery-concurrency", 4, NULL);
+  g_object_get (timeline, "discovery-concurrency", &concurrency, NULL);
+  assert_equals_int (concurrency, 4);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Sources whose discovery fails right away, so that no media is needed */
+#define MISSING_URI "file:///nonexistent/ges-discovery-%u.ogg"
+
+typedef struct
+{
+  GMainLoop *loop;
+  GstElement *pipeline;
+  guint discovered;
+  guint async_done;
+  GList *failed;
+} DiscoveryData;
+
+static gboolean
+discovered_hook (GSignalInvocationHint * hint, guint n_values,
+    const GValue * values, gpointer user_data)
+{
+  ((DiscoveryData *) user_data)->discovered++;
+
+  return TRUE;
+}
+
+static void
+discovery_error_cb (GESTimeline * timeline, GESTimelineFileSource * tfs,
+    GError * error, DiscoveryData * data)
+{
+  data->failed = g_list_prepend (data->failed, tfs);
+}
+
+static gboolean
+discovery_bus_cb (GstBus * bus, GstMessage * message, DiscoveryData * data)
+{
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_ASYNC_DONE &&
+      GST_MESSAGE_SRC (message) == GST_OBJECT (data->pipeline)) {
+    data->async_done++;
+    g_main_loop_quit (data->loop);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+discovery_timeout_cb (DiscoveryData * data)
+{
+  fail ("Discovery did not finish");
+  g_main_loop_quit (data->loop);
+
+  return FALSE;
+}
+
+/* Prerolls @timeline, returning once the pipeline posted ASYNC_DONE and
+ * everything pending on the main context was dispatched */
+static void
+run_discovery (GESTimeline * timeline, DiscoveryData * data)
+{
+  GstBus *bus;
+  gulong hook;
+  guint signal_id, watch, timeout;
+
+  g_type_class_unref (g_type_class_ref (GST_TYPE_DISCOVERER));
+  signal_id = g_signal_lookup ("discovered", GST_TYPE_DISCOVERER);
+  hook = g_signal_add_emission_hook (signal_id, 0, discovered_hook, data,
+      NULL);
+  g_signal_connect (timeline, "discovery-error",
+      G_CALLBACK (discovery_error_cb), data);
+
+  data->loop = g_main_loop_new (NULL, FALSE);
+  data->pipeline = gst_pipeline_new (NULL);
+  gst_bin_add (GST_BIN (data->pipeline), GST_ELEMENT (timeline));
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (data->pipeline));
+  watch = gst_bus_add_watch (bus, (GstBusFunc) discovery_bus_cb, data);
+
+  /* The sources are not discovered yet */
+  fail_unless_equals_int (gst_element_set_state (data->pipeline,
+          GST_STATE_PAUSED), GST_STATE_CHANGE_ASYNC);
+
+  timeout = g_timeout_add_seconds (10, (GSourceFunc) discovery_timeout_cb,
+      data);
+  g_main_loop_run (data->loop);
+  g_source_remove (timeout);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  gst_element_set_state (data->pipeline, GST_STATE_NULL);
+  g_source_remove (watch);
+  gst_object_unref (bus);
+  g_signal_remove_emission_hook (signal_id, hook);
+  g_main_loop_unref (data->loop);
+}
+
+GST_START_TEST (test_ges_timeline_discovery_workers)
+{
+  guint i;
+  gchar *uri;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *sources[6];
+  DiscoveryData data = { NULL, };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  g_object_set (timeline, "discovery-concurrency", 3, NULL);
+  layer = ges_timeline_append_layer (timeline);
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+    uri = g_strdup_printf (MISSING_URI, i);
+    sources[i] = ges_timeline_filesource_new (uri);
+    g_free (uri);
+    fail_unless (ges_timeline_layer_add_object (layer,
+            GES_TIMELINE_OBJECT (sources[i])));
+  }
+
+  run_discovery (timeline, &data);
+
+  /* Each URI was discovered once, and the timeline was only done once all
+   * of the discoverers were */
+  assert_equals_int (data.discovered, G_N_ELEMENTS (sources));
+  assert_equals_int (g_list_length (data.failed), G_N_ELEMENTS (sources));
+  assert_equals_int (data.async_done, 1);
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    fail_unless (g_list_find (data.failed, sources[i]));
+
+  g_list_free (data.failed);
+  gst_object_unref (data.pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ges_timeline_discovery_shared_uri)
+{
+  guint i;
+  gchar *uri;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineFileSource *sources[3];
+  DiscoveryData data = { NULL, };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  g_object_set (timeline, "discovery-concurrency", 2, NULL);
+  layer = ges_timeline_append_layer (timeline);
+
+  uri = g_strdup_printf (MISSING_URI, 0);
+  for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+    sources[i] = ges_timeline_filesource_new (uri);
+    g_object_ref (sources[i]);
+    fail_unless (ges_timeline_layer_add_object (layer,
+            GES_TIMELINE_OBJECT (sources[i])));
+  }
+  g_free (uri);
+
+  /* A source removed while waiting for the discovery is not told about it */
+  fail_unless (ges_timeline_layer_remove_object (layer,
+          GES_TIMELINE_OBJECT (sources[1])));
+
+  run_discovery (timeline, &data);
+
+  /* The URI was only discovered once, and the error was given to each of
+   * the sources still waiting for it */
+  assert_equals_int (data.discovered, 1);
+  assert_equals_int (g_list_length (data.failed), 2);
+  fail_unless (g_list_find (data.failed, sources[0]));
+  fail_if (g_list_find (data.failed, sources[1]));
+  fail_unless (g_list_find (data.failed, sources[2]));
+  assert_equals_int (data.async_done, 1);
+
+  g_list_free (data.failed);
+  gst_object_unref (data.pipeline);
+  for (i = 0; i < G_N_ELEMENTS (sources); i++)
+    g_object_unref (sources[i]);
+}
+
+GST_END_TEST;
+
+typedef struct
+{
+  GMainLoop *loop;
+  GThread *thread;
+  GArray *timestamps;
+  guint n_samples;
+  guint notified;
+} ThumbnailData;
+
+static void
+thumbnail_cb (GESTimeline * timeline, GstClockTime timestamp,
+    GstSample * sample, ThumbnailData * data)
+{
+  /* Delivered from the main context, before the notification */
+  fail_unless (g_thread_self () == data->thread);
+  assert_equals_int (data->notified, 0);
+
+  /* Only the timestamps past the end of the timeline have no frame */
+  fail_unless ((sample == NULL) == (timestamp >= GST_SECOND));
+  if (sample) {
+    fail_unless (gst_sample_get_buffer (sample) != NULL);
+    data->n_samples++;
+  }
+
+  g_array_append_val (data->timestamps, timestamp);
+}
+
+static void
+thumbnail_notify (ThumbnailData * data)
+{
+  data->notified++;
+  g_main_loop_quit (data->loop);
+}
+
+static gboolean
+thumbnail_timeout_cb (ThumbnailData * data)
+{
+  fail ("The thumbnails were not delivered");
+  g_main_loop_quit (data->loop);
+
+  return FALSE;
+}
+
+GST_START_TEST (test_ges_timeline_get_thumbnails)
+{
+  guint timeout;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *source;
+  ThumbnailData data = { NULL, };
+  const GstClockTime timestamps[] = { 3 * GST_SECOND, GST_SECOND / 2, 0,
+    GST_SECOND
+  };
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  fail_unless (ges_timeline_add_track (timeline, ges_track_audio_raw_new ()));
+  layer = ges_timeline_append_layer (timeline);
+
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", GST_SECOND, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (source)));
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.thread = g_thread_self ();
+  data.timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  fail_unless (ges_timeline_get_thumbnails (timeline, timestamps,
+          G_N_ELEMENTS (timestamps), NULL,
+          (GESTimelineThumbnailCallback) thumbnail_cb, &data,
+          (GDestroyNotify) thumbnail_notify));
+
+  timeout = g_timeout_add_seconds (10, (GSourceFunc) thumbnail_timeout_cb,
+      &data);
+  g_main_loop_run (data.loop);
+  g_source_remove (timeout);
+
+  /* Nothing is delivered after the notification */
+  while (g_main_context_iteration (NULL, FALSE));
+
+  assert_equals_int (data.notified, 1);
+  assert_equals_int (data.n_samples, 2);
+  assert_equals_int (data.timestamps->len, G_N_ELEMENTS (timestamps));
+  fail_unless_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 0),
+      0);
+  fail_unless_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 1),
+      GST_SECOND / 2);
+  fail_unless_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 2),
+      GST_SECOND);
+  fail_unless_equals_uint64 (g_array_index (data.timestamps, GstClockTime, 3),
+      3 * GST_SECOND);
+
+  g_array_free (data.timestamps, TRUE);
+  g_main_loop_unref (data.loop);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -581,6 +880,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_ges_timeline_add_layer);
   tcase_add_test (tc_chain, test_ges_timeline_add_layer_first);
   tcase_add_test (tc_chain, test_ges_timeline_remove_track);
+  tcase_add_test (tc_chain, test_ges_timeline_discovery_concurrency);
+  tcase_add_test (tc_chain, test_ges_timeline_discovery_workers);
+  tcase_add_test (tc_chain, test_ges_timeline_discovery_shared_uri);
+  tcase_add_test (tc_chain, test_ges_timeline_get_thumbnails);
 
   return s;
 }
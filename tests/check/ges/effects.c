@@ -331,6 +331,7 @@ GST_START_TEST (test_track_effect_set_properties)
   guint scratch_line, n_props, i;
   gboolean color_aging;
   GParamSpec **pspecs, *spec;
+  GESChildProperty *prop;
   GValue val = { 0 };
   GValue nval = { 0 };
 
@@ -381,6 +382,19 @@ GST_START_TEST (test_track_effect_set_properties)
   ges_track_object_get_child_property_by_pspec (tck_effect, spec, &nval);
   fail_unless (g_value_get_uint (&nval) == 10);
 
+  prop = ges_track_object_lookup_child_property (tck_effect,
+      "GstAgingTV::scratch-lines");
+  fail_unless (prop != NULL);
+  fail_unless (prop == ges_track_object_lookup_child_property (tck_effect,
+          "scratch-lines"));
+  fail_if (ges_track_object_lookup_child_property (tck_effect,
+          "not-a-property"));
+
+  g_value_set_uint (&val, 12);
+  ges_track_object_set_child_property_by_handle (tck_effect, prop, &val);
+  ges_track_object_get_child_property_by_handle (tck_effect, prop, &nval);
+  fail_unless (g_value_get_uint (&nval) == 12);
+
   for (i = 0; i < n_props; i++) {
     g_param_spec_unref (pspecs[i]);
   }
@@ -458,6 +472,103 @@ GST_START_TEST (test_tl_obj_signals)
 }
 
 GST_END_TEST;
+static void
+effect_added_cb (GESTimelineObject * object, GESTrackEffect * effect,
+    guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_set_effect_stack)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrack *track_video;
+  GESTimelineObject *source;
+  GESTrackObject *e0, *e1, *e2, *tck_source;
+  GList *stack, *tckobjs, *effects;
+  guint added = 0, height;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+  track_video = ges_track_video_raw_new ();
+
+  ges_timeline_add_track (timeline, track_video);
+  ges_timeline_add_layer (timeline, layer);
+
+  source = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (source, "duration", 10 * GST_SECOND, NULL);
+  ges_simple_timeline_layer_add_object ((GESSimpleTimelineLayer *) layer,
+      source, 0);
+  g_signal_connect (source, "effect-added", G_CALLBACK (effect_added_cb),
+      &added);
+
+  tckobjs = ges_timeline_object_get_track_objects (source);
+  assert_equals_int (g_list_length (tckobjs), 1);
+  tck_source = GES_TRACK_OBJECT (tckobjs->data);
+  g_list_free_full (tckobjs, g_object_unref);
+
+  e0 = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new ("identity"));
+  e1 = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new ("identity"));
+  e2 = GES_TRACK_OBJECT (ges_track_parse_launch_effect_new ("identity"));
+
+  /* All the effects are added in one go */
+  stack = g_list_append (NULL, e0);
+  stack = g_list_append (stack, e1);
+  stack = g_list_append (stack, e2);
+  fail_unless (ges_timeline_object_set_effect_stack (source, stack));
+  g_list_free (stack);
+  fail_unless (ges_track_add_object (track_video, e0));
+  fail_unless (ges_track_add_object (track_video, e1));
+  fail_unless (ges_track_add_object (track_video, e2));
+  assert_equals_int (added, 3);
+
+  assert_equals_int (ges_timeline_object_get_top_effect_position (source,
+          GES_TRACK_EFFECT (e0)), 0);
+  assert_equals_int (ges_timeline_object_get_top_effect_position (source,
+          GES_TRACK_EFFECT (e2)), 2);
+  assert_equals_int (ges_track_object_get_priority (e1),
+      ges_track_object_get_priority (e0) + 1);
+  assert_equals_int (ges_track_object_get_priority (tck_source),
+      ges_track_object_get_priority (e0) + 3);
+  g_object_get (source, "height", &height, NULL);
+  assert_equals_int (height, 4);
+
+  /* Reordering reuses the effects, e1 is released */
+  g_object_ref (e1);
+  stack = g_list_append (NULL, e2);
+  stack = g_list_append (stack, e0);
+  fail_unless (ges_timeline_object_set_effect_stack (source, stack));
+  g_list_free (stack);
+  assert_equals_int (added, 3);
+
+  fail_unless (ges_track_object_get_timeline_object (e1) == NULL);
+  fail_unless (ges_track_object_get_track (e1) == NULL);
+  g_object_unref (e1);
+
+  effects = ges_timeline_object_get_top_effects (source);
+  assert_equals_int (g_list_length (effects), 2);
+  fail_unless (effects->data == e2);
+  fail_unless (effects->next->data == e0);
+  g_list_free_full (effects, g_object_unref);
+
+  assert_equals_int (ges_track_object_get_priority (e0),
+      ges_track_object_get_priority (e2) + 1);
+  assert_equals_int (ges_track_object_get_priority (tck_source),
+      ges_track_object_get_priority (e2) + 2);
+
+  /* Only effects can be stacked */
+  stack = g_list_append (NULL, tck_source);
+  fail_if (ges_timeline_object_set_effect_stack (source, stack));
+  g_list_free (stack);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -473,6 +584,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_priorities_tl_object);
   tcase_add_test (tc_chain, test_track_effect_set_properties);
   tcase_add_test (tc_chain, test_tl_obj_signals);
+  tcase_add_test (tc_chain, test_set_effect_stack);
 
   return s;
 }
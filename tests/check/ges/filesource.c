@@ -19,6 +19,8 @@
 
 #include <ges/ges.h>
 #include <gst/check/gstcheck.h>
+#include <glib/gstdio.h>
+#include <utime.h>
 
 /* This test uri will eventually have to be fixed */
 #define TEST_URI "http://nowhere/blahblahblah"
@@ -198,6 +200,237 @@ GST_START_TEST (test_filesource_images)
 
 GST_END_TEST;
 
+GST_START_TEST (test_filesource_element_pool)
+{
+  GList *tmp;
+  GESTrack *track;
+  GstElement *gnlobject;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrackObject *trobj;
+  GESTimelineObject *first, *second, *other;
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  first = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      TEST_URI);
+  g_object_set (first, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      "max-duration", (guint64) 100, "duration", (guint64) 50, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, first));
+
+  /* By default, a removed source keeps its gnlobject */
+  tmp = ges_timeline_object_get_track_objects (first);
+  trobj = g_object_ref (tmp->data);
+  gnlobject = ges_track_object_get_gnlobject (trobj);
+  fail_unless (gnlobject != NULL);
+  g_list_free_full (tmp, g_object_unref);
+
+  fail_unless (ges_timeline_layer_remove_object (layer, first));
+  fail_unless (ges_track_object_get_gnlobject (trobj) == gnlobject);
+  g_object_unref (trobj);
+
+  /* The elements are only reused while the sources are virtualized */
+  g_object_set (track, "materialize-window", (guint64) GST_SECOND, NULL);
+
+  first = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      TEST_URI);
+  g_object_set (first, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      "max-duration", (guint64) 100, "duration", (guint64) 50, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, first));
+
+  tmp = ges_timeline_object_get_track_objects (first);
+  gnlobject = ges_track_object_get_gnlobject (tmp->data);
+  fail_unless (gnlobject != NULL);
+  g_list_free_full (tmp, g_object_unref);
+
+  /* Removing the source keeps its gnlobject around */
+  fail_unless (ges_timeline_layer_remove_object (layer, first));
+
+  /* A source reading another file does not get it */
+  other = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      "http://nowhere/else");
+  g_object_set (other, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      "max-duration", (guint64) 100, "duration", (guint64) 50, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, other));
+  tmp = ges_timeline_object_get_track_objects (other);
+  fail_unless (ges_track_object_get_gnlobject (tmp->data) != gnlobject);
+  g_list_free_full (tmp, g_object_unref);
+
+  /* But a source of the same file reuses it */
+  second = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+      TEST_URI);
+  g_object_set (second, "supported-formats", GES_TRACK_TYPE_AUDIO,
+      "max-duration", (guint64) 100, "start", (guint64) 60,
+      "duration", (guint64) 30, "in-point", (guint64) 10, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, second));
+
+  tmp = ges_timeline_object_get_track_objects (second);
+  trobj = tmp->data;
+  fail_unless (ges_track_object_get_gnlobject (trobj) == gnlobject);
+  gnl_object_check (gnlobject, 60, 30, 10, 30, 0, TRUE);
+  g_list_free_full (tmp, g_object_unref);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_filesource_materialize_window)
+{
+  GList *tmp;
+  guint i;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTrackObject *trobjs[3];
+  GESTimelineObject *objs[3];
+
+  ges_init ();
+
+  track = ges_track_audio_raw_new ();
+  g_object_set (track, "materialize-window", (guint64) 10, NULL);
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Three sources at 0, 100 and 200, only the first is close to the
+   * playhead */
+  for (i = 0; i < 3; i++) {
+    objs[i] = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *)
+        TEST_URI);
+    g_object_set (objs[i], "supported-formats", GES_TRACK_TYPE_AUDIO,
+        "max-duration", (guint64) 100, "start", (guint64) i * 100,
+        "duration", (guint64) 50, NULL);
+    fail_unless (ges_timeline_layer_add_object (layer, objs[i]));
+
+    tmp = ges_timeline_object_get_track_objects (objs[i]);
+    fail_unless (tmp != NULL);
+    trobjs[i] = tmp->data;
+    g_list_free_full (tmp, g_object_unref);
+  }
+
+  fail_unless (ges_track_object_get_gnlobject (trobjs[0]) != NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[1]) == NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[2]) == NULL);
+
+  /* Released objects keep their timing */
+  assert_equals_uint64 (GES_TRACK_OBJECT_START (trobjs[2]), 200);
+  assert_equals_uint64 (GES_TRACK_OBJECT_DURATION (trobjs[2]), 50);
+
+  /* Moving the playhead swaps the materialized sources */
+  ges_track_set_playhead (track, 120);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[0]) == NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[1]) != NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[2]) == NULL);
+  gnl_object_check (ges_track_object_get_gnlobject (trobjs[1]), 100, 50, 0,
+      50, 0, TRUE);
+
+  /* Moving a source into the window materializes it */
+  g_object_set (objs[2], "start", (guint64) 125, NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[2]) != NULL);
+
+  /* Unless it exceeds the limit, the closest source is kept */
+  ges_track_set_max_materialized (track, 1);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[1]) != NULL);
+  fail_unless (ges_track_object_get_gnlobject (trobjs[2]) == NULL);
+
+  /* Disabling the window gives their elements back to all the sources */
+  ges_track_set_materialize_window (track, GST_CLOCK_TIME_NONE);
+  for (i = 0; i < 3; i++)
+    fail_unless (ges_track_object_get_gnlobject (trobjs[i]) != NULL);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+/* Adds a source for @uri to @layer, returning whether its duration was
+ * known right away, that is from the discovery cache */
+static gboolean
+add_cached_source (GESTimelineLayer * layer, const gchar * uri)
+{
+  GESTimelineFileSource *tfs = ges_timeline_filesource_new ((gchar *) uri);
+
+  fail_unless (ges_timeline_layer_add_object (layer,
+          GES_TIMELINE_OBJECT (tfs)));
+
+  return ges_timeline_filesource_get_max_duration (tfs) == 5 * GST_SECOND;
+}
+
+GST_START_TEST (test_filesource_discovery_cache)
+{
+  GKeyFile *kf;
+  GStatBuf st;
+  gsize length;
+  struct utimbuf times;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  gchar *dir, *cache, *media, *other, *uri, *other_uri, *data;
+
+  /* Keep away from the real cache of the user */
+  dir = g_dir_make_tmp ("ges-discovery-XXXXXX", NULL);
+  fail_unless (dir != NULL);
+  cache = g_build_filename (dir, "discovery.cache", NULL);
+  media = g_build_filename (dir, "media.ogg", NULL);
+  other = g_build_filename (dir, "other.ogg", NULL);
+  g_setenv ("GES_DISCOVERY_CACHE", cache, TRUE);
+
+  fail_unless (g_file_set_contents (media, "not media", -1, NULL));
+  fail_unless (g_file_set_contents (other, "not media", -1, NULL));
+  fail_unless (g_stat (media, &st) == 0);
+  uri = g_filename_to_uri (media, NULL, NULL);
+  other_uri = g_filename_to_uri (other, NULL, NULL);
+
+  /* Only media.ogg is known */
+  kf = g_key_file_new ();
+  g_key_file_set_integer (kf, "GESDiscoveryCache", "version", 1);
+  g_key_file_set_uint64 (kf, uri, "size", st.st_size);
+  g_key_file_set_uint64 (kf, uri, "mtime", st.st_mtime);
+  g_key_file_set_uint64 (kf, uri, "duration", 5 * GST_SECOND);
+  g_key_file_set_boolean (kf, uri, "audio", FALSE);
+  g_key_file_set_boolean (kf, uri, "video", TRUE);
+  g_key_file_set_boolean (kf, uri, "image", FALSE);
+  data = g_key_file_to_data (kf, &length, NULL);
+  fail_unless (g_file_set_contents (cache, data, length, NULL));
+  g_free (data);
+  g_key_file_free (kf);
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_append_layer (timeline);
+
+  /* Hit */
+  fail_unless (add_cached_source (layer, uri));
+  /* Miss */
+  fail_if (add_cached_source (layer, other_uri));
+
+  /* Modifying the file invalidates its entry */
+  times.actime = st.st_atime;
+  times.modtime = st.st_mtime + 10;
+  fail_unless (g_utime (media, &times) == 0);
+  fail_if (add_cached_source (layer, uri));
+
+  g_object_unref (timeline);
+
+  g_unlink (media);
+  g_unlink (other);
+  g_unlink (cache);
+  g_rmdir (dir);
+  g_free (uri);
+  g_free (other_uri);
+  g_free (media);
+  g_free (other);
+  g_free (cache);
+  g_free (dir);
+}
+
+GST_END_TEST;
 
 static Suite *
 ges_suite (void)
@@ -210,6 +443,9 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_filesource_basic);
   tcase_add_test (tc_chain, test_filesource_images);
   tcase_add_test (tc_chain, test_filesource_properties);
+  tcase_add_test (tc_chain, test_filesource_element_pool);
+  tcase_add_test (tc_chain, test_filesource_materialize_window);
+  tcase_add_test (tc_chain, test_filesource_discovery_cache);
 
   return s;
 }
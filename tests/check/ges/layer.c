@@ -292,6 +292,65 @@ GST_START_TEST (test_layer_priorities)
 
 GST_END_TEST;
 
+GST_START_TEST (test_layer_priorities_in_edit)
+{
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer1, *layer2;
+  GESTrackObject *tckobj1, *tckobj2;
+  GESTimelineObject *object1, *object2;
+  GstElement *gnlobj1, *gnlobj2;
+  guint prio1, prio2;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer1 = ges_timeline_append_layer (timeline);
+  layer2 = ges_timeline_append_layer (timeline);
+  track = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  object1 =
+      GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (my_fill_track_func,
+          NULL));
+  object2 =
+      GES_TIMELINE_OBJECT (ges_custom_timeline_source_new (my_fill_track_func,
+          NULL));
+  g_object_set (object2, "priority", 1, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer1, object1));
+  fail_unless (ges_timeline_layer_add_object (layer2, object2));
+  tckobj1 = ges_timeline_object_find_track_object (object1, track, G_TYPE_NONE);
+  tckobj2 = ges_timeline_object_find_track_object (object2, track, G_TYPE_NONE);
+  gnlobj1 = ges_track_object_get_gnlobject (tckobj1);
+  gnlobj2 = ges_track_object_get_gnlobject (tckobj2);
+
+  /* The layers are swapped, their objects are only placed at the end of the
+   * edit */
+  ges_timeline_begin_edit (timeline);
+  g_object_set (layer1, "priority", 1, NULL);
+  g_object_set (layer2, "priority", 0, NULL);
+  assert_equals_int (layer1->min_gnl_priority, LAYER_HEIGHT);
+  assert_equals_int (layer2->min_gnl_priority, 0);
+  g_object_get (gnlobj1, "priority", &prio1, NULL);
+  g_object_get (gnlobj2, "priority", &prio2, NULL);
+  assert_equals_int (prio1, 0);
+  assert_equals_int (prio2, LAYER_HEIGHT + 1);
+  fail_unless (ges_timeline_commit_edit (timeline));
+
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object1), 0);
+  assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (object2), 1);
+  g_object_get (gnlobj1, "priority", &prio1, NULL);
+  g_object_get (gnlobj2, "priority", &prio2, NULL);
+  assert_equals_int (prio1, LAYER_HEIGHT);
+  assert_equals_int (prio2, 1);
+
+  g_object_unref (tckobj1);
+  g_object_unref (tckobj2);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_layer_automatic_transition)
 {
   GESTimeline *timeline;
@@ -330,6 +389,150 @@ GST_START_TEST (test_layer_automatic_transition)
 
 GST_END_TEST;
 
+static guint
+count_transitions (GESTimelineLayer * layer)
+{
+  guint n_transitions = 0;
+  GList *tmp, *objects = ges_timeline_layer_get_objects (layer);
+
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (GES_IS_TIMELINE_STANDARD_TRANSITION (tmp->data))
+      n_transitions++;
+  }
+  g_list_free_full (objects, g_object_unref);
+
+  return n_transitions;
+}
+
+GST_START_TEST (test_layer_automatic_transition_move)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer, *layer2;
+  GESTimelineTestSource *src, *srcbis, *src3;
+  GList *objects, *tmp;
+  guint n_transitions;
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_layer_new ();
+  ges_timeline_add_layer (timeline, layer);
+
+  g_object_set (layer, "auto-transition", TRUE, NULL);
+  src = ges_timeline_test_source_new ();
+  srcbis = ges_timeline_test_source_new ();
+
+  g_object_set (src, "start", (guint64) 0, "duration", (guint64) 10000,
+      NULL);
+  g_object_set (srcbis, "start", (guint64) 5000, "duration", (guint64) 10000,
+      NULL);
+
+  ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (src));
+  ges_timeline_layer_add_object (layer, GES_TIMELINE_OBJECT (srcbis));
+
+  /* Moving the second source away removes the transition */
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 20000);
+
+  objects = ges_timeline_layer_get_objects (layer);
+  n_transitions = 0;
+  for (tmp = objects; tmp; tmp = tmp->next) {
+    if (GES_IS_TIMELINE_STANDARD_TRANSITION (tmp->data))
+      n_transitions++;
+  }
+  assert_equals_int (n_transitions, 0);
+  assert_equals_int (g_list_length (objects), 2);
+  g_list_free_full (objects, g_object_unref);
+
+  /* Not calculating transitions anymore */
+  g_object_set (layer, "auto-transition", FALSE, NULL);
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 5000);
+
+  objects = ges_timeline_layer_get_objects (layer);
+  assert_equals_int (g_list_length (objects), 2);
+  g_list_free_full (objects, g_object_unref);
+
+  /* Once back on, moving and resizing sources updates the transitions */
+  g_object_set (layer, "auto-transition", TRUE, NULL);
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 6000);
+  fail_unless (count_transitions (layer) > 0);
+  ges_timeline_object_set_duration (GES_TIMELINE_OBJECT (src), 5000);
+  assert_equals_int (count_transitions (layer), 0);
+  ges_timeline_object_set_duration (GES_TIMELINE_OBJECT (src), 10000);
+  fail_unless (count_transitions (layer) > 0);
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 20000);
+  assert_equals_int (count_transitions (layer), 0);
+
+  /* A source moved to another auto-transition layer keeps its transitions
+   * calculated there */
+  layer2 = ges_timeline_append_layer (timeline);
+  g_object_set (layer2, "auto-transition", TRUE, NULL);
+  src3 = ges_timeline_test_source_new ();
+  g_object_set (src3, "start", (guint64) 40000, "duration", (guint64) 10000,
+      NULL);
+  ges_timeline_layer_add_object (layer2, GES_TIMELINE_OBJECT (src3));
+
+  fail_unless (ges_timeline_object_move_to_layer (GES_TIMELINE_OBJECT (srcbis),
+          layer2));
+  assert_equals_int (count_transitions (layer2), 0);
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 35000);
+  fail_unless (count_transitions (layer2) > 0);
+  ges_timeline_object_set_start (GES_TIMELINE_OBJECT (srcbis), 20000);
+  assert_equals_int (count_transitions (layer2), 0);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_layer_add_objects)
+{
+  guint i;
+  GList *objects, *tmp;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *tlobjs[4];
+
+  ges_init ();
+
+  timeline = ges_timeline_new_audio_video ();
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  /* Added in the reverse order */
+  for (i = 0; i < 3; i++) {
+    tlobjs[i] = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+    g_object_set (tlobjs[i], "start", (guint64) (3 - i) * 10, "duration",
+        (guint64) 10, NULL);
+  }
+  fail_unless (ges_timeline_layer_add_objects (layer, tlobjs, 3));
+
+  /* Objects that already are in a layer are refused */
+  tlobjs[3] = GES_TIMELINE_OBJECT (ges_timeline_test_source_new ());
+  g_object_set (tlobjs[3], "start", (guint64) 0, "duration", (guint64) 10,
+      NULL);
+  fail_if (ges_timeline_layer_add_objects (layer, &tlobjs[2], 2));
+
+  objects = ges_timeline_layer_get_objects (layer);
+  assert_equals_int (g_list_length (objects), 4);
+  fail_unless (objects->data == tlobjs[3]);
+  fail_unless (objects->next->data == tlobjs[2]);
+  fail_unless (objects->next->next->data == tlobjs[1]);
+  fail_unless (objects->next->next->next->data == tlobjs[0]);
+  g_list_free_full (objects, g_object_unref);
+
+  /* The objects stay sorted when they move */
+  ges_timeline_object_set_start (tlobjs[3], 100);
+  objects = ges_timeline_layer_get_objects (layer);
+  fail_unless (g_list_last (objects)->data == tlobjs[3]);
+  for (tmp = objects; tmp; tmp = tmp->next)
+    assert_equals_int (GES_TIMELINE_OBJECT_PRIORITY (tmp->data), 0);
+  g_list_free_full (objects, g_object_unref);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 ges_suite (void)
@@ -341,7 +544,10 @@ ges_suite (void)
 
   tcase_add_test (tc_chain, test_layer_properties);
   tcase_add_test (tc_chain, test_layer_priorities);
+  tcase_add_test (tc_chain, test_layer_priorities_in_edit);
   tcase_add_test (tc_chain, test_layer_automatic_transition);
+  tcase_add_test (tc_chain, test_layer_automatic_transition_move);
+  tcase_add_test (tc_chain, test_layer_add_objects);
 
   return s;
 }
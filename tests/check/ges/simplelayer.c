@@ -549,6 +549,73 @@ GST_START_TEST (test_gsl_with_transitions)
 
 GST_END_TEST;
 
+GST_START_TEST (test_gsl_insert_front)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESSimpleTimelineLayer *gstl;
+  GESTrack *track;
+  GESTimelineObject *sources[20], *tmp;
+  guint i;
+
+  ges_init ();
+
+  timeline = ges_timeline_new ();
+  layer = (GESTimelineLayer *) ges_simple_timeline_layer_new ();
+  gstl = GES_SIMPLE_TIMELINE_LAYER (layer);
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  /* Each new source pushes all the others by its duration */
+  for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+    sources[i] = (GESTimelineObject *)
+        ges_custom_timeline_source_new (my_fill_track_func, NULL);
+    g_object_set (sources[i], "duration", (guint64) (i + 1) * GST_SECOND,
+        NULL);
+    fail_unless (ges_simple_timeline_layer_add_object (gstl, sources[i], 0));
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+    guint j = G_N_ELEMENTS (sources) - 1 - i;
+    guint64 start;
+
+    tmp = ges_simple_timeline_layer_nth (gstl, i);
+    fail_unless (tmp == sources[j]);
+    fail_unless_equals_int (ges_simple_timeline_layer_index (gstl,
+            sources[j]), i);
+
+    /* Sources j+1 .. N-1 are before it */
+    start = ((G_N_ELEMENTS (sources) * (G_N_ELEMENTS (sources) + 1)) / 2 -
+        ((j + 1) * (j + 2)) / 2) * GST_SECOND;
+    fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_START (tmp), start);
+
+    if (i)
+      fail_unless (GES_TIMELINE_OBJECT_PRIORITY (tmp) >
+          GES_TIMELINE_OBJECT_PRIORITY (ges_simple_timeline_layer_nth (gstl,
+                  i - 1)));
+  }
+
+  /* Growing the first source moves all the others */
+  g_object_set (sources[G_N_ELEMENTS (sources) - 1], "duration",
+      (guint64) (G_N_ELEMENTS (sources) + 1) * GST_SECOND, NULL);
+  fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_START (sources[0]),
+      ((G_N_ELEMENTS (sources) * (G_N_ELEMENTS (sources) + 1)) / 2) *
+      GST_SECOND);
+
+  /* Moving the last source to the front */
+  fail_unless (ges_simple_timeline_layer_move_object (gstl, sources[0], 0));
+  fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_START (sources[0]), 0);
+  fail_unless_equals_int (ges_simple_timeline_layer_index (gstl,
+          sources[G_N_ELEMENTS (sources) - 1]), 1);
+  fail_unless_equals_uint64 (GES_TIMELINE_OBJECT_START (sources
+          [G_N_ELEMENTS (sources) - 1]), GST_SECOND);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -560,6 +627,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_gsl_add);
   tcase_add_test (tc_chain, test_gsl_move_simple);
   tcase_add_test (tc_chain, test_gsl_with_transitions);
+  tcase_add_test (tc_chain, test_gsl_insert_front);
 
   return s;
 }
@@ -942,6 +942,315 @@ GST_START_TEST (test_timeline_edition_mode)
 
 GST_END_TEST;
 
+GST_START_TEST (test_track_objects_in_range)
+{
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTrackObject *tckobj, *tckobj1, *tckobj2;
+  GESTimelineObject *obj, *obj1, *obj2;
+  GList *objects;
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  fail_unless (track != NULL);
+
+  timeline = ges_timeline_new ();
+  fail_unless (timeline != NULL);
+
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  obj = create_custom_tlobj ();
+  obj1 = create_custom_tlobj ();
+  obj2 = create_custom_tlobj ();
+
+  fail_unless (obj && obj1 && obj2);
+
+  /**
+   * Our timeline
+   *
+   *          -------   --------      -----------
+   *          |  obj  |  |  obj1  |     |     obj2  |
+   * time     0------- 10 --------20    50---------110
+   */
+  g_object_set (obj, "start", (guint64) 0, "duration", (guint64) 10, NULL);
+  g_object_set (obj1, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+  g_object_set (obj2, "start", (guint64) 50, "duration", (guint64) 60, NULL);
+
+  tckobj = ges_timeline_object_create_track_object (obj, track);
+  fail_unless (ges_timeline_object_add_track_object (obj, tckobj));
+  fail_unless (ges_track_add_object (track, tckobj));
+
+  tckobj1 = ges_timeline_object_create_track_object (obj1, track);
+  fail_unless (ges_timeline_object_add_track_object (obj1, tckobj1));
+  fail_unless (ges_track_add_object (track, tckobj1));
+
+  tckobj2 = ges_timeline_object_create_track_object (obj2, track);
+  fail_unless (ges_timeline_object_add_track_object (obj2, tckobj2));
+  fail_unless (ges_track_add_object (track, tckobj2));
+
+  objects = ges_timeline_get_track_objects_in_range (timeline, 5, 15);
+  assert_equals_int (g_list_length (objects), 2);
+  fail_unless (objects->data == tckobj);
+  fail_unless (objects->next->data == tckobj1);
+  g_list_free_full (objects, g_object_unref);
+
+  objects = ges_timeline_get_track_objects_in_range (timeline, 20, 50);
+  fail_unless (objects == NULL);
+
+  objects = ges_timeline_get_track_objects_in_range (timeline, 15, 60);
+  assert_equals_int (g_list_length (objects), 2);
+  fail_unless (objects->data == tckobj1);
+  fail_unless (objects->next->data == tckobj2);
+  g_list_free_full (objects, g_object_unref);
+
+  /* The index follows the objects when they move */
+  g_object_set (obj2, "start", (guint64) 25, NULL);
+  objects = ges_timeline_get_track_objects_in_range (timeline, 20, 50);
+  assert_equals_int (g_list_length (objects), 1);
+  fail_unless (objects->data == tckobj2);
+  g_list_free_full (objects, g_object_unref);
+
+  g_object_set (obj2, "duration", (guint64) 5, NULL);
+  objects = ges_timeline_get_track_objects_in_range (timeline, 30, 50);
+  fail_unless (objects == NULL);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_render_cut_points)
+{
+  guint i, n_points;
+  guint64 *points;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTrackObject *tckobj;
+  GESTimelineObject *objs[3];
+  guint64 starts[] = { 0, 10, 50 }, durations[] = { 10, 10, 60 };
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  /**
+   * Our timeline
+   *
+   *          -------   --------      -----------
+   *          |  obj  |  |  obj1  |     |     obj2  |
+   * time     0------- 10 --------20    50---------110
+   */
+  for (i = 0; i < 3; i++) {
+    objs[i] = create_custom_tlobj ();
+    g_object_set (objs[i], "start", starts[i], "duration", durations[i],
+        NULL);
+    tckobj = ges_timeline_object_create_track_object (objs[i], track);
+    fail_unless (ges_timeline_object_add_track_object (objs[i], tckobj));
+    fail_unless (ges_track_add_object (track, tckobj));
+  }
+
+  points = ges_timeline_get_render_cut_points (timeline, 1, &n_points);
+  assert_equals_int (n_points, 2);
+  assert_equals_uint64 (points[0], 0);
+  assert_equals_uint64 (points[1], 110);
+  g_free (points);
+
+  /* The middle is moved to the start of obj2 */
+  points = ges_timeline_get_render_cut_points (timeline, 2, &n_points);
+  assert_equals_int (n_points, 3);
+  assert_equals_uint64 (points[0], 0);
+  assert_equals_uint64 (points[1], 50);
+  assert_equals_uint64 (points[2], 110);
+  g_free (points);
+
+  /* No edge is close enough to 82 */
+  points = ges_timeline_get_render_cut_points (timeline, 4, &n_points);
+  assert_equals_int (n_points, 5);
+  assert_equals_uint64 (points[1], 20);
+  assert_equals_uint64 (points[2], 50);
+  assert_equals_uint64 (points[3], 82);
+  assert_equals_uint64 (points[4], 110);
+  g_free (points);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+static void
+duration_changed_cb (GESTimeline * timeline, GParamSpec * arg, guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_edit_transaction)
+{
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *obj, *obj1;
+  GList *objects;
+  guint notifications = 0;
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  obj = create_custom_tlobj ();
+  obj1 = create_custom_tlobj ();
+  g_object_set (obj, "start", (guint64) 0, "duration", (guint64) 10, NULL);
+  g_object_set (obj1, "start", (guint64) 10, "duration", (guint64) 10, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, obj));
+  fail_unless (ges_timeline_layer_add_object (layer, obj1));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 20);
+
+  g_signal_connect (timeline, "notify::duration",
+      G_CALLBACK (duration_changed_cb), &notifications);
+
+  /* Nested transactions are only commited with the outermost one */
+  ges_timeline_begin_edit (timeline);
+  ges_timeline_begin_edit (timeline);
+  fail_if (ges_track_is_updating (track));
+
+  g_object_set (obj, "start", (guint64) 30, NULL);
+  g_object_set (obj1, "start", (guint64) 50, NULL);
+  g_object_set (obj1, "duration", (guint64) 20, NULL);
+  fail_unless (ges_timeline_commit_edit (timeline));
+  fail_if (ges_track_is_updating (track));
+  assert_equals_int (notifications, 0);
+
+  /* Queries see the objects at their new position */
+  objects = ges_timeline_get_track_objects_in_range (timeline, 0, 30);
+  fail_unless (objects == NULL);
+
+  fail_unless (ges_timeline_commit_edit (timeline));
+  fail_unless (ges_track_is_updating (track));
+  assert_equals_int (notifications, 1);
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 70);
+
+  objects = ges_timeline_get_track_objects_in_range (timeline, 35, 55);
+  assert_equals_int (g_list_length (objects), 2);
+  g_list_free_full (objects, g_object_unref);
+
+  /* No transaction in progress anymore */
+  fail_if (ges_timeline_commit_edit (timeline));
+
+  /* The duration follows the last end */
+  fail_unless (ges_timeline_layer_remove_object (layer, obj1));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 40);
+  fail_unless (ges_timeline_layer_remove_object (layer, obj));
+  assert_equals_uint64 (ges_timeline_get_duration (timeline), 0);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_snapping_filters)
+{
+  GESTrack *track, *other_track;
+  GESTimeline *timeline;
+  GESTrackObject *tckobj2;
+  GESTimelineObject *obj, *obj1, *obj2;
+  GESTimelineLayer *layer, *layer1;
+  GList *tckobjs, *list;
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  other_track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+
+  obj = create_custom_tlobj ();
+  obj1 = create_custom_tlobj ();
+  obj2 = create_custom_tlobj ();
+
+  /**
+   * Our timeline
+   * ------------
+   * layer:    0-------100                         500----550
+   *           |  obj   |                           | obj2 |
+   * layer1:            200-------300
+   *                     |  obj1  |
+   */
+  g_object_set (obj, "start", (guint64) 0, "duration", (guint64) 100, NULL);
+  g_object_set (obj1, "start", (guint64) 200, "duration", (guint64) 100, NULL);
+  g_object_set (obj2, "start", (guint64) 500, "duration", (guint64) 50, NULL);
+
+  layer = ges_timeline_append_layer (timeline);
+  layer1 = ges_timeline_append_layer (timeline);
+  fail_unless (ges_timeline_layer_add_object (layer, obj));
+  fail_unless (ges_timeline_layer_add_object (layer1, obj1));
+  fail_unless (ges_timeline_layer_add_object (layer, obj2));
+
+  fail_unless ((tckobjs = ges_timeline_object_get_track_objects (obj2)) != NULL);
+  tckobj2 = GES_TRACK_OBJECT (tckobjs->data);
+  g_list_free_full (tckobjs, g_object_unref);
+  CHECK_OBJECT_PROPS (tckobj2, 500, 0, 50);
+
+  g_object_set (timeline, "snapping-distance", (guint64) 10, NULL);
+
+  /* Snapping to the end of obj */
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, 105));
+  CHECK_OBJECT_PROPS (tckobj2, 100, 0, 50);
+
+  /* Only the objects of layer1 are snapping targets */
+  list = g_list_prepend (NULL, layer1);
+  ges_timeline_set_snapping_layers (timeline, list);
+  g_list_free (list);
+
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, 205));
+  CHECK_OBJECT_PROPS (tckobj2, 200, 0, 50);
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, 103));
+  CHECK_OBJECT_PROPS (tckobj2, 103, 0, 50);
+
+  /* None of the objects are in other_track */
+  ges_timeline_set_snapping_layers (timeline, NULL);
+  list = g_list_prepend (NULL, other_track);
+  ges_timeline_set_snapping_tracks (timeline, list);
+  g_list_free (list);
+
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, 104));
+  CHECK_OBJECT_PROPS (tckobj2, 104, 0, 50);
+
+  list = g_list_prepend (NULL, track);
+  ges_timeline_set_snapping_tracks (timeline, list);
+  g_list_free (list);
+
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, 106));
+  CHECK_OBJECT_PROPS (tckobj2, 100, 0, 50);
+
+  /* Snapping on the frame grid, far from any edge */
+  ges_timeline_set_snapping_tracks (timeline, NULL);
+  ges_timeline_set_snapping_framerate (timeline, 10, 1);
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, GST_SECOND / 10 + 5));
+  CHECK_OBJECT_PROPS (tckobj2, GST_SECOND / 10, 0, 50);
+
+  ges_timeline_set_snapping_framerate (timeline, 0, 1);
+  fail_unless (ges_timeline_object_edit (obj2, NULL, -1, GES_EDIT_MODE_NORMAL,
+          GES_EDGE_NONE, GST_SECOND / 10 + 7));
+  CHECK_OBJECT_PROPS (tckobj2, GST_SECOND / 10 + 7, 0, 50);
+
+  ASSERT_OBJECT_REFCOUNT (other_track, "other_track", 1);
+  g_object_unref (other_track);
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -953,6 +1262,10 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_basic_timeline_edition);
   tcase_add_test (tc_chain, test_snapping);
   tcase_add_test (tc_chain, test_timeline_edition_mode);
+  tcase_add_test (tc_chain, test_track_objects_in_range);
+  tcase_add_test (tc_chain, test_render_cut_points);
+  tcase_add_test (tc_chain, test_edit_transaction);
+  tcase_add_test (tc_chain, test_snapping_filters);
 
   return s;
 }
@@ -272,6 +272,79 @@ GST_START_TEST (test_split_object)
 
 GST_END_TEST;
 
+GST_START_TEST (test_split_object_many)
+{
+  guint i;
+  GList *tmp, *objects, *tckobjs;
+  GESTrack *track;
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineObject *object;
+  GESTrackObject *trackobject;
+  guint64 positions[] = { 70, 50, 200, 60, 50, 42 };
+  guint64 starts[] = { 50, 60, 70 }, durations[] = { 10, 10, 22 };
+
+  ges_init ();
+
+  track = ges_track_new (GES_TRACK_TYPE_CUSTOM, GST_CAPS_ANY);
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, track));
+  layer = ges_timeline_append_layer (timeline);
+
+  object =
+      (GESTimelineObject *) ges_custom_timeline_source_new (my_fill_track_func,
+      NULL);
+  g_object_set (object, "start", (guint64) 42, "duration", (guint64) 50,
+      "in-point", (guint64) 12, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  /* Out of bounds and repeated positions are ignored */
+  objects = ges_timeline_object_split_many (object, positions,
+      G_N_ELEMENTS (positions));
+  fail_unless_equals_int (g_list_length (objects), 3);
+
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_START (object), 42);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (object), 8);
+  assert_equals_uint64 (GES_TIMELINE_OBJECT_INPOINT (object), 12);
+
+  tckobjs = ges_timeline_object_get_track_objects (object);
+  trackobject = tckobjs->data;
+  assert_equals_uint64 (GES_TRACK_OBJECT_DURATION (trackobject), 8);
+  g_list_free_full (tckobjs, g_object_unref);
+
+  for (tmp = objects, i = 0; tmp; tmp = tmp->next, i++) {
+    GESTimelineObject *splitobj = tmp->data;
+
+    fail_unless (ges_timeline_object_get_layer (splitobj) == layer);
+    g_object_unref (layer);
+    assert_equals_uint64 (GES_TIMELINE_OBJECT_START (splitobj), starts[i]);
+    assert_equals_uint64 (GES_TIMELINE_OBJECT_DURATION (splitobj),
+        durations[i]);
+    assert_equals_uint64 (GES_TIMELINE_OBJECT_INPOINT (splitobj),
+        starts[i] - 30);
+
+    tckobjs = ges_timeline_object_get_track_objects (splitobj);
+    fail_unless_equals_int (g_list_length (tckobjs), 1);
+    trackobject = tckobjs->data;
+    fail_unless (ges_track_object_get_track (trackobject) == track);
+    assert_equals_uint64 (GES_TRACK_OBJECT_START (trackobject), starts[i]);
+    assert_equals_uint64 (GES_TRACK_OBJECT_DURATION (trackobject),
+        durations[i]);
+    assert_equals_uint64 (GES_TRACK_OBJECT_INPOINT (trackobject),
+        starts[i] - 30);
+    g_list_free_full (tckobjs, g_object_unref);
+  }
+  g_list_free (objects);
+
+  /* Nothing to split */
+  fail_unless (ges_timeline_object_split_many (object, positions + 5,
+          1) == NULL);
+
+  g_object_unref (timeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 ges_suite (void)
 {
@@ -283,6 +356,7 @@ ges_suite (void)
   tcase_add_test (tc_chain, test_object_properties);
   tcase_add_test (tc_chain, test_object_properties_unlocked);
   tcase_add_test (tc_chain, test_split_object);
+  tcase_add_test (tc_chain, test_split_object_many);
 
   return s;
 }
@@ -0,0 +1,847 @@
+/* GStreamer Editing Services
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <ges/ges.h>
+#include <gst/check/gstcheck.h>
+#include <gst/pbutils/encoding-profile.h>
+#include <gst/pbutils/gstdiscoverer.h>
+#include <glib/gstdio.h>
+
+#define TIMEOUT (10 * GST_SECOND)
+
+static GstEncodingProfile *
+make_profile (gboolean with_video)
+{
+  GstCaps *caps;
+  GstEncodingContainerProfile *profile;
+
+  caps = gst_caps_from_string ("application/ogg");
+  profile = gst_encoding_container_profile_new ("timelinepipeline-test", NULL,
+      caps, NULL);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_from_string ("audio/x-vorbis");
+  gst_encoding_container_profile_add_profile (profile, (GstEncodingProfile *)
+      gst_encoding_audio_profile_new (caps, NULL, NULL, 0));
+  gst_caps_unref (caps);
+
+  if (with_video) {
+    caps = gst_caps_from_string ("video/x-theora");
+    gst_encoding_container_profile_add_profile (profile, (GstEncodingProfile *)
+        gst_encoding_video_profile_new (caps, NULL, NULL, 0));
+    gst_caps_unref (caps);
+  }
+
+  return (GstEncodingProfile *) profile;
+}
+
+/* A @duration long audio and video test source */
+static GESTimeline *
+make_timeline (GstClockTime duration)
+{
+  GESTimeline *timeline;
+  GESTimelineLayer *layer;
+  GESTimelineTestSource *source;
+
+  timeline = ges_timeline_new ();
+  fail_unless (ges_timeline_add_track (timeline, ges_track_video_raw_new ()));
+  fail_unless (ges_timeline_add_track (timeline, ges_track_audio_raw_new ()));
+
+  layer = ges_timeline_layer_new ();
+  fail_unless (ges_timeline_add_layer (timeline, layer));
+
+  source = ges_timeline_test_source_new ();
+  g_object_set (source, "duration", duration, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer,
+          (GESTimelineObject *) source));
+
+  return timeline;
+}
+
+/* The timeline of make_timeline(), previewed in fakesinks */
+static GESTimelinePipeline *
+make_pipeline (GstClockTime duration)
+{
+  GESTimelinePipeline *pipeline;
+
+  pipeline = ges_timeline_pipeline_new ();
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline,
+          make_timeline (duration)));
+
+  ges_timeline_pipeline_preview_set_video_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+  ges_timeline_pipeline_preview_set_audio_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+
+  return pipeline;
+}
+
+/* Returns the type of the first of @types posted on the bus of @pipeline */
+static GstMessageType
+wait_for_message (GESTimelinePipeline * pipeline, GstMessageType types)
+{
+  GstBus *bus;
+  GstMessage *message;
+  GstMessageType type;
+
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  message = gst_bus_timed_pop_filtered (bus, TIMEOUT, types);
+  gst_object_unref (bus);
+
+  fail_unless (message != NULL, "Timed out waiting for the pipeline");
+  type = GST_MESSAGE_TYPE (message);
+  gst_message_unref (message);
+
+  return type;
+}
+
+static gboolean
+has_child (GESTimelinePipeline * pipeline, const gchar * name)
+{
+  GstElement *child;
+
+  child = gst_bin_get_by_name (GST_BIN (pipeline), name);
+  if (child == NULL)
+    return FALSE;
+
+  gst_object_unref (child);
+  return TRUE;
+}
+
+static GstClockTime
+get_file_duration (const gchar * uri)
+{
+  GstClockTime duration;
+  GstDiscoverer *discoverer;
+  GstDiscovererInfo *info;
+
+  discoverer = gst_discoverer_new (TIMEOUT, NULL);
+  fail_unless (discoverer != NULL);
+  info = gst_discoverer_discover_uri (discoverer, uri, NULL);
+  fail_unless (info != NULL);
+  fail_unless_equals_int (gst_discoverer_info_get_result (info),
+      GST_DISCOVERER_OK);
+  duration = gst_discoverer_info_get_duration (info);
+
+  gst_discoverer_info_unref (info);
+  g_object_unref (discoverer);
+
+  return duration;
+}
+
+GST_START_TEST (test_timeline_pipeline_render_from_preview)
+{
+  gint fd;
+  gint64 position;
+  gchar *path, *uri;
+  GStatBuf stats;
+  GstEncodingProfile *profile;
+  GESTimelinePipeline *pipeline;
+
+  ges_init ();
+
+  fd = g_file_open_tmp ("ges-timelinepipeline-XXXXXX.ogg", &path, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  uri = gst_filename_to_uri (path, NULL);
+
+  pipeline = make_pipeline (GST_SECOND);
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_PREVIEW));
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR),
+      GST_MESSAGE_ASYNC_DONE);
+
+  /* Move away from the start, the render must not begin there */
+  fail_unless (gst_element_seek_simple (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, GST_SECOND / 2));
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR),
+      GST_MESSAGE_ASYNC_DONE);
+
+  profile = make_profile (TRUE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+
+  /* The outputs are swapped while the timeline keeps running */
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+  fail_unless_equals_int (GST_STATE (pipeline), GST_STATE_PAUSED);
+  fail_unless (has_child (pipeline, "internal-encodebin"));
+  fail_if (has_child (pipeline, "internal-sinks"));
+
+  /* The render prerolled from the start of the timeline */
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR),
+      GST_MESSAGE_ASYNC_DONE);
+  fail_unless (gst_element_query_position (GST_ELEMENT (pipeline),
+          GST_FORMAT_TIME, &position));
+  fail_unless (position < GST_SECOND / 2);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_EOS);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless (g_stat (path, &stats) == 0);
+  fail_unless (stats.st_size > 0);
+
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_render_rollback)
+{
+  gint fd;
+  gchar *path, *uri;
+  GstEncodingProfile *profile;
+  GESTimelinePipeline *pipeline;
+
+  ges_init ();
+
+  fd = g_file_open_tmp ("ges-timelinepipeline-XXXXXX.ogg", &path, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  uri = gst_filename_to_uri (path, NULL);
+
+  pipeline = make_pipeline (GST_SECOND);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR),
+      GST_MESSAGE_ASYNC_DONE);
+
+  /* The video track can not be linked to an audio only profile */
+  profile = make_profile (FALSE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+
+  fail_if (ges_timeline_pipeline_set_mode (pipeline, TIMELINE_MODE_RENDER));
+  fail_if (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_PREVIEW | TIMELINE_MODE_RENDER));
+
+  /* The preview is still there and keeps running */
+  fail_unless (has_child (pipeline, "internal-sinks"));
+  fail_if (has_child (pipeline, "internal-encodebin"));
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_EOS);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_render_range_arguments)
+{
+  GESTimelinePipeline *pipeline;
+
+  ges_init ();
+
+  pipeline = ges_timeline_pipeline_new ();
+
+  ASSERT_CRITICAL (ges_timeline_pipeline_set_render_range (NULL, 0,
+          GST_CLOCK_TIME_NONE));
+  ASSERT_CRITICAL (ges_timeline_pipeline_set_render_range (pipeline,
+          GST_CLOCK_TIME_NONE, GST_SECOND));
+
+  /* Empty ranges */
+  fail_if (ges_timeline_pipeline_set_render_range (pipeline, GST_SECOND,
+          GST_SECOND));
+  fail_if (ges_timeline_pipeline_set_render_range (pipeline, 2 * GST_SECOND,
+          GST_SECOND));
+
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline, 0,
+          GST_CLOCK_TIME_NONE));
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline, GST_SECOND,
+          GST_CLOCK_TIME_NONE));
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline, 0,
+          GST_SECOND));
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_render_range)
+{
+  gint fd;
+  gchar *path, *uri;
+  GstEncodingProfile *profile;
+  GESTimelinePipeline *pipeline;
+
+  ges_init ();
+
+  fd = g_file_open_tmp ("ges-timelinepipeline-XXXXXX.ogg", &path, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  uri = gst_filename_to_uri (path, NULL);
+
+  pipeline = make_pipeline (GST_SECOND);
+  profile = make_profile (TRUE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline,
+          GST_SECOND / 4, GST_SECOND / 2));
+
+  /* Straight to PLAYING, the seek is done once the preroll completed */
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_EOS);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+
+  fail_unless (get_file_duration (uri) < 3 * GST_SECOND / 4);
+
+  /* Prerolled first, the range is applied again after going to NULL */
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR),
+      GST_MESSAGE_ASYNC_DONE);
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_EOS);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+
+  fail_unless (get_file_duration (uri) < 3 * GST_SECOND / 4);
+
+  gst_object_unref (pipeline);
+
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_render_range_preroll_error)
+{
+  gint fd;
+  gchar *path, *uri;
+  GstEncodingProfile *profile;
+  GESTimelinePipeline *pipeline;
+
+  ges_init ();
+
+  fd = g_file_open_tmp ("ges-timelinepipeline-XXXXXX.ogg", &path, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  uri = gst_filename_to_uri (path, NULL);
+
+  /* The video track can not be encoded, so the pipeline never prerolls and
+   * the range is never sought, but setting the state must still return */
+  pipeline = make_pipeline (GST_SECOND);
+  profile = make_profile (FALSE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+  fail_unless (ges_timeline_pipeline_set_render_range (pipeline,
+          GST_SECOND / 4, GST_SECOND / 2));
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_ERROR);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  g_unlink (path);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+static void
+parallel_done_cb (GESParallelRenderer * renderer, GMainLoop * loop)
+{
+  g_main_loop_quit (loop);
+}
+
+static void
+parallel_error_cb (GESParallelRenderer * renderer, GError * error,
+    GMainLoop * loop)
+{
+  fail ("Could not render: %s", error->message);
+}
+
+static gboolean
+parallel_timeout_cb (GMainLoop * loop)
+{
+  fail ("Timed out waiting for the renderer");
+
+  return FALSE;
+}
+
+GST_START_TEST (test_parallel_renderer)
+{
+  guint i, timeout_id;
+  gchar *uri, *path, **chunks;
+  GMainLoop *loop;
+  GstEncodingProfile *profile;
+  GESTimeline *timeline;
+  GESParallelRenderer *renderer;
+
+  ges_init ();
+
+  path = g_build_filename (g_get_tmp_dir (), "ges-parallel-renderer.ogg",
+      NULL);
+  uri = gst_filename_to_uri (path, NULL);
+  g_free (path);
+
+  timeline = make_timeline (GST_SECOND);
+  renderer = ges_parallel_renderer_new (timeline, 2);
+  fail_unless (renderer != NULL);
+
+  /* Nothing is rendered without settings */
+  fail_if (ges_parallel_renderer_start (renderer));
+  fail_unless (ges_parallel_renderer_get_chunk_uris (renderer) == NULL);
+
+  profile = make_profile (TRUE);
+  fail_unless (ges_parallel_renderer_set_render_settings (renderer, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_signal_connect (renderer, "done", G_CALLBACK (parallel_done_cb), loop);
+  g_signal_connect (renderer, "error", G_CALLBACK (parallel_error_cb), loop);
+  timeout_id = g_timeout_add_seconds (2 * TIMEOUT / GST_SECOND,
+      (GSourceFunc) parallel_timeout_cb, loop);
+
+  fail_unless (ges_parallel_renderer_start (renderer));
+  /* Already running */
+  fail_if (ges_parallel_renderer_start (renderer));
+  g_main_loop_run (loop);
+  g_source_remove (timeout_id);
+
+  /* Without any clip edge to snap to, the timeline is cut in its middle */
+  chunks = ges_parallel_renderer_get_chunk_uris (renderer);
+  fail_unless (chunks != NULL);
+  fail_unless_equals_int (g_strv_length (chunks), 2);
+  for (i = 0; i < 2; i++) {
+    gchar *expected;
+    GstClockTime duration;
+
+    expected = g_strdup_printf ("%.*s-%u.ogg", (gint) strlen (uri) - 4, uri,
+        i);
+    fail_unless_equals_string (chunks[i], expected);
+    g_free (expected);
+
+    duration = get_file_duration (chunks[i]);
+    fail_unless (duration > GST_SECOND / 4);
+    fail_unless (duration < 3 * GST_SECOND / 4);
+
+    path = gst_uri_get_location (chunks[i]);
+    g_unlink (path);
+    g_free (path);
+  }
+  g_strfreev (chunks);
+
+  /* The timeline itself is left untouched */
+  fail_unless_equals_uint64 (ges_timeline_get_duration (timeline),
+      GST_SECOND);
+
+  g_main_loop_unref (loop);
+  g_object_unref (renderer);
+  gst_object_unref (timeline);
+  g_free (uri);
+}
+
+GST_END_TEST;
+
+/* Renders a two seconds theora and vorbis file to a temporary @path */
+static gchar *
+render_media (gchar ** path)
+{
+  gint fd;
+  gchar *uri, *cache;
+  GstEncodingProfile *profile;
+  GESTimelinePipeline *pipeline;
+
+  fd = g_file_open_tmp ("ges-passthrough-XXXXXX.ogg", path, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  uri = gst_filename_to_uri (*path, NULL);
+
+  /* Neither use nor fill the user cache, so that only what the timeline
+   * discovers is known */
+  cache = g_strconcat (*path, ".cache", NULL);
+  g_setenv ("GES_DISCOVERY_CACHE", cache, TRUE);
+  g_free (cache);
+
+  pipeline = make_pipeline (2 * GST_SECOND);
+  profile = make_profile (TRUE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline, uri,
+          profile));
+  gst_encoding_profile_unref (profile);
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_RENDER));
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PLAYING);
+  fail_unless_equals_int (wait_for_message (pipeline,
+          GST_MESSAGE_EOS | GST_MESSAGE_ERROR), GST_MESSAGE_EOS);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return uri;
+}
+
+/* An empty timeline to render with the profile of render_media() */
+static GESTimelinePipeline *
+make_passthrough_pipeline (GESTimelineLayer ** layer, GESTrack ** video)
+{
+  GESTimeline *timeline;
+  GESTimelinePipeline *pipeline;
+  GstEncodingProfile *profile;
+
+  timeline = ges_timeline_new ();
+  *video = ges_track_video_raw_new ();
+  fail_unless (ges_timeline_add_track (timeline, *video));
+  fail_unless (ges_timeline_add_track (timeline, ges_track_audio_raw_new ()));
+
+  *layer = ges_timeline_layer_new ();
+  ges_timeline_layer_set_auto_transition (*layer, TRUE);
+  fail_unless (ges_timeline_add_layer (timeline, *layer));
+
+  pipeline = ges_timeline_pipeline_new ();
+  fail_unless (ges_timeline_pipeline_add_timeline (pipeline, timeline));
+  ges_timeline_pipeline_preview_set_video_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+  ges_timeline_pipeline_preview_set_audio_sink (pipeline,
+      gst_element_factory_make ("fakesink", NULL));
+
+  profile = make_profile (TRUE);
+  fail_unless (ges_timeline_pipeline_set_render_settings (pipeline,
+          "file:///dev/null", profile));
+  gst_encoding_profile_unref (profile);
+
+  return pipeline;
+}
+
+static GESTimelineObject *
+add_clip (GESTimelineLayer * layer, const gchar * uri, GstClockTime start,
+    GstClockTime inpoint, GstClockTime duration)
+{
+  GESTimelineObject *object;
+
+  object = (GESTimelineObject *) ges_timeline_filesource_new ((gchar *) uri);
+  g_object_set (object, "start", start, "in-point", inpoint, "duration",
+      duration, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  return object;
+}
+
+/* Lets the timeline discover its sources, which it does until the pipeline
+ * prerolled */
+static void
+discover_sources (GESTimelinePipeline * pipeline)
+{
+  GstBus *bus;
+  GstMessage *message;
+  guint i;
+
+  bus = gst_element_get_bus (GST_ELEMENT (pipeline));
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_PAUSED);
+
+  for (i = 0; i < 1000; i++) {
+    message = gst_bus_pop_filtered (bus,
+        GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+    if (message)
+      break;
+
+    while (g_main_context_iteration (NULL, FALSE));
+    g_usleep (10000);
+  }
+
+  fail_unless (message != NULL, "Timed out discovering the sources");
+  fail_unless_equals_int (GST_MESSAGE_TYPE (message), GST_MESSAGE_ASYNC_DONE);
+  gst_message_unref (message);
+  gst_object_unref (bus);
+
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+}
+
+static void
+check_ranges (GESTimelinePipeline * pipeline, guint n_expected,
+    const guint64 * expected)
+{
+  guint i, n_ranges;
+  guint64 *ranges;
+
+  ranges = ges_timeline_pipeline_get_passthrough_ranges (pipeline, &n_ranges);
+  fail_unless_equals_int (n_ranges, n_expected);
+
+  for (i = 0; i < 2 * n_ranges; i++)
+    fail_unless_equals_uint64 (ranges[i], expected[i]);
+
+  g_free (ranges);
+}
+
+static void
+remove_media (gchar * path, gchar * uri)
+{
+  gchar *cache = g_strconcat (path, ".cache", NULL);
+
+  g_unlink (cache);
+  g_unlink (path);
+  g_free (cache);
+  g_free (path);
+  g_free (uri);
+}
+
+GST_START_TEST (test_timeline_pipeline_passthrough_cuts)
+{
+  gchar *path, *uri;
+  GESTrack *video;
+  GESTimelineLayer *layer;
+  GESTimelinePipeline *pipeline;
+  const guint64 expected[] = { 0, GST_SECOND, GST_SECOND, 2 * GST_SECOND };
+
+  ges_init ();
+
+  uri = render_media (&path);
+  pipeline = make_passthrough_pipeline (&layer, &video);
+
+  /* Two cuts of the file, each one starting at its beginning */
+  add_clip (layer, uri, 0, 0, GST_SECOND);
+  add_clip (layer, uri, GST_SECOND, 0, GST_SECOND);
+  discover_sources (pipeline);
+
+  check_ranges (pipeline, 2, expected);
+
+  gst_object_unref (pipeline);
+  remove_media (path, uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_passthrough_effect)
+{
+  gchar *path, *uri;
+  GESTrack *video;
+  GESTimelineLayer *layer;
+  GESTimelineObject *object;
+  GESTrackParseLaunchEffect *effect;
+  GESTimelinePipeline *pipeline;
+  const guint64 expected[] = { GST_SECOND, 2 * GST_SECOND };
+
+  ges_init ();
+
+  uri = render_media (&path);
+  pipeline = make_passthrough_pipeline (&layer, &video);
+
+  object = add_clip (layer, uri, 0, 0, GST_SECOND);
+  add_clip (layer, uri, GST_SECOND, 0, GST_SECOND);
+  discover_sources (pipeline);
+
+  /* The clip under the effect has to be decoded */
+  effect = ges_track_parse_launch_effect_new ("agingtv");
+  fail_unless (ges_timeline_object_add_track_object (object,
+          GES_TRACK_OBJECT (effect)));
+  fail_unless (ges_track_add_object (video, GES_TRACK_OBJECT (effect)));
+
+  check_ranges (pipeline, 1, expected);
+
+  gst_object_unref (pipeline);
+  remove_media (path, uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_passthrough_transition)
+{
+  gchar *path, *uri;
+  GESTrack *video;
+  GESTimelineLayer *layer;
+  GESTimelinePipeline *pipeline;
+  const guint64 expected[] = { 0, GST_SECOND / 2 };
+
+  ges_init ();
+
+  uri = render_media (&path);
+  pipeline = make_passthrough_pipeline (&layer, &video);
+
+  /* The overlap is a transition, and the rest of the second clip does not
+   * start on a keyframe */
+  add_clip (layer, uri, 0, 0, GST_SECOND);
+  add_clip (layer, uri, GST_SECOND / 2, 0, GST_SECOND);
+  discover_sources (pipeline);
+
+  check_ranges (pipeline, 1, expected);
+
+  gst_object_unref (pipeline);
+  remove_media (path, uri);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timeline_pipeline_passthrough_inpoint)
+{
+  gchar *path, *uri;
+  GESTrack *video;
+  GESTimelineLayer *layer;
+  GESTimelinePipeline *pipeline;
+  const guint64 expected[] = { GST_SECOND, 2 * GST_SECOND };
+
+  ges_init ();
+
+  uri = render_media (&path);
+  pipeline = make_passthrough_pipeline (&layer, &video);
+
+  /* The first clip starts in the middle of the file */
+  add_clip (layer, uri, 0, GST_SECOND / 2, GST_SECOND);
+  add_clip (layer, uri, GST_SECOND, 0, GST_SECOND);
+  discover_sources (pipeline);
+
+  check_ranges (pipeline, 1, expected);
+
+  gst_object_unref (pipeline);
+  remove_media (path, uri);
+}
+
+GST_END_TEST;
+
+/* TRUE if the video track of @pipeline was set to take theora as is */
+static gboolean
+video_is_passed_through (GESTimelinePipeline * pipeline, GESTrack * video)
+{
+  gboolean ret;
+  GstCaps *theora = gst_caps_from_string ("video/x-theora");
+
+  fail_if (gst_element_set_state (GST_ELEMENT (pipeline),
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  ret = gst_caps_can_intersect (ges_track_get_caps (video), theora);
+  gst_element_set_state (GST_ELEMENT (pipeline), GST_STATE_NULL);
+
+  gst_caps_unref (theora);
+
+  return ret;
+}
+
+GST_START_TEST (test_timeline_pipeline_passthrough_complete_source)
+{
+  gchar *path, *uri;
+  GESTrack *video;
+  GESTimelineLayer *layer;
+  GESTimelineObject *object;
+  GESTimelinePipeline *pipeline;
+  const guint64 expected[] = { 0, 2 * GST_SECOND };
+
+  ges_init ();
+
+  uri = render_media (&path);
+  pipeline = make_passthrough_pipeline (&layer, &video);
+  fail_unless (ges_timeline_pipeline_set_mode (pipeline,
+          TIMELINE_MODE_SMART_RENDER));
+
+  /* Nothing is missing, so the timeline does not discover the file */
+  object = (GESTimelineObject *) ges_timeline_filesource_new (uri);
+  g_object_set (object, "duration", 2 * GST_SECOND, "max-duration",
+      2 * GST_SECOND, "supported-formats",
+      GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+
+  /* Changing state does not discover it either, unknown files are
+   * re-encoded */
+  fail_if (video_is_passed_through (pipeline, video));
+
+  /* Once discovered by the planner, the file is known */
+  check_ranges (pipeline, 1, expected);
+  fail_unless (video_is_passed_through (pipeline, video));
+
+  /* Files that can not be discovered are re-encoded */
+  object = (GESTimelineObject *)
+      ges_timeline_filesource_new ((gchar *) "file:///nonexistent.ogg");
+  g_object_set (object, "start", 2 * GST_SECOND, "duration", GST_SECOND,
+      "max-duration", GST_SECOND, "supported-formats",
+      GES_TRACK_TYPE_AUDIO | GES_TRACK_TYPE_VIDEO, NULL);
+  fail_unless (ges_timeline_layer_add_object (layer, object));
+  check_ranges (pipeline, 1, expected);
+  check_ranges (pipeline, 1, expected);
+
+  gst_object_unref (pipeline);
+  remove_media (path, uri);
+}
+
+GST_END_TEST;
+
+static Suite *
+ges_suite (void)
+{
+  Suite *s = suite_create ("ges-timeline-pipeline");
+  TCase *tc_chain = tcase_create ("timelinepipeline");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_timeline_pipeline_render_from_preview);
+  tcase_add_test (tc_chain, test_timeline_pipeline_render_rollback);
+  tcase_add_test (tc_chain, test_timeline_pipeline_render_range_arguments);
+  tcase_add_test (tc_chain, test_timeline_pipeline_render_range);
+  tcase_add_test (tc_chain,
+      test_timeline_pipeline_render_range_preroll_error);
+  tcase_add_test (tc_chain, test_parallel_renderer);
+  tcase_add_test (tc_chain, test_timeline_pipeline_passthrough_cuts);
+  tcase_add_test (tc_chain, test_timeline_pipeline_passthrough_effect);
+  tcase_add_test (tc_chain, test_timeline_pipeline_passthrough_transition);
+  tcase_add_test (tc_chain, test_timeline_pipeline_passthrough_inpoint);
+  tcase_add_test (tc_chain,
+      test_timeline_pipeline_passthrough_complete_source);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+
+  Suite *s = ges_suite ();
+  SRunner *sr = srunner_create (s);
+
+  gst_check_init (&argc, &argv);
+
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return nf;
+}
@@ -402,6 +402,8 @@ main (int argc, gchar ** argv)
   gchar *audio_preset = NULL;
   gchar *video_preset = NULL;
   gchar *exclude_args = NULL;
+  gchar *inpoint = NULL;
+  gchar *outpoint = NULL;
   static gboolean render = FALSE;
   static gboolean smartrender = FALSE;
   static gboolean list_transitions = FALSE;
@@ -418,6 +420,10 @@ main (int argc, gchar ** argv)
         "Render to outputuri", NULL},
     {"smartrender", 's', 0, G_OPTION_ARG_NONE, &smartrender,
         "Render to outputuri, and avoid decoding/reencoding", NULL},
+    {"inpoint", 0, 0, G_OPTION_ARG_STRING, &inpoint,
+        "Timeline position (in seconds) at which rendering starts", "N"},
+    {"outpoint", 0, 0, G_OPTION_ARG_STRING, &outpoint,
+        "Timeline position (in seconds) at which rendering stops", "N"},
     {"outputuri", 'o', 0, G_OPTION_ARG_STRING, &outputuri,
         "URI to encode to", "URI (<protocol>://<location>)"},
     {"format", 'f', 0, G_OPTION_ARG_STRING, &container,
@@ -500,7 +506,10 @@ main (int argc, gchar ** argv)
     load_project (project_path);
     exit (0);
   }
-  if (((!load_path && (argc < 4))) || (outputuri && (!render && !smartrender))) {
+  if (((!load_path && (argc < 4))) || (outputuri && (!render && !smartrender))
+      || ((inpoint || outpoint) && (!render && !smartrender))
+      || (inpoint && !check_time (inpoint))
+      || (outpoint && !check_time (outpoint))) {
     g_printf ("%s", g_option_context_get_help (ctx, TRUE, NULL));
     g_option_context_free (ctx);
     exit (1);
@@ -533,6 +542,14 @@ main (int argc, gchar ** argv)
             smartrender ? TIMELINE_MODE_SMART_RENDER : TIMELINE_MODE_RENDER))
       exit (1);
 
+    if ((inpoint || outpoint) &&
+        !ges_timeline_pipeline_set_render_range (pipeline,
+            inpoint ? str_to_time (inpoint) : 0,
+            outpoint ? str_to_time (outpoint) : GST_CLOCK_TIME_NONE)) {
+      g_printerr ("Invalid render range\n");
+      exit (1);
+    }
+
     g_free (outputuri);
     gst_encoding_profile_unref (prof);
   } else {